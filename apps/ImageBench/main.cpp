@@ -0,0 +1,135 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "debug/logger.h"
+#include "implementation/stb_implementation.h"
+#include "utilities/image_kernels.h"
+
+using namespace GyroEngine::Utils::Image;
+
+namespace
+{
+    constexpr int Iterations = 10;
+    /// @brief Default size of loaded textures, what LoadImageData resizes to
+    constexpr int TargetSize = 800;
+
+    /// @brief Best time of a few runs, in milliseconds
+    double Measure(const std::function<void()>& work)
+    {
+        double best = 0.0;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            work();
+            const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).
+                    count();
+            best = i == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    }
+
+    void Report(const std::string& name, const double baseline, const double kernel)
+    {
+        Logger::Log("{:<28} baseline {:8.3f} ms  kernel {:8.3f} ms  {:5.2f}x", name, baseline, kernel,
+                    baseline / kernel);
+    }
+
+    /// @brief Gradients with hard edges and varying alpha, so both filters have something to ring on
+    std::vector<uint8_t> MakeTestImage(const int width, const int height)
+    {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t* pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+                pixel[0] = static_cast<uint8_t>(x * 255 / width);
+                pixel[1] = static_cast<uint8_t>(y * 255 / height);
+                pixel[2] = ((x / 16 + y / 16) & 1) ? 255 : 0;
+                pixel[3] = static_cast<uint8_t>(255 - (x + y) * 128 / (width + height));
+            }
+        }
+        return pixels;
+    }
+}
+
+/// @brief Times the image kernels against stb and the scalar paths they replace
+/// @note Takes an optional image path, a generated 2048x2048 image is used otherwise
+int main(const int argc, char** argv)
+{
+    int width = 2048;
+    int height = 2048;
+    std::vector<uint8_t> rgba;
+    if (argc > 1)
+    {
+        int channels = 0;
+        stbi_uc* loaded = stbi_load(argv[1], &width, &height, &channels, 4);
+        if (!loaded)
+        {
+            Logger::LogError("Failed to load {} because: {}", argv[1], stbi_failure_reason());
+            return EXIT_FAILURE;
+        }
+        rgba.assign(loaded, loaded + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(loaded);
+    }
+    else
+    {
+        rgba = MakeTestImage(width, height);
+    }
+
+    const size_t pixels = static_cast<size_t>(width) * height;
+    Logger::Log("{}x{} image, AVX2 {}", width, height, HasAvx2() ? "available" : "unavailable");
+
+    std::vector<uint8_t> rgb(pixels * 3);
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        rgb[i * 3 + 0] = rgba[i * 4 + 0];
+        rgb[i * 3 + 1] = rgba[i * 4 + 1];
+        rgb[i * 3 + 2] = rgba[i * 4 + 2];
+    }
+    std::vector<uint8_t> expanded(pixels * 4);
+    Report("RGB to RGBA",
+           Measure([&] { ExpandRgbToRgbaScalar(rgb.data(), expanded.data(), pixels); }),
+           Measure([&] { ExpandRgbToRgba(rgb.data(), expanded.data(), pixels); }));
+
+    std::vector<float> linear(pixels * 4);
+    Report("sRGB to linear",
+           Measure([&] { SrgbToLinearScalar(rgba.data(), linear.data(), pixels); }),
+           Measure([&] { SrgbToLinear(rgba.data(), linear.data(), pixels); }));
+
+    std::vector<float> premultiplied = linear;
+    Report("Premultiply alpha",
+           Measure([&] { PremultiplyAlphaScalar(premultiplied.data(), pixels); }),
+           Measure([&] { PremultiplyAlpha(premultiplied.data(), pixels); }));
+
+    std::vector<uint8_t> encoded(pixels * 4);
+    Report("Linear to sRGB",
+           Measure([&] { LinearToSrgbScalar(linear.data(), encoded.data(), pixels); }),
+           Measure([&] { LinearToSrgb(linear.data(), encoded.data(), pixels); }));
+
+    // Resizing is compared with stb, which LoadImageData used before
+    std::vector<uint8_t> resized(static_cast<size_t>(TargetSize) * TargetSize * 4);
+    const double stbResize = Measure([&]
+    {
+        stbir_resize_uint8_srgb(rgba.data(), width, height, width * 4, resized.data(), TargetSize, TargetSize,
+                                TargetSize * 4, STBIR_RGBA);
+    });
+    Report("Resize box vs stb", stbResize, Measure([&]
+    {
+        ResizeRgba8Srgb(rgba.data(), width, height, resized.data(), TargetSize, TargetSize, ResizeFilter::Box);
+    }));
+    Report("Resize Lanczos3 vs stb", stbResize, Measure([&]
+    {
+        ResizeRgba8Srgb(rgba.data(), width, height, resized.data(), TargetSize, TargetSize, ResizeFilter::Lanczos3);
+    }));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+#version 450
+
+// Uniforms
+layout(set = 0, binding = 0) uniform MVP {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+} mvp; // For shadows, view and projection are the light's
+
+// Inputs, only the position so split vertex streams only fetch 12 bytes per vertex
+layout(location = 0) in vec3 ivVertexPosition;
+
+void main() {
+    gl_Position = mvp.projection * mvp.view * mvp.model * vec4(ivVertexPosition, 1.0);
+}
@@ -0,0 +1,54 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define INVALID_INDEX 0xFFFFFFFFu
+
+struct MaterialData {
+    vec4 baseColor;
+    uint albedo;
+    uint normal;
+    uint metallic;
+    uint roughness;
+    uint ao;
+    uint sampler;
+    uint padding0;
+    uint padding1;
+};
+
+// Bindless heap
+layout(set = 0, binding = 0) uniform texture2D utTextures[];
+layout(set = 0, binding = 1) uniform sampler usSamplers[];
+layout(set = 0, binding = 2) readonly buffer MaterialBuffer {
+    MaterialData materials[];
+} ubMaterials[];
+
+// Draw constants
+layout(push_constant) uniform DrawConstants {
+    uint objectBuffer; // Heap index of the buffer holding the object's MVP
+    uint objectOffset; // Offset of the MVP in vec4s
+    uint materialBuffer; // Heap index of the material's data
+    uint materialIndex; // Material inside that buffer
+} pcDraw;
+
+// Inputs
+layout(location = 0) in vec3 ivFragPosition;
+layout(location = 1) in vec3 ivVertexNormal;
+layout(location = 2) in vec2 ivVertexUV;
+layout(location = 3) in vec4 ivVertexColor;
+
+// Outputs
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 color = ivVertexColor;
+    if (pcDraw.materialBuffer != INVALID_INDEX) {
+        MaterialData material = ubMaterials[pcDraw.materialBuffer].materials[pcDraw.materialIndex];
+        color *= material.baseColor;
+
+        // Materials without an albedo texture fall back to their base color
+        if (material.albedo != INVALID_INDEX && material.sampler != INVALID_INDEX) {
+            color *= texture(sampler2D(utTextures[material.albedo], usSamplers[material.sampler]), ivVertexUV);
+        }
+    }
+    outColor = clamp(color, 0.0, 1.0);
+}
@@ -0,0 +1,57 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless heap, per-object data lives in the frame's uniform allocator buffer
+layout(set = 0, binding = 2) readonly buffer ObjectBuffer {
+    vec4 data[];
+} ubObjects[];
+
+// Draw constants
+layout(push_constant) uniform DrawConstants {
+    uint objectBuffer; // Heap index of the buffer holding the object's MVP
+    uint objectOffset; // Offset of the MVP in vec4s
+    uint materialBuffer; // Heap index of the material's data
+    uint materialIndex; // Material inside that buffer
+} pcDraw;
+
+// Inputs
+layout(location = 0) in vec3 ivVertexPosition;
+layout(location = 1) in vec3 ivVertexNormal;
+layout(location = 2) in vec2 ivVertexUV;
+layout(location = 3) in vec3 ivVertexTangent;
+layout(location = 4) in vec4 ivVertexColor;
+
+// Outputs
+layout(location = 0) out vec3 ovFragPosition; // Fragment position
+layout(location = 1) out vec3 ovVertexNormal; // Vertex normal
+layout(location = 2) out vec2 ovVertexUV; // Vertex uv
+layout(location = 3) out vec4 ovVertexColor; // Vertex color
+
+// Helpers
+mat4 loadMatrix(uint offset) {
+    return mat4(
+        ubObjects[pcDraw.objectBuffer].data[offset],
+        ubObjects[pcDraw.objectBuffer].data[offset + 1],
+        ubObjects[pcDraw.objectBuffer].data[offset + 2],
+        ubObjects[pcDraw.objectBuffer].data[offset + 3]
+    );
+} // Reads a column major matrix starting at offset
+
+void main() {
+    // Same layout as the MVP uniform: model, view, projection
+    mat4 model = loadMatrix(pcDraw.objectOffset);
+    mat4 view = loadMatrix(pcDraw.objectOffset + 4);
+    mat4 projection = loadMatrix(pcDraw.objectOffset + 8);
+
+    vec3 worldPosition = (model * vec4(ivVertexPosition, 1.0)).xyz;
+    vec3 vertexNormal = normalize((model * vec4(ivVertexNormal, 0.0)).xyz);
+
+    // Transform the vertex position to clip space
+    gl_Position = projection * view * vec4(worldPosition, 1.0);
+
+    // Pass the attributes to the fragment shader
+    ovFragPosition = worldPosition;
+    ovVertexNormal = vertexNormal;
+    ovVertexUV = ivVertexUV;
+    ovVertexColor = ivVertexColor;
+}
@@ -0,0 +1,128 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless heap, per-object data lives in the frame's uniform allocator buffer
+layout(set = 0, binding = 2) readonly buffer ObjectBuffer {
+    vec4 data[];
+} ubObjects[];
+
+// Same heap binding read as raw words, the mesh's vertex streams
+layout(set = 0, binding = 2) readonly buffer VertexBuffer {
+    uint words[];
+} sbVertices[];
+
+// Draw constants
+layout(push_constant) uniform DrawConstants {
+    uint objectBuffer; // Heap index of the buffer holding the object's MVP
+    uint objectOffset; // Offset of the MVP in vec4s
+    uint materialBuffer; // Heap index of the material's data
+    uint materialIndex; // Material inside that buffer
+    uint vertexBuffer; // Heap index of the vertices, the positions for split vertices
+    uint attributeBuffer; // Heap index of the attributes of split vertices
+    uint vertexFormat; // 0 full, 1 packed, 2 split
+    uint baseVertex; // Added to gl_VertexIndex
+} pcDraw;
+
+// Vertex formats, match Types::VertexFormat
+const uint FORMAT_FULL = 0;
+const uint FORMAT_PACKED = 1;
+const uint FORMAT_SPLIT = 2;
+
+// Outputs
+layout(location = 0) out vec3 ovFragPosition; // Fragment position
+layout(location = 1) out vec3 ovVertexNormal; // Vertex normal
+layout(location = 2) out vec2 ovVertexUV; // Vertex uv
+layout(location = 3) out vec4 ovVertexColor; // Vertex color
+
+struct PulledVertex {
+    vec3 position;
+    vec3 normal;
+    vec2 uv;
+    vec4 color;
+};
+
+// Helpers
+mat4 loadMatrix(uint offset) {
+    return mat4(
+        ubObjects[pcDraw.objectBuffer].data[offset],
+        ubObjects[pcDraw.objectBuffer].data[offset + 1],
+        ubObjects[pcDraw.objectBuffer].data[offset + 2],
+        ubObjects[pcDraw.objectBuffer].data[offset + 3]
+    );
+} // Reads a column major matrix starting at offset
+
+float loadFloat(uint stream, uint word) {
+    return uintBitsToFloat(sbVertices[stream].words[word]);
+} // Reads a float stored in a vertex stream
+
+vec2 loadVec2(uint stream, uint word) {
+    return vec2(loadFloat(stream, word), loadFloat(stream, word + 1));
+}
+
+vec3 loadVec3(uint stream, uint word) {
+    return vec3(loadFloat(stream, word), loadFloat(stream, word + 1), loadFloat(stream, word + 2));
+}
+
+vec4 loadVec4(uint stream, uint word) {
+    return vec4(loadVec3(stream, word), loadFloat(stream, word + 3));
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+} // Unfolds a direction stored on the octahedron
+
+PulledVertex loadVertex(uint index) {
+    PulledVertex vertex;
+    if (pcDraw.vertexFormat == FORMAT_PACKED) {
+        // 24 bytes: snorm16 position, octahedral snorm16 normal, octahedral snorm16 tangent, half uv, unorm8 color
+        uint word = index * 6;
+        uint stream = pcDraw.vertexBuffer;
+        vec2 positionXY = unpackSnorm2x16(sbVertices[stream].words[word]);
+        vec2 positionZW = unpackSnorm2x16(sbVertices[stream].words[word + 1]);
+        vertex.position = vec3(positionXY, positionZW.x);
+        vertex.normal = decodeOctahedral(unpackSnorm2x16(sbVertices[stream].words[word + 2]));
+        vertex.uv = unpackHalf2x16(sbVertices[stream].words[word + 4]);
+        vertex.color = unpackUnorm4x8(sbVertices[stream].words[word + 5]);
+    } else if (pcDraw.vertexFormat == FORMAT_SPLIT) {
+        // 12 byte positions, 48 byte attributes: normal, uv, tangent, color
+        uint word = index * 12;
+        vertex.position = loadVec3(pcDraw.vertexBuffer, index * 3);
+        vertex.normal = loadVec3(pcDraw.attributeBuffer, word);
+        vertex.uv = loadVec2(pcDraw.attributeBuffer, word + 3);
+        vertex.color = loadVec4(pcDraw.attributeBuffer, word + 8);
+    } else {
+        // 60 bytes: position, normal, uv, tangent, color
+        uint word = index * 15;
+        vertex.position = loadVec3(pcDraw.vertexBuffer, word);
+        vertex.normal = loadVec3(pcDraw.vertexBuffer, word + 3);
+        vertex.uv = loadVec2(pcDraw.vertexBuffer, word + 6);
+        vertex.color = loadVec4(pcDraw.vertexBuffer, word + 11);
+    }
+    return vertex;
+} // Fetches and decodes a vertex in any of the engine's vertex formats
+
+void main() {
+    // Vertices come from the heap, the pipeline has no vertex input state
+    PulledVertex vertex = loadVertex(pcDraw.baseVertex + uint(gl_VertexIndex));
+
+    // Same layout as the MVP uniform: model, view, projection
+    // The model matrix also carries the dequantization scale of packed vertices
+    mat4 model = loadMatrix(pcDraw.objectOffset);
+    mat4 view = loadMatrix(pcDraw.objectOffset + 4);
+    mat4 projection = loadMatrix(pcDraw.objectOffset + 8);
+
+    vec3 worldPosition = (model * vec4(vertex.position, 1.0)).xyz;
+    vec3 vertexNormal = normalize((model * vec4(vertex.normal, 0.0)).xyz);
+
+    // Transform the vertex position to clip space
+    gl_Position = projection * view * vec4(worldPosition, 1.0);
+
+    // Pass the attributes to the fragment shader
+    ovFragPosition = worldPosition;
+    ovVertexNormal = vertexNormal;
+    ovVertexUV = vertex.uv;
+    ovVertexColor = vertex.color;
+}
@@ -4,7 +4,15 @@
 
 #include "engine.h"
 
+#include <filesystem>
+
 #include "factories/mesh_factory.h"
+#include "factories/shader_factory.h"
+#include "factories/texture_factory.h"
+#include "resources/asset_registry.h"
+#include "resources/object/geometry_residency.h"
+#include "resources/texture/texture_streamer.h"
+#include "utils.h"
 
 #include "input/keyboard.h"
 #include "input/mouse.h"
@@ -67,6 +75,17 @@ namespace GyroEngine
 
             // Run the update function if set
             m_updateFunction();
+
+            // Submit the textures decoded since the last frame
+            if (const auto uploader = Factories::TextureFactory::GetUploader())
+            {
+                uploader->Update();
+            }
+
+            // Release assets nothing has used for a while, and geometry and texture levels that don't fit the budget
+            Resources::AssetRegistry::Get().Collect();
+            Resources::GeometryResidency::Get().Trim(m_device->GetMaxFramesInFlight());
+            Resources::TextureStreamer::Get().Update(*m_device);
         }
 
         // Destroy the engine resources after the loop ends
@@ -79,6 +98,19 @@ namespace GyroEngine
         {
             m_destroyFunction();
         }
+        // Cached assets own GPU resources, they have to go before the device does
+        if (m_device)
+        {
+            m_device->WaitForIdle();
+        }
+        Resources::AssetRegistry::Get().Clear();
+        Resources::TextureStreamer::Get().Clear();
+        if (const auto uploader = Factories::TextureFactory::GetUploader())
+        {
+            uploader->Cleanup();
+        }
+        Factories::TextureFactory::SetUploader(nullptr);
+        Factories::TextureFactory::SetMipGenerator(nullptr);
         DestroyWindow();
         DestroyRenderingDevice();
     }
@@ -126,6 +158,28 @@ namespace GyroEngine
             Logger::LogError("Cannot start factories without a valid rendering device");
             return;
         }
+        CreateMipGenerator();
+    }
+
+    void Engine::CreateMipGenerator()
+    {
+        // Compiled at build time into the copied content, found from the executable whatever the working directory
+        const std::string shaderPath = (std::filesystem::path(Utils::GetExecutableDir()) / "content" / "shaders" /
+                                        "compute" / "mip_downsample.comp.spv").string();
+        if (!std::filesystem::exists(shaderPath))
+        {
+            Logger::LogWarning("Mip generator shader {} is missing, mip chains are blitted instead", shaderPath);
+            return;
+        }
+
+        const auto shader = Factories::ShaderFactory::CreateFromFile(shaderPath, Utils::Shader::ShaderStage::Compute);
+        const auto mipGenerator = std::make_shared<Resources::MipGenerator>(*m_device);
+        if (!shader || !mipGenerator->SetShader(shader).Init())
+        {
+            Logger::LogWarning("Failed to create the mip generator, mip chains are blitted instead");
+            return;
+        }
+        Factories::TextureFactory::SetMipGenerator(mipGenerator);
     }
 
     void Engine::StartServices() const
@@ -67,6 +67,8 @@ namespace GyroEngine
         void DestroyWindow();
 
         void StartFactories();
+        /// @brief Registers the compute mip generator with the texture factory, textures blit their chains without it
+        void CreateMipGenerator();
         void StartServices() const;
     };
 }
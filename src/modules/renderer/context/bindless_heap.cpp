@@ -0,0 +1,435 @@
+//
+// Created by lepag on 7/17/2025.
+//
+
+#include "bindless_heap.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rendering_device.h"
+
+namespace GyroEngine::Device
+{
+    namespace
+    {
+        uint64_t MakeKey(const uint32_t binding, const uint32_t index)
+        {
+            return static_cast<uint64_t>(binding) << 32 | index;
+        }
+    }
+
+    BindlessHeap& BindlessHeap::SetMaxImages(const uint32_t count)
+    {
+        m_images.capacity = count;
+        return *this;
+    }
+
+    BindlessHeap& BindlessHeap::SetMaxSamplers(const uint32_t count)
+    {
+        m_samplers.capacity = count;
+        return *this;
+    }
+
+    BindlessHeap& BindlessHeap::SetMaxStorageBuffers(const uint32_t count)
+    {
+        m_buffers.capacity = count;
+        return *this;
+    }
+
+    bool BindlessHeap::Init()
+    {
+        VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &indexingProperties;
+        vkGetPhysicalDeviceProperties2(m_device.GetPhysicalDevice(), &properties);
+
+        // Every binding is visible to all stages, so the per-stage limits apply to each of them
+        m_images.capacity = std::min({
+            m_images.capacity == 0 ? 16384u : m_images.capacity,
+            indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages
+        });
+        m_samplers.capacity = std::min({
+            m_samplers.capacity == 0 ? 256u : m_samplers.capacity,
+            indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers
+        });
+        m_buffers.capacity = std::min({
+            m_buffers.capacity == 0 ? 16384u : m_buffers.capacity,
+            indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+        });
+
+        const std::array<VkDescriptorSetLayoutBinding, 3> bindings = {{
+            {ImageBinding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_images.capacity, VK_SHADER_STAGE_ALL, nullptr},
+            {SamplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, m_samplers.capacity, VK_SHADER_STAGE_ALL, nullptr},
+            {StorageBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_buffers.capacity, VK_SHADER_STAGE_ALL, nullptr}
+        }};
+
+        constexpr VkDescriptorBindingFlags bindingFlag = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                         VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+        const std::array<VkDescriptorBindingFlags, 3> bindingFlags = {bindingFlag, bindingFlag, bindingFlag};
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &bindingFlagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(m_device.GetLogicalDevice(), &layoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create bindless descriptor set layout");
+            return false;
+        }
+
+        // One set per frame in flight, so writes never have to touch a set the GPU might still be reading
+        const uint32_t frameCount = m_device.GetMaxFramesInFlight();
+        const std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_images.capacity * frameCount},
+            {VK_DESCRIPTOR_TYPE_SAMPLER, m_samplers.capacity * frameCount},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_buffers.capacity * frameCount}
+        }};
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        if (vkCreateDescriptorPool(m_device.GetLogicalDevice(), &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create bindless descriptor pool");
+            Cleanup();
+            return false;
+        }
+
+        const std::vector<VkDescriptorSetLayout> layouts(frameCount, m_layout);
+        m_sets.resize(frameCount, VK_NULL_HANDLE);
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = m_pool;
+        allocateInfo.descriptorSetCount = frameCount;
+        allocateInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(m_device.GetLogicalDevice(), &allocateInfo, m_sets.data()) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to allocate bindless descriptor sets");
+            Cleanup();
+            return false;
+        }
+
+        // Binding the heap only needs a layout compatible with set 0 of every bindless pipeline
+        const VkPushConstantRange pushConstantRange = GetPushConstantRange();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_layout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(m_device.GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create bindless pipeline layout");
+            Cleanup();
+            return false;
+        }
+
+        Logger::Log("Created bindless heap with {} images, {} samplers and {} storage buffers",
+                    m_images.capacity, m_samplers.capacity, m_buffers.capacity);
+        return true;
+    }
+
+    void BindlessHeap::Cleanup()
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device.GetLogicalDevice(), m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device.GetLogicalDevice(), m_pool, nullptr);
+            m_pool = VK_NULL_HANDLE;
+        }
+        if (m_layout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device.GetLogicalDevice(), m_layout, nullptr);
+            m_layout = VK_NULL_HANDLE;
+        }
+        m_sets.clear();
+        m_pendingWrites.clear();
+        m_retired.clear();
+        m_boundCommandBuffer = VK_NULL_HANDLE;
+    }
+
+    uint32_t BindlessHeap::RegisterImage(VkImageView imageView, const VkImageLayout imageLayout)
+    {
+        std::lock_guard lock(m_mutex);
+        const uint32_t index = Acquire(m_images, "image");
+        if (index == InvalidIndex)
+        {
+            return InvalidIndex;
+        }
+
+        PendingWrite write;
+        write.binding = ImageBinding;
+        write.index = index;
+        write.imageInfo = {VK_NULL_HANDLE, imageView, imageLayout};
+        Queue(write);
+        return index;
+    }
+
+    void BindlessHeap::UpdateImage(const uint32_t index, VkImageView imageView, const VkImageLayout imageLayout)
+    {
+        if (index == InvalidIndex)
+        {
+            return;
+        }
+
+        std::lock_guard lock(m_mutex);
+        PendingWrite write;
+        write.binding = ImageBinding;
+        write.index = index;
+        write.imageInfo = {VK_NULL_HANDLE, imageView, imageLayout};
+        Queue(write);
+    }
+
+    void BindlessHeap::ReleaseImage(const uint32_t index)
+    {
+        Release(ImageBinding, index);
+    }
+
+    uint32_t BindlessHeap::RegisterSampler(VkSampler sampler)
+    {
+        std::lock_guard lock(m_mutex);
+        const uint32_t index = Acquire(m_samplers, "sampler");
+        if (index == InvalidIndex)
+        {
+            return InvalidIndex;
+        }
+
+        PendingWrite write;
+        write.binding = SamplerBinding;
+        write.index = index;
+        write.imageInfo = {sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+        Queue(write);
+        return index;
+    }
+
+    void BindlessHeap::ReleaseSampler(const uint32_t index)
+    {
+        Release(SamplerBinding, index);
+    }
+
+    uint32_t BindlessHeap::RegisterBuffer(VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize range)
+    {
+        std::lock_guard lock(m_mutex);
+        const uint32_t index = Acquire(m_buffers, "storage buffer");
+        if (index == InvalidIndex)
+        {
+            return InvalidIndex;
+        }
+
+        PendingWrite write;
+        write.binding = StorageBufferBinding;
+        write.index = index;
+        write.bufferInfo = {buffer, offset, range};
+        Queue(write);
+        return index;
+    }
+
+    void BindlessHeap::UpdateBuffer(const uint32_t index, VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize range)
+    {
+        if (index == InvalidIndex)
+        {
+            return;
+        }
+
+        std::lock_guard lock(m_mutex);
+        PendingWrite write;
+        write.binding = StorageBufferBinding;
+        write.index = index;
+        write.bufferInfo = {buffer, offset, range};
+        Queue(write);
+    }
+
+    void BindlessHeap::ReleaseBuffer(const uint32_t index)
+    {
+        Release(StorageBufferBinding, index);
+    }
+
+    void BindlessHeap::BeginFrame(const uint32_t frameIndex)
+    {
+        std::lock_guard lock(m_mutex);
+        m_frameIndex = frameIndex;
+        m_frame++;
+        m_boundCommandBuffer = VK_NULL_HANDLE;
+
+        // Every frame that could have read a retired index has completed, hand it out again
+        const auto retired = std::remove_if(m_retired.begin(), m_retired.end(), [&](const RetiredSlot& slot)
+        {
+            if (slot.frame > m_frame)
+            {
+                return false;
+            }
+            GetSlots(slot.binding).free.push_back(slot.index);
+            return true;
+        });
+        m_retired.erase(retired, m_retired.end());
+
+        ApplyWrites(frameIndex);
+    }
+
+    void BindlessHeap::Flush()
+    {
+        std::lock_guard lock(m_mutex);
+        ApplyWrites(m_frameIndex);
+    }
+
+    bool BindlessHeap::Bind(VkCommandBuffer cmd, const VkPipelineBindPoint bindPoint)
+    {
+        if (m_sets.empty() || (cmd == m_boundCommandBuffer && bindPoint == m_boundBindPoint))
+        {
+            return false;
+        }
+
+        vkCmdBindDescriptorSets(cmd, bindPoint, m_pipelineLayout, 0, 1, &m_sets[m_frameIndex], 0, nullptr);
+        m_boundCommandBuffer = cmd;
+        m_boundBindPoint = bindPoint;
+        return true;
+    }
+
+    void BindlessHeap::Invalidate()
+    {
+        m_boundCommandBuffer = VK_NULL_HANDLE;
+    }
+
+    BindlessHeap::Slots& BindlessHeap::GetSlots(const uint32_t binding)
+    {
+        switch (binding)
+        {
+        case ImageBinding:
+            return m_images;
+        case SamplerBinding:
+            return m_samplers;
+        default:
+            return m_buffers;
+        }
+    }
+
+    uint32_t BindlessHeap::Acquire(Slots& slots, const char* name)
+    {
+        if (!slots.free.empty())
+        {
+            const uint32_t index = slots.free.back();
+            slots.free.pop_back();
+            return index;
+        }
+        if (slots.next >= slots.capacity)
+        {
+            Logger::LogError("Bindless heap is out of {} slots ({} in use)", name, slots.capacity);
+            return InvalidIndex;
+        }
+        return slots.next++;
+    }
+
+    void BindlessHeap::Release(const uint32_t binding, const uint32_t index)
+    {
+        if (index == InvalidIndex)
+        {
+            return;
+        }
+
+        std::lock_guard lock(m_mutex);
+        if (m_layout == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        // The descriptor is left as is, partially bound sets only require descriptors the shader actually reads to be valid
+        m_pendingWrites.erase(MakeKey(binding, index));
+        m_retired.push_back({binding, index, m_frame + m_device.GetMaxFramesInFlight()});
+    }
+
+    void BindlessHeap::Queue(const PendingWrite& write)
+    {
+        PendingWrite& pending = m_pendingWrites[MakeKey(write.binding, write.index)];
+        pending = write;
+        pending.frameMask = (1u << m_sets.size()) - 1;
+    }
+
+    void BindlessHeap::ApplyWrites(const uint32_t frameIndex)
+    {
+        if (m_pendingWrites.empty() || frameIndex >= m_sets.size())
+        {
+            return;
+        }
+
+        const uint32_t frameBit = 1u << frameIndex;
+
+        std::vector<VkWriteDescriptorSet> writes;
+        writes.reserve(m_pendingWrites.size());
+        for (auto it = m_pendingWrites.begin(); it != m_pendingWrites.end();)
+        {
+            PendingWrite& pending = it->second;
+            if ((pending.frameMask & frameBit) == 0)
+            {
+                ++it;
+                continue;
+            }
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_sets[frameIndex];
+            write.dstBinding = pending.binding;
+            write.dstArrayElement = pending.index;
+            write.descriptorCount = 1;
+            switch (pending.binding)
+            {
+            case ImageBinding:
+                write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                write.pImageInfo = &pending.imageInfo;
+                break;
+            case SamplerBinding:
+                write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+                write.pImageInfo = &pending.imageInfo;
+                break;
+            default:
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                write.pBufferInfo = &pending.bufferInfo;
+                break;
+            }
+            writes.push_back(write);
+            ++it;
+        }
+
+        if (!writes.empty())
+        {
+            vkUpdateDescriptorSets(m_device.GetLogicalDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                                   nullptr);
+        }
+
+        // Only drop writes once every set has them, the infos above have to stay alive until the update
+        for (auto it = m_pendingWrites.begin(); it != m_pendingWrites.end();)
+        {
+            it->second.frameMask &= ~frameBit;
+            if (it->second.frameMask == 0)
+            {
+                it = m_pendingWrites.erase(it);
+            } else
+            {
+                ++it;
+            }
+        }
+    }
+}
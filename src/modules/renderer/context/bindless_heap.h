@@ -0,0 +1,136 @@
+//
+// Created by lepag on 7/17/2025.
+//
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+
+    /// @brief Global descriptor table every bindless pipeline shares as set 0
+    /// @note Binding 0 holds sampled images, binding 1 samplers and binding 2 storage buffers. Resources register once
+    /// and keep their index until they are released, shaders reach them through indices stored in material or draw data
+    class BindlessHeap
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        static constexpr uint32_t ImageBinding = 0;
+        static constexpr uint32_t SamplerBinding = 1;
+        static constexpr uint32_t StorageBufferBinding = 2;
+
+        /// @brief Push constant range every bindless pipeline layout uses, so binding the heap survives pipeline changes
+        static constexpr uint32_t PushConstantSize = 128;
+
+        explicit BindlessHeap(RenderingDevice& device): m_device(device) {}
+        ~BindlessHeap() { Cleanup(); }
+
+        BindlessHeap& SetMaxImages(uint32_t count);
+        BindlessHeap& SetMaxSamplers(uint32_t count);
+        BindlessHeap& SetMaxStorageBuffers(uint32_t count);
+
+        bool Init();
+        void Cleanup();
+
+        uint32_t RegisterImage(VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        void UpdateImage(uint32_t index, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        void ReleaseImage(uint32_t index);
+
+        uint32_t RegisterSampler(VkSampler sampler);
+        void ReleaseSampler(uint32_t index);
+
+        uint32_t RegisterBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        void UpdateBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        void ReleaseBuffer(uint32_t index);
+
+        /// @brief Applies pending writes to the frame's set and recycles indices no frame in flight can use anymore
+        /// @note Call once the frame's fence has signalled
+        void BeginFrame(uint32_t frameIndex);
+
+        /// @brief Applies writes made while recording to the current frame's set, call before submitting
+        void Flush();
+
+        /// @brief Binds the current frame's set as set 0, skipped when it's still bound on cmd
+        /// @return Whether the set was bound, which may disturb sets bound above it through other layouts
+        bool Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        /// @brief Marks set 0 as disturbed, e.g. after a pipeline with an incompatible layout bound its own sets
+        void Invalidate();
+
+        [[nodiscard]] VkDescriptorSetLayout GetLayout() const
+        {
+            return m_layout;
+        }
+
+        [[nodiscard]] VkPipelineLayout GetPipelineLayout() const
+        {
+            return m_pipelineLayout;
+        }
+
+        [[nodiscard]] VkPushConstantRange GetPushConstantRange() const
+        {
+            return {VK_SHADER_STAGE_ALL, 0, PushConstantSize};
+        }
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return m_layout != VK_NULL_HANDLE;
+        }
+    private:
+        struct Slots
+        {
+            uint32_t capacity = 0;
+            uint32_t next = 0;
+            std::vector<uint32_t> free;
+        };
+
+        struct PendingWrite
+        {
+            uint32_t binding = 0;
+            uint32_t index = 0;
+            VkDescriptorImageInfo imageInfo = {};
+            VkDescriptorBufferInfo bufferInfo = {};
+            /// @brief Bit per frame in flight whose set still lacks this write
+            uint32_t frameMask = 0;
+        };
+
+        struct RetiredSlot
+        {
+            uint32_t binding = 0;
+            uint32_t index = 0;
+            uint64_t frame = 0;
+        };
+
+        RenderingDevice& m_device;
+
+        std::mutex m_mutex;
+        VkDescriptorSetLayout m_layout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> m_sets;
+
+        Slots m_images;
+        Slots m_samplers;
+        Slots m_buffers;
+
+        std::unordered_map<uint64_t, PendingWrite> m_pendingWrites;
+        std::vector<RetiredSlot> m_retired;
+
+        uint32_t m_frameIndex = 0;
+        uint64_t m_frame = 0;
+        VkCommandBuffer m_boundCommandBuffer = VK_NULL_HANDLE;
+        VkPipelineBindPoint m_boundBindPoint = VK_PIPELINE_BIND_POINT_MAX_ENUM;
+
+        Slots& GetSlots(uint32_t binding);
+        uint32_t Acquire(Slots& slots, const char* name);
+        void Release(uint32_t binding, uint32_t index);
+        void Queue(const PendingWrite& write);
+        void ApplyWrites(uint32_t frameIndex);
+    };
+}
@@ -0,0 +1,402 @@
+//
+// Created by lepag on 7/16/2025.
+//
+
+#include "defragmenter.h"
+
+#include "rendering_device.h"
+
+namespace GyroEngine::Device
+{
+    Defragmenter& Defragmenter::SetEnabled(const bool enabled)
+    {
+        m_enabled = enabled;
+        return *this;
+    }
+
+    Defragmenter& Defragmenter::SetMaxBytesPerPass(const VkDeviceSize bytes)
+    {
+        m_maxBytesPerPass = bytes;
+        return *this;
+    }
+
+    Defragmenter& Defragmenter::SetMaxAllocationsPerPass(const uint32_t allocations)
+    {
+        m_maxAllocationsPerPass = allocations;
+        return *this;
+    }
+
+    Defragmenter& Defragmenter::SetFragmentationThreshold(const float ratio)
+    {
+        m_fragmentationThreshold = ratio;
+        return *this;
+    }
+
+    Defragmenter& Defragmenter::SetCheckInterval(const uint32_t frames)
+    {
+        m_checkInterval = frames;
+        return *this;
+    }
+
+    bool Defragmenter::Init()
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_device.GetDeviceFamilies().GetGraphicsQueue().family;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        if (vkCreateCommandPool(m_device.GetLogicalDevice(), &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create defragmentation command pool");
+            return false;
+        }
+
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = m_commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(m_device.GetLogicalDevice(), &allocateInfo, &m_commandBuffer) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to allocate defragmentation command buffer");
+            Cleanup();
+            return false;
+        }
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(m_device.GetLogicalDevice(), &fenceInfo, nullptr, &m_fence) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create defragmentation fence");
+            Cleanup();
+            return false;
+        }
+        return true;
+    }
+
+    void Defragmenter::Cleanup()
+    {
+        std::lock_guard lock(m_mutex);
+        Cancel();
+
+        if (m_fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(m_device.GetLogicalDevice(), m_fence, nullptr);
+            m_fence = VK_NULL_HANDLE;
+        }
+        if (m_commandPool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(m_device.GetLogicalDevice(), m_commandPool, nullptr);
+            m_commandPool = VK_NULL_HANDLE;
+            m_commandBuffer = VK_NULL_HANDLE;
+        }
+    }
+
+    void Defragmenter::Update()
+    {
+        std::lock_guard lock(m_mutex);
+        m_frame++;
+
+        switch (m_state)
+        {
+        case State::Idle:
+            {
+                if (!m_enabled || m_commandPool == VK_NULL_HANDLE)
+                {
+                    return;
+                }
+                if (!m_requested)
+                {
+                    if (m_frame - m_lastCheckFrame < m_checkInterval)
+                    {
+                        return;
+                    }
+                    m_lastCheckFrame = m_frame;
+                    if (CalculateFragmentation() < m_fragmentationThreshold)
+                    {
+                        return;
+                    }
+                }
+                m_requested = false;
+                if (Begin())
+                {
+                    BeginPass();
+                }
+            }
+            break;
+        case State::BeginPass:
+            BeginPass();
+            break;
+        case State::Copying:
+            if (vkGetFenceStatus(m_device.GetLogicalDevice(), m_fence) == VK_SUCCESS)
+            {
+                CommitPass();
+            }
+            break;
+        case State::Retiring:
+            if (m_frame >= m_retireFrame)
+            {
+                EndPass();
+            }
+            break;
+        }
+    }
+
+    void Defragmenter::Request()
+    {
+        std::lock_guard lock(m_mutex);
+        m_requested = true;
+    }
+
+    bool Defragmenter::Release(VmaAllocation allocation)
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_state != State::Copying && m_state != State::Retiring)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < m_pass.moveCount; ++i)
+        {
+            VmaDefragmentationMove& move = m_pass.pMoves[i];
+            if (move.srcAllocation != allocation)
+            {
+                continue;
+            }
+
+            // The copy may still be reading from or writing to the owner's handles
+            if (m_state == State::Copying)
+            {
+                vkWaitForFences(m_device.GetLogicalDevice(), 1, &m_fence, VK_TRUE, UINT64_MAX);
+                if (m_passTargets[i])
+                {
+                    m_passTargets[i]->AbortRelocation();
+                }
+            }
+            m_passTargets[i] = nullptr;
+
+            // VMA frees both the old and the new place when the pass ends
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+            return true;
+        }
+        return false;
+    }
+
+    float Defragmenter::CalculateFragmentation() const
+    {
+        VmaTotalStatistics statistics = {};
+        vmaCalculateStatistics(m_device.GetAllocator(), &statistics);
+
+        const VkDeviceSize blockBytes = statistics.total.statistics.blockBytes;
+        if (blockBytes == 0)
+        {
+            return 0.0f;
+        }
+        return 1.0f - static_cast<float>(statistics.total.statistics.allocationBytes) / static_cast<float>(blockBytes);
+    }
+
+    bool Defragmenter::Begin()
+    {
+        VmaDefragmentationInfo info = {};
+        info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        info.maxBytesPerPass = m_maxBytesPerPass;
+        info.maxAllocationsPerPass = m_maxAllocationsPerPass;
+
+        if (vmaBeginDefragmentation(m_device.GetAllocator(), &info, &m_context) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to begin defragmentation");
+            m_context = VK_NULL_HANDLE;
+            return false;
+        }
+
+        m_report = {};
+        m_report.fragmentationBefore = CalculateFragmentation();
+        m_report.frames = m_frame;
+        m_state = State::BeginPass;
+        return true;
+    }
+
+    void Defragmenter::BeginPass()
+    {
+        m_pass = {};
+        const VkResult result = vmaBeginDefragmentationPass(m_device.GetAllocator(), m_context, &m_pass);
+        if (result == VK_SUCCESS)
+        {
+            // Nothing left worth moving
+            Finish();
+            return;
+        }
+        if (result != VK_INCOMPLETE)
+        {
+            Logger::LogError("Failed to begin defragmentation pass");
+            Finish();
+            return;
+        }
+        m_report.passes++;
+        m_passTargets.assign(m_pass.moveCount, nullptr);
+
+        vkResetCommandBuffer(m_commandBuffer, 0);
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+
+        // Earlier submissions may still write to the resources being moved
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        uint32_t copyCount = 0;
+        for (uint32_t i = 0; i < m_pass.moveCount; ++i)
+        {
+            VmaDefragmentationMove& move = m_pass.pMoves[i];
+
+            VmaAllocationInfo allocationInfo = {};
+            vmaGetAllocationInfo(m_device.GetAllocator(), move.srcAllocation, &allocationInfo);
+            auto* target = static_cast<DefragmentationTarget*>(allocationInfo.pUserData);
+
+            if (!target || !target->CanRelocate() || !target->RecordRelocation(m_commandBuffer, move.dstTmpAllocation))
+            {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+            m_passTargets[i] = target;
+            copyCount++;
+        }
+
+        // Later submissions must see the copies
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(m_commandBuffer);
+
+        if (copyCount == 0)
+        {
+            EndPass();
+            return;
+        }
+
+        // Recorded on the graphics queue so the copies are ordered against the frames reading the old resources
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_commandBuffer;
+
+        vkResetFences(m_device.GetLogicalDevice(), 1, &m_fence);
+        if (vkQueueSubmit(m_device.GetDeviceFamilies().GetGraphicsQueue().queue, 1, &submitInfo, m_fence) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to submit defragmentation pass");
+            for (uint32_t i = 0; i < m_pass.moveCount; ++i)
+            {
+                if (m_passTargets[i])
+                {
+                    m_passTargets[i]->AbortRelocation();
+                    m_passTargets[i] = nullptr;
+                    m_pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                }
+            }
+            EndPass();
+            return;
+        }
+        m_state = State::Copying;
+    }
+
+    void Defragmenter::CommitPass()
+    {
+        for (auto* target : m_passTargets)
+        {
+            if (target)
+            {
+                m_retired.push_back(target->CommitRelocation());
+            }
+        }
+        m_generation++;
+
+        // Frames recorded before the swap may still reference the old handles
+        m_retireFrame = m_frame + m_device.GetMaxFramesInFlight();
+        m_state = State::Retiring;
+    }
+
+    void Defragmenter::EndPass()
+    {
+        for (const auto& destroy : m_retired)
+        {
+            destroy();
+        }
+        m_retired.clear();
+        m_passTargets.clear();
+
+        const VkResult result = vmaEndDefragmentationPass(m_device.GetAllocator(), m_context, &m_pass);
+        m_pass = {};
+        if (result == VK_INCOMPLETE)
+        {
+            m_state = State::BeginPass;
+            return;
+        }
+        Finish();
+    }
+
+    void Defragmenter::Finish()
+    {
+        VmaDefragmentationStats stats = {};
+        vmaEndDefragmentation(m_device.GetAllocator(), m_context, &stats);
+        m_context = VK_NULL_HANDLE;
+        m_state = State::Idle;
+        m_lastCheckFrame = m_frame;
+
+        m_report.bytesMoved = stats.bytesMoved;
+        m_report.bytesFreed = stats.bytesFreed;
+        m_report.allocationsMoved = stats.allocationsMoved;
+        m_report.blocksFreed = stats.deviceMemoryBlocksFreed;
+        m_report.frames = m_frame - m_report.frames;
+        m_report.fragmentationAfter = CalculateFragmentation();
+        m_lastReport = m_report;
+
+        Logger::Log("Defragmentation moved {} allocations ({} bytes) and freed {} bytes in {} blocks over {} frames, "
+                    "fragmentation {:.1f}% -> {:.1f}%",
+                    m_report.allocationsMoved, m_report.bytesMoved, m_report.bytesFreed, m_report.blocksFreed,
+                    m_report.frames, m_report.fragmentationBefore * 100.0f, m_report.fragmentationAfter * 100.0f);
+    }
+
+    void Defragmenter::Cancel()
+    {
+        if (m_state == State::Idle)
+        {
+            return;
+        }
+
+        if (m_state == State::Copying)
+        {
+            vkWaitForFences(m_device.GetLogicalDevice(), 1, &m_fence, VK_TRUE, UINT64_MAX);
+            for (uint32_t i = 0; i < m_pass.moveCount; ++i)
+            {
+                if (m_passTargets[i])
+                {
+                    m_passTargets[i]->AbortRelocation();
+                    m_pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                }
+            }
+            m_passTargets.clear();
+        }
+
+        if (m_state == State::Copying || m_state == State::Retiring)
+        {
+            // Committed moves are kept, the owners already use the new handles
+            m_device.WaitForIdle();
+            for (const auto& destroy : m_retired)
+            {
+                destroy();
+            }
+            m_retired.clear();
+            vmaEndDefragmentationPass(m_device.GetAllocator(), m_context, &m_pass);
+            m_pass = {};
+        }
+
+        vmaEndDefragmentation(m_device.GetAllocator(), m_context, nullptr);
+        m_context = VK_NULL_HANDLE;
+        m_state = State::Idle;
+    }
+}
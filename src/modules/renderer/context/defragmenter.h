@@ -0,0 +1,145 @@
+//
+// Created by lepag on 7/16/2025.
+//
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <volk.h>
+
+#include "implementation/vma_implementation.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+
+    /// @brief Implemented by resources whose memory the defragmenter is allowed to move
+    /// @note The target registers itself as the VMA allocation's user data
+    class DefragmentationTarget
+    {
+    public:
+        virtual ~DefragmentationTarget() = default;
+
+        /// @brief Whether the resource can move right now, e.g. false while it's mapped or written by the GPU
+        [[nodiscard]] virtual bool CanRelocate() const = 0;
+
+        /// @brief Creates the resource again on top of dstAllocation and records the copy of its contents into cmd
+        virtual bool RecordRelocation(VkCommandBuffer cmd, VmaAllocation dstAllocation) = 0;
+
+        /// @brief Switches to the copy once it's complete
+        /// @return Destroys the old handles, called once no frame in flight can reference them anymore
+        virtual std::function<void()> CommitRelocation() = 0;
+
+        /// @brief Destroys the copy created by RecordRelocation, the resource keeps its current handles
+        virtual void AbortRelocation() = 0;
+    };
+
+    /// @brief What a completed defragmentation recovered
+    struct DefragmentationReport
+    {
+        VkDeviceSize bytesMoved = 0;
+        VkDeviceSize bytesFreed = 0;
+        uint32_t allocationsMoved = 0;
+        uint32_t blocksFreed = 0;
+        uint32_t passes = 0;
+        uint64_t frames = 0;
+        /// @brief Ratio of allocated block memory that isn't used by any allocation
+        float fragmentationBefore = 0.0f;
+        float fragmentationAfter = 0.0f;
+    };
+
+    /// @brief Incrementally defragments VMA memory in the background, one bounded pass at a time
+    /// @note A pass copies on the GPU, swaps the affected handles once the copy is done and frees the old ones after
+    /// every frame in flight that could use them has completed
+    class Defragmenter
+    {
+    public:
+        explicit Defragmenter(RenderingDevice& device): m_device(device) {}
+        ~Defragmenter() { Cleanup(); }
+
+        Defragmenter& SetEnabled(bool enabled = true);
+        /// @brief Upper bound of bytes copied by a single pass
+        Defragmenter& SetMaxBytesPerPass(VkDeviceSize bytes);
+        Defragmenter& SetMaxAllocationsPerPass(uint32_t allocations);
+        /// @brief Fragmentation ratio at which a defragmentation is started automatically
+        Defragmenter& SetFragmentationThreshold(float ratio);
+        /// @brief How many frames to wait between fragmentation checks
+        Defragmenter& SetCheckInterval(uint32_t frames);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Advances the current defragmentation by one step, call once per frame after the frame's fence
+        void Update();
+
+        /// @brief Starts a defragmentation on the next update, regardless of the fragmentation threshold
+        void Request();
+
+        /// @brief Takes the allocation over if it's part of the current pass, so its owner can be destroyed mid-pass
+        /// @return True when the owner must only destroy its handles and leave freeing the allocation to VMA
+        bool Release(VmaAllocation allocation);
+
+        /// @brief Incremented every time handles are swapped, descriptors compare against it to know when to refresh
+        [[nodiscard]] uint64_t GetGeneration() const
+        {
+            return m_generation;
+        }
+
+        [[nodiscard]] bool IsRunning() const
+        {
+            return m_state != State::Idle;
+        }
+
+        [[nodiscard]] const DefragmentationReport& GetLastReport() const
+        {
+            return m_lastReport;
+        }
+
+        [[nodiscard]] float CalculateFragmentation() const;
+    private:
+        enum class State
+        {
+            Idle,
+            BeginPass,
+            Copying,
+            Retiring
+        };
+
+        RenderingDevice& m_device;
+
+        std::recursive_mutex m_mutex;
+        State m_state = State::Idle;
+        VmaDefragmentationContext m_context = VK_NULL_HANDLE;
+        VmaDefragmentationPassMoveInfo m_pass = {};
+        std::vector<DefragmentationTarget*> m_passTargets;
+        std::vector<std::function<void()>> m_retired;
+
+        VkCommandPool m_commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+        VkFence m_fence = VK_NULL_HANDLE;
+
+        bool m_enabled = true;
+        bool m_requested = false;
+        VkDeviceSize m_maxBytesPerPass = 16 * 1024 * 1024;
+        uint32_t m_maxAllocationsPerPass = 64;
+        float m_fragmentationThreshold = 0.3f;
+        uint32_t m_checkInterval = 600;
+
+        uint64_t m_frame = 0;
+        uint64_t m_lastCheckFrame = 0;
+        uint64_t m_retireFrame = 0;
+        uint64_t m_generation = 0;
+
+        DefragmentationReport m_report;
+        DefragmentationReport m_lastReport;
+
+        bool Begin();
+        void BeginPass();
+        void CommitPass();
+        void EndPass();
+        void Finish();
+        void Cancel();
+    };
+}
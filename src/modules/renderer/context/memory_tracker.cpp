@@ -0,0 +1,310 @@
+//
+// Created by lepag on 7/15/2025.
+//
+
+#include "memory_tracker.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+
+#include "rendering_device.h"
+
+namespace GyroEngine::Device
+{
+    MemoryTracker& MemoryTracker::SetWarningThreshold(const float ratio)
+    {
+        std::lock_guard lock(m_mutex);
+        m_warningThreshold = ratio;
+        return *this;
+    }
+
+    MemoryTracker& MemoryTracker::SetCriticalThreshold(const float ratio)
+    {
+        std::lock_guard lock(m_mutex);
+        m_criticalThreshold = ratio;
+        return *this;
+    }
+
+    MemoryTracker& MemoryTracker::SetCategoryLimit(MemoryCategory category, const VkDeviceSize bytes)
+    {
+        std::lock_guard lock(m_mutex);
+        m_categoryLimits[static_cast<size_t>(category)] = bytes;
+        return *this;
+    }
+
+    void MemoryTracker::Track(VmaAllocation allocation, const MemoryCategory category, const std::string& owner)
+    {
+        if (allocation == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        VmaAllocationInfo info{};
+        vmaGetAllocationInfo(m_device.GetAllocator(), allocation, &info);
+        if (!owner.empty())
+        {
+            vmaSetAllocationName(m_device.GetAllocator(), allocation, owner.c_str());
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_allocations[allocation] = {category, owner, info.size};
+
+        auto& stats = m_categories[static_cast<size_t>(category)];
+        stats.bytes += info.size;
+        stats.allocationCount++;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+
+        m_currentFrame.allocations++;
+        m_currentFrame.bytesAllocated += info.size;
+
+        CheckCategoryLimit(category);
+    }
+
+    void MemoryTracker::Untrack(VmaAllocation allocation)
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_allocations.find(allocation);
+        if (it == m_allocations.end())
+        {
+            return;
+        }
+
+        auto& stats = m_categories[static_cast<size_t>(it->second.category)];
+        stats.bytes -= std::min(stats.bytes, it->second.size);
+        stats.allocationCount--;
+
+        m_currentFrame.frees++;
+        m_currentFrame.bytesFreed += it->second.size;
+
+        CheckCategoryLimit(it->second.category);
+        m_allocations.erase(it);
+    }
+
+    void MemoryTracker::BeginFrame()
+    {
+        const auto budgets = GetHeapBudgets();
+
+        std::lock_guard lock(m_mutex);
+        m_lastFrame = m_currentFrame;
+        m_currentFrame = {};
+        m_currentFrame.frame = m_lastFrame.frame + 1;
+
+        // Lets VMA keep the budget it reports in sync without querying the driver on every allocation
+        vmaSetCurrentFrameIndex(m_device.GetAllocator(), static_cast<uint32_t>(m_currentFrame.frame));
+
+        CheckHeapThresholds(budgets);
+    }
+
+    std::vector<HeapBudget> MemoryTracker::GetHeapBudgets() const
+    {
+        const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+        vmaGetMemoryProperties(m_device.GetAllocator(), &memoryProperties);
+
+        VmaBudget vmaBudgets[VK_MAX_MEMORY_HEAPS] = {};
+        vmaGetHeapBudgets(m_device.GetAllocator(), vmaBudgets);
+
+        std::vector<HeapBudget> budgets;
+        budgets.reserve(memoryProperties->memoryHeapCount);
+        for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+        {
+            HeapBudget budget;
+            budget.heapIndex = i;
+            budget.flags = memoryProperties->memoryHeaps[i].flags;
+            budget.heapSize = memoryProperties->memoryHeaps[i].size;
+            budget.budget = vmaBudgets[i].budget;
+            budget.usage = vmaBudgets[i].usage;
+            budget.blockBytes = vmaBudgets[i].statistics.blockBytes;
+            budget.allocationBytes = vmaBudgets[i].statistics.allocationBytes;
+            budget.blockCount = vmaBudgets[i].statistics.blockCount;
+            budget.allocationCount = vmaBudgets[i].statistics.allocationCount;
+            budgets.push_back(budget);
+        }
+        return budgets;
+    }
+
+    CategoryStats MemoryTracker::GetCategoryStats(MemoryCategory category) const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_categories[static_cast<size_t>(category)];
+    }
+
+    FrameMemoryCounters MemoryTracker::GetFrameCounters() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_lastFrame;
+    }
+
+    FrameMemoryCounters MemoryTracker::GetCurrentFrameCounters() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_currentFrame;
+    }
+
+    std::string MemoryTracker::DumpJson(const bool detailed) const
+    {
+        using nlohmann::json;
+
+        json root;
+        root["budgetExtension"] = HasBudgetExtension();
+
+        json heaps = json::array();
+        for (const auto& budget : GetHeapBudgets())
+        {
+            heaps.push_back({
+                {"index", budget.heapIndex},
+                {"deviceLocal", budget.IsDeviceLocal()},
+                {"size", budget.heapSize},
+                {"budget", budget.budget},
+                {"usage", budget.usage},
+                {"blockBytes", budget.blockBytes},
+                {"allocationBytes", budget.allocationBytes},
+                {"blockCount", budget.blockCount},
+                {"allocationCount", budget.allocationCount}
+            });
+        }
+        root["heaps"] = heaps;
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            json categories = json::object();
+            for (size_t i = 0; i < CategoryCount; ++i)
+            {
+                const auto& stats = m_categories[i];
+                categories[GetCategoryName(static_cast<MemoryCategory>(i))] = {
+                    {"bytes", stats.bytes},
+                    {"peakBytes", stats.peakBytes},
+                    {"allocationCount", stats.allocationCount},
+                    {"limit", m_categoryLimits[i]}
+                };
+            }
+            root["categories"] = categories;
+
+            // Several allocations can share an owner (e.g. a mesh's vertex and index buffer), report them together
+            std::map<std::string, std::pair<VkDeviceSize, uint32_t>> owners;
+            for (const auto& [allocation, record] : m_allocations)
+            {
+                auto& [bytes, count] = owners[record.owner.empty() ? "<unnamed>" : record.owner];
+                bytes += record.size;
+                count++;
+            }
+            std::vector<std::pair<std::string, std::pair<VkDeviceSize, uint32_t>>> sortedOwners(owners.begin(), owners.end());
+            std::sort(sortedOwners.begin(), sortedOwners.end(), [](const auto& a, const auto& b)
+            {
+                return a.second.first > b.second.first;
+            });
+
+            json ownerList = json::array();
+            for (const auto& [owner, usage] : sortedOwners)
+            {
+                ownerList.push_back({{"owner", owner}, {"bytes", usage.first}, {"allocationCount", usage.second}});
+            }
+            root["owners"] = ownerList;
+
+            root["frame"] = {
+                {"frame", m_lastFrame.frame},
+                {"allocations", m_lastFrame.allocations},
+                {"frees", m_lastFrame.frees},
+                {"bytesAllocated", m_lastFrame.bytesAllocated},
+                {"bytesFreed", m_lastFrame.bytesFreed}
+            };
+        }
+
+        if (detailed)
+        {
+            char* statsString = nullptr;
+            vmaBuildStatsString(m_device.GetAllocator(), &statsString, VK_TRUE);
+            if (statsString)
+            {
+                root["vma"] = json::parse(statsString, nullptr, false);
+                vmaFreeStatsString(m_device.GetAllocator(), statsString);
+            }
+        }
+
+        return root.dump(2);
+    }
+
+    bool MemoryTracker::DumpJson(const std::string& path, const bool detailed) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            Logger::LogError("Failed to open memory dump file: " + path);
+            return false;
+        }
+        file << DumpJson(detailed);
+        return true;
+    }
+
+    bool MemoryTracker::HasBudgetExtension() const
+    {
+        return m_device.IsDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    const char* MemoryTracker::GetCategoryName(const MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::Geometry:
+            return "Geometry";
+        case MemoryCategory::Textures:
+            return "Textures";
+        case MemoryCategory::RenderTargets:
+            return "RenderTargets";
+        case MemoryCategory::Staging:
+            return "Staging";
+        case MemoryCategory::Uniforms:
+            return "Uniforms";
+        default:
+            return "Unknown";
+        }
+    }
+
+    void MemoryTracker::CheckHeapThresholds(const std::vector<HeapBudget>& budgets)
+    {
+        m_heapStates.resize(budgets.size(), ThresholdState::Normal);
+        for (const auto& budget : budgets)
+        {
+            const float ratio = budget.GetUsageRatio();
+            ThresholdState state = ThresholdState::Normal;
+            if (ratio >= m_criticalThreshold)
+            {
+                state = ThresholdState::Critical;
+            } else if (ratio >= m_warningThreshold)
+            {
+                state = ThresholdState::Warning;
+            }
+
+            // Only report when a heap gets worse, otherwise every frame above the threshold would log
+            ThresholdState& previous = m_heapStates[budget.heapIndex];
+            if (state > previous)
+            {
+                if (state == ThresholdState::Critical)
+                {
+                    Logger::LogError("Memory heap {} is at {:.1f}% of its budget ({} of {} bytes)",
+                                     budget.heapIndex, ratio * 100.0f, budget.usage, budget.budget);
+                } else
+                {
+                    Logger::LogWarning("Memory heap {} is at {:.1f}% of its budget ({} of {} bytes)",
+                                       budget.heapIndex, ratio * 100.0f, budget.usage, budget.budget);
+                }
+            }
+            previous = state;
+        }
+    }
+
+    void MemoryTracker::CheckCategoryLimit(const MemoryCategory category)
+    {
+        const auto index = static_cast<size_t>(category);
+        const VkDeviceSize limit = m_categoryLimits[index];
+        const bool overLimit = limit > 0 && m_categories[index].bytes > limit;
+        if (overLimit && !m_categoryOverLimit[index])
+        {
+            Logger::LogWarning("{} memory exceeded its limit ({} of {} bytes)", GetCategoryName(category),
+                               m_categories[index].bytes, limit);
+        }
+        m_categoryOverLimit[index] = overLimit;
+    }
+}
@@ -0,0 +1,146 @@
+//
+// Created by lepag on 7/15/2025.
+//
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+#include "implementation/vma_implementation.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+
+    /// @brief What a GPU allocation is used for, allocations are grouped by this in the memory statistics
+    enum class MemoryCategory : uint8_t
+    {
+        Unknown,
+        Geometry,
+        Textures,
+        RenderTargets,
+        Staging,
+        Uniforms,
+        Count
+    };
+
+    /// @brief Budget and usage of a single memory heap, as reported by VMA
+    struct HeapBudget
+    {
+        uint32_t heapIndex = 0;
+        VkMemoryHeapFlags flags = 0;
+        VkDeviceSize heapSize = 0;
+        /// @brief How much the process may use before the driver starts paging or failing allocations
+        VkDeviceSize budget = 0;
+        /// @brief Current usage of the whole process, including memory not allocated through VMA
+        VkDeviceSize usage = 0;
+        VkDeviceSize blockBytes = 0;
+        VkDeviceSize allocationBytes = 0;
+        uint32_t blockCount = 0;
+        uint32_t allocationCount = 0;
+
+        [[nodiscard]] bool IsDeviceLocal() const
+        {
+            return (flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        }
+
+        [[nodiscard]] float GetUsageRatio() const
+        {
+            return budget > 0 ? static_cast<float>(usage) / static_cast<float>(budget) : 0.0f;
+        }
+    };
+
+    struct CategoryStats
+    {
+        VkDeviceSize bytes = 0;
+        VkDeviceSize peakBytes = 0;
+        uint32_t allocationCount = 0;
+    };
+
+    /// @brief Allocation traffic of a single frame
+    struct FrameMemoryCounters
+    {
+        uint64_t frame = 0;
+        uint32_t allocations = 0;
+        uint32_t frees = 0;
+        VkDeviceSize bytesAllocated = 0;
+        VkDeviceSize bytesFreed = 0;
+    };
+
+    /// @brief Tags VMA allocations by category and owner, and reports heap budgets, usage and per-frame traffic
+    /// @note Thread safe, resources may be created and destroyed from any thread
+    class MemoryTracker
+    {
+    public:
+        explicit MemoryTracker(RenderingDevice& device): m_device(device) {}
+
+        /// @brief Heap usage ratio (usage / budget) at which a warning is logged
+        MemoryTracker& SetWarningThreshold(float ratio);
+        /// @brief Heap usage ratio (usage / budget) at which an error is logged
+        MemoryTracker& SetCriticalThreshold(float ratio);
+        /// @brief Logs a warning when a category grows past bytes, 0 disables the limit
+        MemoryTracker& SetCategoryLimit(MemoryCategory category, VkDeviceSize bytes);
+
+        /// @brief Records a new allocation and names it in VMA so it also shows up in VMA's own statistics
+        void Track(VmaAllocation allocation, MemoryCategory category, const std::string& owner);
+        void Untrack(VmaAllocation allocation);
+
+        /// @brief Closes the previous frame's counters, advances VMA's frame index and checks the thresholds
+        void BeginFrame();
+
+        [[nodiscard]] std::vector<HeapBudget> GetHeapBudgets() const;
+        [[nodiscard]] CategoryStats GetCategoryStats(MemoryCategory category) const;
+        /// @brief Counters of the last completed frame
+        [[nodiscard]] FrameMemoryCounters GetFrameCounters() const;
+        /// @brief Counters of the frame currently being recorded
+        [[nodiscard]] FrameMemoryCounters GetCurrentFrameCounters() const;
+
+        /// @brief Serializes budgets, categories, owners and frame counters to JSON
+        /// @param detailed Also embeds VMA's own statistics, which list every block and allocation
+        [[nodiscard]] std::string DumpJson(bool detailed = false) const;
+        bool DumpJson(const std::string& path, bool detailed = false) const;
+
+        [[nodiscard]] bool HasBudgetExtension() const;
+
+        static const char* GetCategoryName(MemoryCategory category);
+    private:
+        struct AllocationRecord
+        {
+            MemoryCategory category = MemoryCategory::Unknown;
+            std::string owner;
+            VkDeviceSize size = 0;
+        };
+
+        enum class ThresholdState : uint8_t
+        {
+            Normal,
+            Warning,
+            Critical
+        };
+
+        static constexpr size_t CategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+        RenderingDevice& m_device;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<VmaAllocation, AllocationRecord> m_allocations;
+        std::array<CategoryStats, CategoryCount> m_categories{};
+        std::array<VkDeviceSize, CategoryCount> m_categoryLimits{};
+        std::array<bool, CategoryCount> m_categoryOverLimit{};
+        std::vector<ThresholdState> m_heapStates;
+
+        FrameMemoryCounters m_currentFrame;
+        FrameMemoryCounters m_lastFrame;
+
+        float m_warningThreshold = 0.8f;
+        float m_criticalThreshold = 0.95f;
+
+        void CheckHeapThresholds(const std::vector<HeapBudget>& budgets);
+        void CheckCategoryLimit(MemoryCategory category);
+    };
+}
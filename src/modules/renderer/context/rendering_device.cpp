@@ -36,6 +36,9 @@ bool RenderingDevice::Init()
     if (!CreateAllocator()) return false;
     if (!CreateCommandPool()) return false;
     if (!CreateDeviceFamilies()) return false;
+    if (!CreateDefragmenter()) return false;
+    if (!CreateBindlessHeap()) return false;
+    if (!CreateSamplerCache()) return false;
     if (!QueryAllSupportedColorFormats()) return false;
     if (!QueryAllSupportedDepthFormats()) return false;
     if (!FindPreferredColorFormat()) return false;
@@ -376,7 +379,8 @@ bool RenderingDevice::CreateLogicalDevice()
         VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
         VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        VK_EXT_DYNAMIC_RENDERING_UNUSED_ATTACHMENTS_EXTENSION_NAME
+        VK_EXT_DYNAMIC_RENDERING_UNUSED_ATTACHMENTS_EXTENSION_NAME,
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
     });
 
     VkPhysicalDeviceDynamicRenderingUnusedAttachmentsFeaturesEXT unusedAttachmentFeatures{};
@@ -399,9 +403,32 @@ bool RenderingDevice::CreateLogicalDevice()
     indexingFeatures.runtimeDescriptorArray = VK_TRUE;
     indexingFeatures.pNext = &dynamicRenderingFeatures;
 
+    // Buffer device addresses are optional, buffers fall back to descriptors when the device lacks them
+    VkPhysicalDeviceBufferDeviceAddressFeatures supportedAddressFeatures{};
+    supportedAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supportedAddressFeatures;
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
+    m_supportsBufferDeviceAddress = supportedAddressFeatures.bufferDeviceAddress == VK_TRUE;
+    m_supportsMultiDrawIndirect = supportedFeatures.features.multiDrawIndirect == VK_TRUE;
+
+    VkPhysicalDeviceFeatures enabledFeatures{};
+    enabledFeatures.multiDrawIndirect = m_supportsMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+    // Block compressed textures are loaded in whichever of these formats the device has
+    enabledFeatures.textureCompressionBC = supportedFeatures.features.textureCompressionBC;
+    enabledFeatures.textureCompressionETC2 = supportedFeatures.features.textureCompressionETC2;
+    enabledFeatures.textureCompressionASTC_LDR = supportedFeatures.features.textureCompressionASTC_LDR;
+
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
+    bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+    bufferDeviceAddressFeatures.bufferDeviceAddress = m_supportsBufferDeviceAddress ? VK_TRUE : VK_FALSE;
+    bufferDeviceAddressFeatures.pNext = &indexingFeatures;
+
     VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
     synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
-    synchronization2Features.pNext = &indexingFeatures;
+    synchronization2Features.pNext = &bufferDeviceAddressFeatures;
 
     const std::vector<const char*> supportedDeviceExtensions = Utils::Device::EnumerateVectorForSupportedDeviceExtensions(
         m_physicalDevice, deviceExtensions.extensions);
@@ -411,6 +438,7 @@ bool RenderingDevice::CreateLogicalDevice()
     createInfo.enabledExtensionCount = static_cast<uint32_t>(supportedDeviceExtensions.size());
     createInfo.ppEnabledExtensionNames = supportedDeviceExtensions.data();
     createInfo.pNext = &synchronization2Features;
+    createInfo.pEnabledFeatures = &enabledFeatures;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
@@ -420,6 +448,7 @@ bool RenderingDevice::CreateLogicalDevice()
         Logger::LogError("Failed to create logical device");
         return false;
     }
+    m_enabledDeviceExtensions.assign(supportedDeviceExtensions.begin(), supportedDeviceExtensions.end());
 
     m_maid.Add([&]
     {
@@ -499,6 +528,16 @@ bool RenderingDevice::CreateAllocator()
     allocatorInfo.instance = m_instance;
     allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
     allocatorInfo.pVulkanFunctions = &vmaFuncs;
+    if (IsDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        // Without this VMA can only estimate the budget from the heap sizes
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+    if (m_supportsBufferDeviceAddress)
+    {
+        // Lets VMA allocate the memory of device address buffers with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    }
 
     if (vmaCreateAllocator(&allocatorInfo, &m_allocator) != VK_SUCCESS) {
         Logger::LogError("Failed to create VMA allocator");
@@ -509,6 +548,11 @@ bool RenderingDevice::CreateAllocator()
         DestroyAllocator();
     });
 
+    m_memoryTracker = std::make_unique<MemoryTracker>(*this);
+    m_maid.Add([&] {
+        m_memoryTracker.reset();
+    });
+
     return true;
 }
 
@@ -530,6 +574,46 @@ bool RenderingDevice::CreateCommandPool()
     return true;
 }
 
+bool RenderingDevice::CreateDefragmenter()
+{
+    m_defragmenter = std::make_unique<Defragmenter>(*this);
+    if (!m_defragmenter->Init())
+    {
+        Logger::LogError("Failed to create defragmenter");
+        return false;
+    }
+    m_maid.Add([&]
+    {
+        m_defragmenter.reset();
+    });
+    return true;
+}
+
+bool RenderingDevice::CreateBindlessHeap()
+{
+    m_bindlessHeap = std::make_unique<BindlessHeap>(*this);
+    if (!m_bindlessHeap->Init())
+    {
+        Logger::LogError("Failed to create bindless heap");
+        return false;
+    }
+    m_maid.Add([&]
+    {
+        m_bindlessHeap.reset();
+    });
+    return true;
+}
+
+bool RenderingDevice::CreateSamplerCache()
+{
+    m_samplerCache = std::make_unique<SamplerCache>(*this);
+    m_maid.Add([&]
+    {
+        m_samplerCache.reset();
+    });
+    return true;
+}
+
 bool RenderingDevice::QueryAllSupportedColorFormats()
 {
     const std::vector availableColorFormats = {
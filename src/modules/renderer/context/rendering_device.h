@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <any>
 #include <memory>
+#include <string>
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_vulkan.h>
@@ -16,6 +18,10 @@
 #include "implementation/volk_implementation.h"
 #include "implementation/vma_implementation.h"
 #include "utilities/device.h"
+#include "memory_tracker.h"
+#include "defragmenter.h"
+#include "bindless_heap.h"
+#include "sampler_cache.h"
 
 
 namespace GyroEngine::Device
@@ -212,6 +218,44 @@ namespace GyroEngine::Device
             return m_deviceFamilies;
         }
 
+        [[nodiscard]] MemoryTracker &GetMemoryTracker()
+        {
+            return *m_memoryTracker;
+        }
+
+        [[nodiscard]] Defragmenter &GetDefragmenter()
+        {
+            return *m_defragmenter;
+        }
+
+        [[nodiscard]] BindlessHeap &GetBindlessHeap()
+        {
+            return *m_bindlessHeap;
+        }
+
+        [[nodiscard]] SamplerCache &GetSamplerCache()
+        {
+            return *m_samplerCache;
+        }
+
+        /// @brief Whether buffers can be created with a device address that shaders dereference directly
+        [[nodiscard]] bool SupportsBufferDeviceAddress() const
+        {
+            return m_supportsBufferDeviceAddress;
+        }
+
+        /// @brief Whether one indirect draw call can issue more than one draw
+        [[nodiscard]] bool SupportsMultiDrawIndirect() const
+        {
+            return m_supportsMultiDrawIndirect;
+        }
+
+        [[nodiscard]] bool IsDeviceExtensionEnabled(const std::string &extension) const
+        {
+            return std::find(m_enabledDeviceExtensions.begin(), m_enabledDeviceExtensions.end(), extension) !=
+                   m_enabledDeviceExtensions.end();
+        }
+
     private:
         // Device objects
 
@@ -222,12 +266,20 @@ namespace GyroEngine::Device
         VmaAllocator m_allocator = VK_NULL_HANDLE;
         VkCommandPool m_commandPool = VK_NULL_HANDLE;
         DeviceFamilies m_deviceFamilies;
+        std::unique_ptr<MemoryTracker> m_memoryTracker;
+        std::unique_ptr<Defragmenter> m_defragmenter;
+        std::unique_ptr<BindlessHeap> m_bindlessHeap;
+        std::unique_ptr<SamplerCache> m_samplerCache;
         Maid m_maid;
 
+        std::vector<std::string> m_enabledDeviceExtensions;
+
         std::vector<VkFormat> m_supportedColorFormats;
         std::vector<VkFormat> m_supportedDepthFormats;
 
         uint32_t m_maxFramesInFlight = 2;
+        bool m_supportsBufferDeviceAddress = false;
+        bool m_supportsMultiDrawIndirect = false;
         PreferredColorFormatType m_preferredColorType = PreferredColorFormatType::sRGB;
         VkFormat m_colorFormat = VK_FORMAT_UNDEFINED;
         VkFormat m_swapchainColorFormat = VK_FORMAT_UNDEFINED;
@@ -257,6 +309,12 @@ namespace GyroEngine::Device
 
         bool CreateCommandPool();
 
+        bool CreateDefragmenter();
+
+        bool CreateBindlessHeap();
+
+        bool CreateSamplerCache();
+
         bool QueryAllSupportedColorFormats();
 
         bool QueryAllSupportedDepthFormats();
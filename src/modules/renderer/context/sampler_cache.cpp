@@ -0,0 +1,56 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "sampler_cache.h"
+
+#include "rendering_device.h"
+
+namespace GyroEngine::Device
+{
+    Resources::SamplerHandle SamplerCache::Acquire(const Resources::SamplerState& state)
+    {
+        const Resources::SamplerState key = state.Normalized();
+        std::lock_guard lock(m_mutex);
+        if (const auto it = m_samplers.find(key); it != m_samplers.end())
+        {
+            if (Resources::SamplerHandle sampler = it->second.lock())
+            {
+                return sampler;
+            }
+        }
+
+        auto sampler = std::make_shared<Resources::Sampler>(m_device);
+        sampler->SetState(key);
+        if (!sampler->Init())
+        {
+            Logger::LogError("Failed to create cached sampler");
+            return nullptr;
+        }
+        sampler->RegisterBindless();
+
+        // Expired entries go whenever a new state is added, so the map stays as small as the set of live samplers
+        EraseExpired();
+        m_samplers[key] = sampler;
+        return sampler;
+    }
+
+    size_t SamplerCache::GetSamplerCount()
+    {
+        std::lock_guard lock(m_mutex);
+        size_t count = 0;
+        for (const auto& [state, sampler] : m_samplers)
+        {
+            count += sampler.expired() ? 0 : 1;
+        }
+        return count;
+    }
+
+    void SamplerCache::EraseExpired()
+    {
+        for (auto it = m_samplers.begin(); it != m_samplers.end();)
+        {
+            it = it->second.expired() ? m_samplers.erase(it) : std::next(it);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "resources/texture/sampler.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+
+    /// @brief Shares one sampler between everything asking for the same state
+    /// @note Drivers cap the number of live samplers, often at 4000, while scenes only use a handful of states. The
+    /// cache holds no reference itself, a sampler is destroyed once the last handle to it goes
+    class SamplerCache
+    {
+    public:
+        explicit SamplerCache(RenderingDevice& device): m_device(device) {}
+
+        /// @brief Sampler created from state, registered in the bindless heap, nullptr when it can't be created
+        [[nodiscard]] Resources::SamplerHandle Acquire(const Resources::SamplerState& state);
+
+        /// @brief Unique samplers alive, for statistics
+        [[nodiscard]] size_t GetSamplerCount();
+    private:
+        RenderingDevice& m_device;
+
+        std::mutex m_mutex;
+        std::unordered_map<Resources::SamplerState, std::weak_ptr<Resources::Sampler>, Resources::SamplerStateHash>
+        m_samplers;
+
+        /// @brief Drops the entries of samplers nothing uses anymore
+        void EraseExpired();
+    };
+}
@@ -3,18 +3,52 @@
 //
 
 #include "mesh_factory.h"
+#include <filesystem>
 #include <vector>
 
-#include "utilities/mesh.h"
+#include "utilities/mesh_cache.h"
+#include "../resources/asset_registry.h"
 #include "../../../core/engine.h"
 
 namespace GyroEngine::Factories
 {
     Resources::MeshHandle MeshFactory::CreateCube()
+    {
+        auto geometry = Resources::AssetRegistry::Get().GetMeshes().Acquire("Cube", [] { return BuildCube(); });
+        if (!geometry)
+        {
+            return nullptr;
+        }
+        return std::make_shared<Resources::Mesh>(*Engine::Get().GetDeviceSmart(), geometry);
+    }
+
+    Resources::MeshHandle MeshFactory::CreateFromFile(const std::string &filePath)
+    {
+        // Keyed by the normalized path, so different spellings of the same file share one geometry
+        const std::string key = std::filesystem::path(filePath).lexically_normal().generic_string();
+        auto geometry = Resources::AssetRegistry::Get().GetMeshes().Acquire(key, [&filePath]
+        {
+            return LoadFromFile(filePath);
+        });
+        if (!geometry)
+        {
+            return nullptr;
+        }
+        return std::make_shared<Resources::Mesh>(*Engine::Get().GetDeviceSmart(), geometry);
+    }
+
+    Resources::MeshGeometryHandle MeshFactory::BuildCube()
     {
         auto device = Engine::Get().GetDeviceSmart();
-        auto mesh = std::make_shared<Resources::Mesh>(*device);
+        auto geometry = std::make_shared<Resources::MeshGeometry>(*device);
+        StreamCube(*geometry);
+        geometry->SetSource(StreamCube);
+        geometry->SetName("Cube");
+        return geometry;
+    }
 
+    bool MeshFactory::StreamCube(Resources::MeshGeometry &geometry)
+    {
         std::vector<Types::Vertex> vertices = {
         // Front face (+Z)
         {{-0.5f, -0.5f,  0.5f}, {0, 0, 1}, {0, 0}, {1, 0, 0}, {1, 0, 0, 1}},
@@ -58,24 +92,42 @@ namespace GyroEngine::Factories
     };
 
 
-        mesh->UseVertices(vertices);
-        mesh->UseIndices(indices);
-        return mesh;
+        geometry.UseVertices(vertices);
+        geometry.UseIndices(indices);
+        return true;
     }
 
-    Resources::MeshHandle MeshFactory::CreateFromFile(const std::string &filePath)
+    Resources::MeshGeometryHandle MeshFactory::LoadFromFile(const std::string &filePath)
     {
         auto device = Engine::Get().GetDeviceSmart();
-        auto mesh = std::make_shared<Resources::Mesh>(*device);
-        auto [vertices, indices] = Utils::Mesh::LoadMeshDataFromFile(filePath);
-        if (vertices.empty() || indices.empty())
+        auto geometry = std::make_shared<Resources::MeshGeometry>(*device);
+        if (!StreamFromFile(*geometry, filePath))
         {
             Logger::LogError("Failed to load mesh from file: " + filePath);
             return nullptr;
         }
 
-        mesh->UseVertices(vertices);
-        mesh->UseIndices(indices);
-        return mesh;
+        // Evicted geometry streams back in from the .gmesh cache rather than keeping a copy around
+        geometry->SetSource([filePath](Resources::MeshGeometry& target) { return StreamFromFile(target, filePath); });
+        geometry->SetName(filePath);
+        return geometry;
+    }
+
+    bool MeshFactory::StreamFromFile(Resources::MeshGeometry &geometry, const std::string &filePath)
+    {
+        // Imported through Assimp once, later loads read the .gmesh cache
+        auto meshFile = Utils::MeshCache::LoadOrImport(filePath);
+        if (meshFile.vertices.empty() || meshFile.indices.empty())
+        {
+            return false;
+        }
+
+        // Moved rather than copied, the import is the only copy of the data until it's uploaded
+        geometry.UseVertices(std::move(meshFile.vertices));
+        geometry.UseIndices(std::move(meshFile.indices));
+        geometry.UseLods(meshFile.lods);
+        geometry.UseMeshlets(meshFile.meshlets);
+        geometry.UseSubmeshes(meshFile.submeshes);
+        return true;
     }
 }
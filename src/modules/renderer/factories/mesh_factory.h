@@ -12,8 +12,16 @@ namespace GyroEngine::Factories
     class MeshFactory
     {
     public:
+        /// @note Every call returns a new mesh, the geometry is shared with the others through the asset registry
         static Resources::MeshHandle CreateCube();
+        /// @note Every call returns a new mesh, the geometry of a file is shared through the asset registry
         static Resources::MeshHandle CreateFromFile(const std::string& filePath);
+    private:
+        static Resources::MeshGeometryHandle BuildCube();
+        static Resources::MeshGeometryHandle LoadFromFile(const std::string& filePath);
+        /// @brief Sources of the geometry, also used to stream it back in after an eviction
+        static bool StreamCube(Resources::MeshGeometry& geometry);
+        static bool StreamFromFile(Resources::MeshGeometry& geometry, const std::string& filePath);
     };
 
 }
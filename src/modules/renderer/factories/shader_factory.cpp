@@ -0,0 +1,40 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#include "shader_factory.h"
+
+#include <filesystem>
+
+#include "../resources/asset_registry.h"
+#include "../../../core/engine.h"
+
+namespace GyroEngine::Factories
+{
+    Resources::ShaderHandle ShaderFactory::CreateFromFile(const std::string &filePath,
+                                                          const Utils::Shader::ShaderStage stage)
+    {
+        // The stage is part of the key, it decides how the source gets compiled
+        const std::string key = std::filesystem::path(filePath).lexically_normal().generic_string() + "#" +
+                                std::to_string(static_cast<int>(stage));
+        return Resources::AssetRegistry::Get().GetShaders().Acquire(key, [&filePath, stage]
+        {
+            return LoadFromFile(filePath, stage);
+        });
+    }
+
+    Resources::ShaderHandle ShaderFactory::LoadFromFile(const std::string &filePath,
+                                                        const Utils::Shader::ShaderStage stage)
+    {
+        auto device = Engine::Get().GetDeviceSmart();
+        auto shader = std::make_shared<Resources::Shader>(*device);
+        shader->SetShaderPath(filePath)
+            .SetShaderStage(stage);
+        if (!shader->Init())
+        {
+            Logger::LogError("Failed to load shader from file: " + filePath);
+            return nullptr;
+        }
+        return shader;
+    }
+}
@@ -0,0 +1,20 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#pragma once
+
+#include "../resources/pipeline/shader.h"
+
+namespace GyroEngine::Factories
+{
+    class ShaderFactory
+    {
+    public:
+        /// @note Shaders are shared through the asset registry, every call for the same file and stage returns the same
+        /// shader
+        static Resources::ShaderHandle CreateFromFile(const std::string& filePath, Utils::Shader::ShaderStage stage);
+    private:
+        static Resources::ShaderHandle LoadFromFile(const std::string& filePath, Utils::Shader::ShaderStage stage);
+    };
+}
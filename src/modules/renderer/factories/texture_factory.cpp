@@ -0,0 +1,54 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#include "texture_factory.h"
+
+#include <filesystem>
+
+#include "../resources/asset_registry.h"
+#include "../../../core/engine.h"
+
+namespace GyroEngine::Factories
+{
+    Resources::MipGeneratorHandle TextureFactory::s_mipGenerator = nullptr;
+    Resources::TextureUploaderHandle TextureFactory::s_uploader = nullptr;
+    bool TextureFactory::s_streaming = false;
+
+    Resources::TextureHandle TextureFactory::CreateFromFile(const std::string &filePath)
+    {
+        const std::string key = std::filesystem::path(filePath).lexically_normal().generic_string();
+        return Resources::AssetRegistry::Get().GetTextures().Acquire(key, [&filePath] { return LoadFromFile(filePath); });
+    }
+
+    void TextureFactory::SetMipGenerator(const Resources::MipGeneratorHandle &mipGenerator)
+    {
+        s_mipGenerator = mipGenerator;
+    }
+
+    void TextureFactory::SetUploader(const Resources::TextureUploaderHandle &uploader)
+    {
+        s_uploader = uploader;
+    }
+
+    void TextureFactory::SetStreaming(const bool streaming)
+    {
+        s_streaming = streaming;
+    }
+
+    Resources::TextureHandle TextureFactory::LoadFromFile(const std::string &filePath)
+    {
+        auto device = Engine::Get().GetDeviceSmart();
+        auto texture = std::make_shared<Resources::Texture>(*device);
+        texture->SetTexturePath(filePath)
+                .SetMipGenerator(s_mipGenerator)
+                .SetUploader(s_uploader)
+                .UseStreaming(s_streaming);
+        if (!texture->Init() || !texture->Generate())
+        {
+            Logger::LogError("Failed to load texture from file: " + filePath);
+            return nullptr;
+        }
+        return texture;
+    }
+}
@@ -0,0 +1,40 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#pragma once
+
+#include "../resources/texture/texture.h"
+
+namespace GyroEngine::Factories
+{
+    class TextureFactory
+    {
+    public:
+        /// @note Textures are shared through the asset registry, every call for the same file returns the same texture
+        static Resources::TextureHandle CreateFromFile(const std::string& filePath);
+
+        /// @brief Generator filling the mip chain of loaded textures, without one the chain is blitted
+        /// @note Reset it before the device is destroyed
+        static void SetMipGenerator(const Resources::MipGeneratorHandle& mipGenerator);
+
+        /// @brief Uploader loaded textures are decoded and copied through, without one they load in CreateFromFile
+        /// @note The engine updates it every frame, a texture can be sampled once its GetUpload is ready
+        static void SetUploader(const Resources::TextureUploaderHandle& uploader);
+
+        [[nodiscard]] static Resources::TextureUploaderHandle GetUploader()
+        {
+            return s_uploader;
+        }
+
+        /// @brief Whether loaded textures stream their levels through TextureStreamer, off by default
+        /// @note Only textures drawn through a material get requests, others stay at their base levels
+        static void SetStreaming(bool streaming);
+    private:
+        static Resources::MipGeneratorHandle s_mipGenerator;
+        static Resources::TextureUploaderHandle s_uploader;
+        static bool s_streaming;
+
+        static Resources::TextureHandle LoadFromFile(const std::string& filePath);
+    };
+}
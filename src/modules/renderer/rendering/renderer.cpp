@@ -5,6 +5,7 @@
 #include "renderer.h"
 
 #include "context/rendering_device.h"
+#include "resources/pipeline/pipeline_bindings.h"
 
 namespace GyroEngine::Rendering
 {
@@ -23,6 +24,7 @@ namespace GyroEngine::Rendering
         if (!CreateSwapchainImages()) return false;
         if (!CreateImages()) return false;
         if (!CreateSampler()) return false;
+        if (!CreateUniformAllocator()) return false;
         if (!CreateCommandBuffers()) return false;
         if (!CreateSyncObjects()) return false;
         return true;
@@ -40,6 +42,7 @@ namespace GyroEngine::Rendering
         DestroySwapchainImages();
         DestroyImages();
         DestroySampler();
+        DestroyUniformAllocator();
         DestroyCommandBuffers();
         DestroySyncObjects();
     }
@@ -90,6 +93,9 @@ namespace GyroEngine::Rendering
 
     void Renderer::SubmitFrame()
     {
+        // Make this frame's per-object data visible to the GPU before submitting
+        m_uniformAllocator->Flush();
+        m_device.GetBindlessHeap().Flush();
         EndRecord();
         SubmitRender();
         PresentRender();
@@ -122,6 +128,13 @@ namespace GyroEngine::Rendering
 
         vkResetFences(m_device.GetLogicalDevice(), 1, &m_inFlightFences[m_currentFrame]);
 
+        // The GPU is done with this frame's uniform region, so it can be reused
+        m_uniformAllocator->Reset(m_currentFrame);
+        m_device.GetMemoryTracker().BeginFrame();
+        m_device.GetDefragmenter().Update();
+        m_device.GetBindlessHeap().BeginFrame(m_currentFrame);
+        Resources::PipelineBindings::BeginFrame();
+
         VkResult imageAcquireResult = vkAcquireNextImageKHR(
             m_device.GetLogicalDevice(),
             m_swapchain,
@@ -160,6 +173,9 @@ namespace GyroEngine::Rendering
             return false;
         }
 
+        // Bound once up front, bindless pipelines share it as set 0 for the rest of the frame
+        m_device.GetBindlessHeap().Bind(commandBuffer);
+
         if (m_viewport.width > 0 && m_viewport.height > 0)
         {
             VkViewport viewport{};
@@ -351,19 +367,25 @@ namespace GyroEngine::Rendering
                         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
                         VK_IMAGE_USAGE_SAMPLED_BIT)
                     .SetExtent({m_swapchainExtent.width, m_swapchainExtent.height, 1})
-                    .SetFormat(m_swapchainImageFormat);
+                    .SetFormat(m_swapchainImageFormat)
+                    .SetCategory(Device::MemoryCategory::RenderTargets)
+                    .SetDebugName("Color target " + std::to_string(i));
 
             depthImage->SetAspectMask(VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)
                     .SetUsage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
                     .SetExtent({m_swapchainExtent.width, m_swapchainExtent.height, 1})
-                    .SetFormat(m_device.GetPreferredDepthFormat());
+                    .SetFormat(m_device.GetPreferredDepthFormat())
+                    .SetCategory(Device::MemoryCategory::RenderTargets)
+                    .SetDebugName("Depth target " + std::to_string(i));
 
             pipelineImage->SetAspectMask(VK_IMAGE_ASPECT_COLOR_BIT)
                     .SetUsage(
                         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
                         VK_IMAGE_USAGE_SAMPLED_BIT)
                     .SetExtent({m_swapchainExtent.width, m_swapchainExtent.height, 1})
-                    .SetFormat(m_swapchainImageFormat);
+                    .SetFormat(m_swapchainImageFormat)
+                    .SetCategory(Device::MemoryCategory::RenderTargets)
+                    .SetDebugName("Pipeline target " + std::to_string(i));
 
             if (!colorImage->Init(VK_NULL_HANDLE, VK_NULL_HANDLE))
             {
@@ -390,22 +412,37 @@ namespace GyroEngine::Rendering
 
     bool Renderer::CreateSampler()
     {
-        auto *sampler = new Resources::Sampler(m_device);
-        sampler->SetMagFilter(VK_FILTER_LINEAR)
-                .SetMinFilter(VK_FILTER_LINEAR)
-                .SetAddressModeU(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetAddressModeV(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetAddressModeW(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetAnisotropyLevel(1.0f)
-                .SetAnisotropy(false);
-        if (!sampler->Init())
+        Resources::SamplerState state;
+        state.magFilter = VK_FILTER_LINEAR;
+        state.minFilter = VK_FILTER_LINEAR;
+        state.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.anisotropyLevel = 1.0f;
+        state.anisotropyEnable = VK_FALSE;
+        m_sampler = m_device.GetSamplerCache().Acquire(state);
+        if (!m_sampler)
         {
             Logger::LogError("Failed to create sampler");
-            delete sampler;
-            m_sampler = nullptr;
             return false;
         }
-        m_sampler = sampler;
+        return true;
+    }
+
+    bool Renderer::CreateUniformAllocator()
+    {
+        auto *uniformAllocator = new Resources::UniformAllocator(m_device);
+        // Storage usage lets bindless shaders read per-object data through the heap instead of a dynamic uniform
+        uniformAllocator->SetUsage(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            .SetDeviceAddress(m_device.SupportsBufferDeviceAddress());
+        if (!uniformAllocator->Init())
+        {
+            Logger::LogError("Failed to create uniform allocator");
+            delete uniformAllocator;
+            m_uniformAllocator = nullptr;
+            return false;
+        }
+        m_uniformAllocator = uniformAllocator;
         return true;
     }
 
@@ -506,11 +543,16 @@ namespace GyroEngine::Rendering
 
     void Renderer::DestroySampler()
     {
-        if (m_sampler)
+        m_sampler.reset();
+    }
+
+    void Renderer::DestroyUniformAllocator()
+    {
+        if (m_uniformAllocator)
         {
-            m_sampler->Cleanup();
-            delete m_sampler;
-            m_sampler = nullptr;
+            m_uniformAllocator->Cleanup();
+            delete m_uniformAllocator;
+            m_uniformAllocator = nullptr;
         }
     }
 
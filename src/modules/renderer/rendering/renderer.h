@@ -11,6 +11,7 @@
 #include "../../platform/window.h"
 #include "../resources/texture/image.h"
 #include "../resources/texture/sampler.h"
+#include "../resources/buffer/uniform_allocator.h"
 
 namespace GyroEngine::Device
 {
@@ -31,6 +32,7 @@ namespace GyroEngine::Rendering
     VkExtent2D swapchainExtent;
 
     Resources::Sampler* sampler;
+    Resources::UniformAllocator* uniformAllocator;
 
     Resources::Image* colorImage;
     Resources::Image* depthImage;
@@ -75,7 +77,8 @@ public:
         m_frameContext.colorImage = m_colorImages[m_currentFrame];
         m_frameContext.depthImage = m_depthImages[m_currentFrame];
         m_frameContext.pipelineImages = m_pipelineImages;
-        m_frameContext.sampler = m_sampler;
+        m_frameContext.sampler = m_sampler.get();
+        m_frameContext.uniformAllocator = m_uniformAllocator;
         return m_frameContext;
     }
 
@@ -101,7 +104,8 @@ private:
     std::vector<Resources::Image*> m_depthImages = {};
     std::vector<Resources::Image*> m_pipelineImages = {};
 
-    Resources::Sampler* m_sampler = nullptr;
+    Resources::SamplerHandle m_sampler;
+    Resources::UniformAllocator* m_uniformAllocator = nullptr;
 
     std::vector<VkSemaphore> m_imageAvailableSemaphores = {};
     std::vector<VkSemaphore> m_renderFinishedSemaphores = {};
@@ -124,6 +128,7 @@ private:
     bool CreateSwapchainImages();
     bool CreateImages();
     bool CreateSampler();
+    bool CreateUniformAllocator();
     bool CreateCommandBuffers();
     bool CreateSyncObjects();
 
@@ -131,6 +136,7 @@ private:
     void DestroySyncObjects();
     void DestroySwapchainImages();
     void DestroySampler();
+    void DestroyUniformAllocator();
     void DestroyImages();
     void DestroySwapchain();
 };
@@ -0,0 +1,25 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#include "asset_registry.h"
+
+namespace GyroEngine::Resources
+{
+    void AssetRegistry::Collect()
+    {
+        const size_t evicted = m_meshes.Collect(m_gracePeriod) + m_textures.Collect(m_gracePeriod) +
+                               m_shaders.Collect(m_gracePeriod);
+        if (evicted > 0)
+        {
+            Logger::Log("Evicted {} unused assets", evicted);
+        }
+    }
+
+    void AssetRegistry::Clear()
+    {
+        m_meshes.Clear();
+        m_textures.Clear();
+        m_shaders.Clear();
+    }
+}
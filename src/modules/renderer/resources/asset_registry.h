@@ -0,0 +1,222 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "object/mesh_geometry.h"
+#include "pipeline/shader.h"
+#include "texture/texture.h"
+#include "singleton.h"
+
+namespace GyroEngine::Resources
+{
+    /// @brief Assets of one type shared by key, so loading the same asset twice returns the resident one
+    /// @note Entries keep their asset alive until Collect finds nobody else has held it for the grace period
+    template <typename T>
+    class AssetCache
+    {
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            /// @brief Ready once the asset finished loading, holds nullptr when loading failed
+            std::shared_future<std::shared_ptr<T>> asset;
+            /// @brief When Collect first saw the registry holding the only reference
+            std::optional<Clock::time_point> unusedSince;
+        };
+    public:
+        /// @brief Returns the asset cached under key, creating it when there is none
+        /// @note Safe to call from any thread. Concurrent requests for a key that is still loading wait for that load
+        /// instead of starting another one. Failed loads aren't cached, the next request tries again
+        std::shared_ptr<T> Acquire(const std::string& key, const std::function<std::shared_ptr<T>()>& create)
+        {
+            std::promise<std::shared_ptr<T>> promise;
+            std::shared_future<std::shared_ptr<T>> asset;
+            bool creating = false;
+            {
+                std::lock_guard lock(m_mutex);
+                auto it = m_entries.find(key);
+                if (it == m_entries.end())
+                {
+                    asset = promise.get_future().share();
+                    m_entries.emplace(key, Entry{asset, std::nullopt});
+                    creating = true;
+                }
+                else
+                {
+                    asset = it->second.asset;
+                    it->second.unusedSince.reset();
+                }
+            }
+
+            if (!creating)
+            {
+                return asset.get();
+            }
+
+            // Created outside the lock, loads of other keys carry on meanwhile
+            std::shared_ptr<T> created;
+            try
+            {
+                created = create();
+            }
+            catch (...)
+            {
+                created = nullptr;
+            }
+            promise.set_value(created);
+
+            if (!created)
+            {
+                std::lock_guard lock(m_mutex);
+                m_entries.erase(key);
+            }
+            return created;
+        }
+
+        /// @brief Returns the asset cached under key without creating it, nullptr when it isn't resident
+        std::shared_ptr<T> Find(const std::string& key)
+        {
+            std::lock_guard lock(m_mutex);
+            const auto it = m_entries.find(key);
+            if (it == m_entries.end() || !IsReady(it->second))
+            {
+                return nullptr;
+            }
+            it->second.unusedSince.reset();
+            return it->second.asset.get();
+        }
+
+        /// @brief References to the asset held outside the cache, i.e. by its users
+        /// @note Equals use_count for assets the cache doesn't hold, e.g. a copy made from a cached one
+        [[nodiscard]] long GetUserCount(const std::shared_ptr<T>& asset)
+        {
+            if (!asset)
+            {
+                return 0;
+            }
+            std::lock_guard lock(m_mutex);
+            for (const auto& [key, entry] : m_entries)
+            {
+                if (IsReady(entry) && entry.asset.get() == asset)
+                {
+                    return asset.use_count() - 1;
+                }
+            }
+            return asset.use_count();
+        }
+
+        /// @brief Evicts assets nobody but the cache held for at least gracePeriod
+        /// @return Number of evicted assets
+        size_t Collect(const Clock::duration gracePeriod)
+        {
+            const auto now = Clock::now();
+            size_t evicted = 0;
+
+            std::lock_guard lock(m_mutex);
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                Entry& entry = it->second;
+                if (!IsReady(entry))
+                {
+                    ++it;
+                    continue;
+                }
+
+                // The shared state of the future is the cache's own reference
+                if (entry.asset.get().use_count() > 1)
+                {
+                    entry.unusedSince.reset();
+                    ++it;
+                    continue;
+                }
+
+                if (!entry.unusedSince)
+                {
+                    entry.unusedSince = now;
+                }
+                if (now - *entry.unusedSince < gracePeriod)
+                {
+                    ++it;
+                    continue;
+                }
+
+                it = m_entries.erase(it);
+                ++evicted;
+            }
+            return evicted;
+        }
+
+        /// @brief Drops every reference the cache holds, assets still in use stay alive with their users
+        void Clear()
+        {
+            std::lock_guard lock(m_mutex);
+            m_entries.clear();
+        }
+
+        [[nodiscard]] size_t GetCount()
+        {
+            std::lock_guard lock(m_mutex);
+            return m_entries.size();
+        }
+    private:
+        std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+
+        static bool IsReady(const Entry& entry)
+        {
+            return entry.asset.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+    };
+
+    /// @brief Shared mesh geometry, textures and shaders, keyed by source path and creation parameters
+    /// @note Only geometry is shared for meshes, every placed Mesh keeps its own transform, material and pipeline
+    class AssetRegistry : public Utils::ISingleton<AssetRegistry>
+    {
+        friend class ISingleton;
+    public:
+        /// @brief How long an asset stays resident after its last user released it
+        /// @note Also covers frames in flight still reading the asset's GPU resources, keep it well above a frame
+        void SetGracePeriod(const std::chrono::milliseconds gracePeriod)
+        {
+            m_gracePeriod = gracePeriod;
+        }
+
+        [[nodiscard]] AssetCache<MeshGeometry>& GetMeshes()
+        {
+            return m_meshes;
+        }
+
+        [[nodiscard]] AssetCache<Texture>& GetTextures()
+        {
+            return m_textures;
+        }
+
+        [[nodiscard]] AssetCache<Shader>& GetShaders()
+        {
+            return m_shaders;
+        }
+
+        /// @brief Evicts assets whose grace period ran out, called once a frame by the engine
+        void Collect();
+        /// @brief Drops every cached asset, has to run before the rendering device is destroyed
+        void Clear();
+    private:
+        AssetRegistry() = default;
+
+        std::chrono::milliseconds m_gracePeriod{5000};
+        AssetCache<MeshGeometry> m_meshes;
+        AssetCache<Texture> m_textures;
+        AssetCache<Shader> m_shaders;
+    };
+}
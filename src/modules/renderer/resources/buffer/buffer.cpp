@@ -4,6 +4,8 @@
 
 #include "buffer.h"
 
+#include <cstring>
+
 #include "context/rendering_device.h"
 #include "rendering/renderer.h"
 
@@ -15,6 +17,18 @@ namespace GyroEngine::Resources
     return *this;
 }
 
+Buffer& Buffer::SetIndexType(const VkIndexType indexType)
+{
+    m_indexType = indexType;
+    return *this;
+}
+
+Buffer& Buffer::SetVertexBinding(const uint32_t binding)
+{
+    m_vertexBinding = binding;
+    return *this;
+}
+
 Buffer& Buffer::SetSize(VkDeviceSize size)
 {
     m_size = size;
@@ -39,6 +53,36 @@ Buffer& Buffer::SetSharingMode(VkSharingMode sharingMode)
     return *this;
 }
 
+Buffer& Buffer::SetPersistentMapping(const bool persistent)
+{
+    m_persistentMapping = persistent;
+    return *this;
+}
+
+Buffer& Buffer::SetHostAccess(const bool hostAccess)
+{
+    m_hostAccess = hostAccess;
+    return *this;
+}
+
+Buffer& Buffer::SetDeviceAddress(const bool enable)
+{
+    m_useDeviceAddress = enable;
+    return *this;
+}
+
+Buffer& Buffer::SetCategory(const Device::MemoryCategory category)
+{
+    m_category = category;
+    return *this;
+}
+
+Buffer& Buffer::SetDebugName(const std::string& name)
+{
+    m_debugName = name;
+    return *this;
+}
+
 bool Buffer::Init()
 {
     if (!CreateBuffer())
@@ -60,11 +104,11 @@ void Buffer::Bind(const Rendering::FrameContext& frameContext) const
     case BufferType::Vertex:
         {
             constexpr VkDeviceSize offsets[] = {0};
-            vkCmdBindVertexBuffers(frameContext.cmd, 0, 1, &m_buffer, offsets);
+            vkCmdBindVertexBuffers(frameContext.cmd, m_vertexBinding, 1, &m_buffer, offsets);
         }
         break;
     case BufferType::Index:
-        vkCmdBindIndexBuffer(frameContext.cmd, m_buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(frameContext.cmd, m_buffer, 0, m_indexType);
         break;
     default:
         break;
@@ -73,19 +117,156 @@ void Buffer::Bind(const Rendering::FrameContext& frameContext) const
 
 void Buffer::Map(const void* data) const
 {
-    if (m_allocation != VK_NULL_HANDLE)
+    Write(0, data, m_size);
+    Flush(0, m_size);
+}
+
+void Buffer::Write(const VkDeviceSize offset, const void* data, const VkDeviceSize size) const
+{
+    if (m_allocation == VK_NULL_HANDLE || size == 0)
     {
-        void* mappedData;
-        if (vmaMapMemory(m_device.GetAllocator(), m_allocation, &mappedData) == VK_SUCCESS)
-        {
-            std::memcpy(mappedData, data, m_size);
-            vmaUnmapMemory(m_device.GetAllocator(), m_allocation);
-        }
-        else
-        {
-            Logger::LogError("Failed to map buffer memory");
-        }
+        return;
+    }
+    if (offset + size > m_size)
+    {
+        Logger::LogError("Buffer write of {} bytes at offset {} exceeds buffer size {}", size, offset, m_size);
+        return;
+    }
+    if (!HasHostAccess())
+    {
+        Logger::LogError("Buffer {} was created without host access, it has to be filled through a staging copy",
+                         m_debugName);
+        return;
+    }
+
+    // Persistently mapped buffers are written directly, without going through the driver
+    if (m_mappedData)
+    {
+        std::memcpy(static_cast<uint8_t*>(m_mappedData) + offset, data, size);
+        return;
+    }
+
+    void* mappedData;
+    if (vmaMapMemory(m_device.GetAllocator(), m_allocation, &mappedData) == VK_SUCCESS)
+    {
+        std::memcpy(static_cast<uint8_t*>(mappedData) + offset, data, size);
+        vmaUnmapMemory(m_device.GetAllocator(), m_allocation);
+    }
+    else
+    {
+        Logger::LogError("Failed to map buffer memory");
+    }
+}
+
+void Buffer::Flush(const VkDeviceSize offset, const VkDeviceSize size) const
+{
+    if (m_allocation == VK_NULL_HANDLE || m_isCoherent)
+    {
+        return;
+    }
+    if (vmaFlushAllocation(m_device.GetAllocator(), m_allocation, offset, size) != VK_SUCCESS)
+    {
+        Logger::LogError("Failed to flush buffer memory");
+    }
+}
+
+uint32_t Buffer::RegisterBindless()
+{
+    if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+    {
+        return m_bindlessIndex;
     }
+    if (m_buffer == VK_NULL_HANDLE || !(m_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+    {
+        Logger::LogError("Only initialized storage buffers can be registered in the bindless heap");
+        return Device::BindlessHeap::InvalidIndex;
+    }
+    m_bindlessIndex = m_device.GetBindlessHeap().RegisterBuffer(m_buffer, 0, m_size);
+    return m_bindlessIndex;
+}
+
+bool Buffer::CanRelocate() const
+{
+    // Mapped memory would move under the host pointer, and storage buffers may be written by the GPU mid-copy
+    // Device addresses may be stored in other GPU data, which can't be patched when the buffer moves
+    if (m_buffer == VK_NULL_HANDLE || m_mappedData || m_sharingMode != VK_SHARING_MODE_EXCLUSIVE ||
+        (m_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) || m_deviceAddress != 0)
+    {
+        return false;
+    }
+
+    // Host writes through Write or Map between the copy and the commit would land in the old allocation and be lost,
+    // buffers without host access are only written by the GPU through copies
+    return !HasHostAccess();
+}
+
+bool Buffer::RecordRelocation(VkCommandBuffer cmd, VmaAllocation dstAllocation)
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_size;
+    bufferInfo.usage = GetCreateUsage();
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_device.GetLogicalDevice(), &bufferInfo, nullptr, &m_pendingBuffer) != VK_SUCCESS)
+    {
+        m_pendingBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+    if (vmaBindBufferMemory(m_device.GetAllocator(), dstAllocation, m_pendingBuffer) != VK_SUCCESS)
+    {
+        AbortRelocation();
+        return false;
+    }
+
+    VkBufferCopy region = {};
+    region.size = m_size;
+    vkCmdCopyBuffer(cmd, m_buffer, m_pendingBuffer, 1, &region);
+    return true;
+}
+
+std::function<void()> Buffer::CommitRelocation()
+{
+    VkBuffer oldBuffer = m_buffer;
+    m_buffer = m_pendingBuffer;
+    m_pendingBuffer = VK_NULL_HANDLE;
+    m_device.GetBindlessHeap().UpdateBuffer(m_bindlessIndex, m_buffer, 0, m_size);
+
+    VkDevice device = m_device.GetLogicalDevice();
+    return [device, oldBuffer]
+    {
+        vkDestroyBuffer(device, oldBuffer, nullptr);
+    };
+}
+
+void Buffer::AbortRelocation()
+{
+    if (m_pendingBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_device.GetLogicalDevice(), m_pendingBuffer, nullptr);
+        m_pendingBuffer = VK_NULL_HANDLE;
+    }
+}
+
+VkBufferUsageFlags Buffer::GetCreateUsage() const
+{
+    VkBufferUsageFlags usage = m_usage;
+    if (m_useDeviceAddress && m_device.SupportsBufferDeviceAddress())
+    {
+        usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    }
+
+    // Buffers that may be defragmented need to be both the source and the destination of a copy
+    if (m_persistentMapping)
+    {
+        return usage;
+    }
+    return usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+}
+
+bool Buffer::HasHostAccess() const
+{
+    return m_hostAccess || m_persistentMapping || m_memoryUsage == VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
 }
 
 bool Buffer::CreateBuffer()
@@ -93,7 +274,7 @@ bool Buffer::CreateBuffer()
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = m_size;
-    bufferInfo.usage = m_usage;
+    bufferInfo.usage = GetCreateUsage();
     bufferInfo.sharingMode = m_sharingMode;
 
     // Only set queue family indices if using concurrent sharing mode
@@ -116,14 +297,41 @@ bool Buffer::CreateBuffer()
 
     VmaAllocationCreateInfo vmaInfo = {};
     vmaInfo.usage = m_memoryUsage;
-    vmaInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+    // Not dedicated, dedicated allocations can't be defragmented and waste a whole block on small meshes
+    // Host access flags make VMA pick host visible memory, so only buffers the host writes ask for them
+    vmaInfo.flags = HasHostAccess() ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT : 0;
+    if (m_persistentMapping)
+    {
+        vmaInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
 
-    if (vmaCreateBuffer(m_device.GetAllocator(), &bufferInfo, &vmaInfo, &m_buffer, &m_allocation, nullptr) !=
+    VmaAllocationInfo allocationInfo = {};
+    if (vmaCreateBuffer(m_device.GetAllocator(), &bufferInfo, &vmaInfo, &m_buffer, &m_allocation, &allocationInfo) !=
         VK_SUCCESS)
     {
         Logger::LogError("Failed to create buffer");
         return false;
     }
+
+    VkMemoryPropertyFlags memoryFlags = 0;
+    vmaGetAllocationMemoryProperties(m_device.GetAllocator(), m_allocation, &memoryFlags);
+    m_isCoherent = (memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    m_mappedData = m_persistentMapping ? allocationInfo.pMappedData : nullptr;
+
+    if (GetCreateUsage() & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+    {
+        VkBufferDeviceAddressInfo addressInfo = {};
+        addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+        addressInfo.buffer = m_buffer;
+        m_deviceAddress = vkGetBufferDeviceAddress(m_device.GetLogicalDevice(), &addressInfo);
+    }
+    else if (m_useDeviceAddress)
+    {
+        Logger::LogWarning("Buffer {} requested a device address, but the device doesn't support them", m_debugName);
+    }
+
+    m_device.GetMemoryTracker().Track(m_allocation, m_category, m_debugName);
+    vmaSetAllocationUserData(m_device.GetAllocator(), m_allocation, static_cast<Device::DefragmentationTarget*>(this));
     return true;
 }
 
@@ -131,9 +339,25 @@ void Buffer::DestroyBuffer()
 {
     if (m_buffer != VK_NULL_HANDLE && m_allocation != VK_NULL_HANDLE)
     {
-        vmaDestroyBuffer(m_device.GetAllocator(), m_buffer, m_allocation);
+        if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+        {
+            m_device.GetBindlessHeap().ReleaseBuffer(m_bindlessIndex);
+            m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+        }
+        m_device.GetMemoryTracker().Untrack(m_allocation);
+        if (m_device.GetDefragmenter().Release(m_allocation))
+        {
+            // Mid-move, the defragmenter frees the allocation when its pass ends
+            vkDestroyBuffer(m_device.GetLogicalDevice(), m_buffer, nullptr);
+        }
+        else
+        {
+            vmaDestroyBuffer(m_device.GetAllocator(), m_buffer, m_allocation);
+        }
         m_buffer = VK_NULL_HANDLE;
         m_allocation = VK_NULL_HANDLE;
+        m_mappedData = nullptr;
+        m_deviceAddress = 0;
     }
 }
 }
@@ -5,8 +5,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <volk.h>
 #include "implementation/vma_implementation.h"
+#include "context/memory_tracker.h"
+#include "context/defragmenter.h"
+#include "context/bindless_heap.h"
 
 namespace GyroEngine::Device
 {
@@ -23,7 +28,7 @@ using namespace GyroEngine;
 
 namespace GyroEngine::Resources
 {
-    class Buffer  {
+    class Buffer : public Device::DefragmentationTarget {
     public:
         enum class BufferType
         {
@@ -36,18 +41,80 @@ namespace GyroEngine::Resources
         ~Buffer() { Cleanup(); }
 
         Buffer& SetBufferType(const BufferType& bufferType);
+        /// @brief Width of the indices of an index buffer, 32-bit by default
+        Buffer& SetIndexType(VkIndexType indexType);
+        /// @brief Binding a vertex buffer is bound to, 0 by default
+        Buffer& SetVertexBinding(uint32_t binding);
         Buffer& SetSize(VkDeviceSize size);
         Buffer& SetUsage(VkBufferUsageFlags usage);
         Buffer& SetMemoryUsage(VmaMemoryUsage memoryUsage);
         Buffer& SetSharingMode(VkSharingMode sharingMode);
+        Buffer& SetPersistentMapping(bool persistent = true);
+        /// @brief Lets the host write the buffer through Write and Map, implied by persistent mapping and by
+        /// VMA_MEMORY_USAGE_AUTO_PREFER_HOST
+        /// @note Without it the buffer is device local, filled through a staging copy, and can be defragmented
+        Buffer& SetHostAccess(bool hostAccess = true);
+        /// @brief Creates the buffer with a device address shaders can dereference, e.g. received through push constants
+        /// @note Ignored with a warning when the device doesn't support buffer device addresses
+        Buffer& SetDeviceAddress(bool enable = true);
+        Buffer& SetCategory(Device::MemoryCategory category);
+        /// @brief Owner name shown in the memory statistics and VMA dumps
+        Buffer& SetDebugName(const std::string& name);
 
         bool Init();
         void Cleanup();
 
         void Bind(const Rendering::FrameContext& frameContext) const;
 
+        /// @brief Copies m_size bytes from data into the buffer and flushes the whole range
         void Map(const void* data) const;
 
+        /// @brief Copies size bytes from data into the buffer at offset
+        /// @note Does not flush, call Flush() on the written range when the memory is not coherent
+        void Write(VkDeviceSize offset, const void* data, VkDeviceSize size) const;
+
+        template <typename T>
+        void Write(const VkDeviceSize offset, const std::vector<T>& data) const
+        {
+            Write(offset, data.data(), sizeof(T) * data.size());
+        }
+
+        /// @brief Makes host writes in the range visible to the device, no-op for coherent memory
+        void Flush(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
+        /// @brief Typed pointer into the persistent mapping, nullptr if the buffer isn't persistently mapped
+        template <typename T>
+        [[nodiscard]] T* View(const VkDeviceSize offset = 0) const
+        {
+            if (!m_mappedData || offset + sizeof(T) > m_size)
+            {
+                return nullptr;
+            }
+            return reinterpret_cast<T*>(static_cast<uint8_t*>(m_mappedData) + offset);
+        }
+
+        [[nodiscard]] bool IsMapped() const {
+            return m_mappedData != nullptr;
+        }
+
+        [[nodiscard]] bool IsCoherent() const {
+            return m_isCoherent;
+        }
+
+        /// @brief Exposes the whole buffer to shaders through the bindless heap, requires storage buffer usage
+        /// @return Index into the heap's storage buffer array, stays valid until the buffer is destroyed
+        uint32_t RegisterBindless();
+
+        [[nodiscard]] uint32_t GetBindlessIndex() const {
+            return m_bindlessIndex;
+        }
+
+        [[nodiscard]] bool CanRelocate() const override;
+        bool RecordRelocation(VkCommandBuffer cmd, VmaAllocation dstAllocation) override;
+        std::function<void()> CommitRelocation() override;
+        void AbortRelocation() override;
+
+        /// @note May change when the defragmenter moves the buffer, don't cache it across frames
         [[nodiscard]] VkBuffer GetBuffer() const {
             return m_buffer;
         }
@@ -55,16 +122,36 @@ namespace GyroEngine::Resources
         [[nodiscard]] VkDeviceSize GetSize() const {
             return m_size;
         }
+
+        /// @return 0 when the buffer wasn't created with SetDeviceAddress
+        [[nodiscard]] VkDeviceAddress GetDeviceAddress(const VkDeviceSize offset = 0) const {
+            return m_deviceAddress != 0 ? m_deviceAddress + offset : 0;
+        }
     private:
         Device::RenderingDevice& m_device;
 
         VkBuffer m_buffer = VK_NULL_HANDLE;
+        VkBuffer m_pendingBuffer = VK_NULL_HANDLE;
         VmaAllocation m_allocation = VK_NULL_HANDLE;
         VkDeviceSize m_size = 0;
         VkBufferUsageFlags m_usage = 0;
         VmaMemoryUsage m_memoryUsage = VMA_MEMORY_USAGE_AUTO;
         VkSharingMode m_sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         BufferType m_bufferType = BufferType::Uniform;
+        VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+        uint32_t m_vertexBinding = 0;
+        Device::MemoryCategory m_category = Device::MemoryCategory::Unknown;
+        std::string m_debugName;
+        bool m_persistentMapping = false;
+        bool m_hostAccess = false;
+        bool m_useDeviceAddress = false;
+        VkDeviceAddress m_deviceAddress = 0;
+        bool m_isCoherent = false;
+        void* m_mappedData = nullptr;
+        uint32_t m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+
+        [[nodiscard]] VkBufferUsageFlags GetCreateUsage() const;
+        [[nodiscard]] bool HasHostAccess() const;
 
         bool CreateBuffer();
         void DestroyBuffer();
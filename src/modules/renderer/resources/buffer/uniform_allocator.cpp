@@ -0,0 +1,131 @@
+//
+// Created by lepag on 7/14/2025.
+//
+
+#include "uniform_allocator.h"
+
+#include <algorithm>
+#include <string>
+
+#include "context/rendering_device.h"
+
+namespace GyroEngine::Resources
+{
+    UniformAllocator& UniformAllocator::SetCapacity(const VkDeviceSize capacity)
+    {
+        m_capacity = capacity;
+        return *this;
+    }
+
+    UniformAllocator& UniformAllocator::SetUsage(const VkBufferUsageFlags usage)
+    {
+        m_usage = usage;
+        return *this;
+    }
+
+    UniformAllocator& UniformAllocator::SetDeviceAddress(const bool enable)
+    {
+        m_useDeviceAddress = enable;
+        return *this;
+    }
+
+    bool UniformAllocator::Init()
+    {
+        if (!m_buffers.empty())
+        {
+            return false;
+        }
+
+        // Every allocation must be usable as a dynamic offset, so align to the strictest limit we could be bound as
+        const auto limits = m_device.GetPhysicalDeviceProperties().limits;
+        m_alignment = 1;
+        if (m_usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+        {
+            m_alignment = std::max(m_alignment, limits.minUniformBufferOffsetAlignment);
+        }
+        if (m_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        {
+            // Bindless shaders index the buffer as an array of vec4s
+            m_alignment = std::max({m_alignment, limits.minStorageBufferOffsetAlignment, VkDeviceSize{16}});
+        }
+
+        for (uint32_t i = 0; i < m_device.GetMaxFramesInFlight(); ++i)
+        {
+            auto buffer = std::make_shared<Buffer>(m_device);
+            buffer->SetUsage(m_usage)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+                .SetBufferType(Buffer::BufferType::Uniform)
+                .SetPersistentMapping(true)
+                .SetDeviceAddress(m_useDeviceAddress)
+                .SetCategory(Device::MemoryCategory::Uniforms)
+                .SetDebugName("Uniform allocator frame " + std::to_string(i))
+                .SetSize(m_capacity);
+            if (!buffer->Init() || !buffer->IsMapped())
+            {
+                Logger::LogError("Failed to create uniform allocator buffer for frame {}", i);
+                Cleanup();
+                return false;
+            }
+            if (m_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            {
+                buffer->RegisterBindless();
+            }
+            m_buffers.push_back(buffer);
+        }
+        return true;
+    }
+
+    void UniformAllocator::Cleanup()
+    {
+        for (auto& buffer : m_buffers)
+        {
+            buffer->Cleanup();
+        }
+        m_buffers.clear();
+        m_head = 0;
+    }
+
+    void UniformAllocator::Reset(const uint32_t frameIndex)
+    {
+        m_frameIndex = frameIndex;
+        m_head = 0;
+        m_overflowed = false;
+    }
+
+    UniformAllocator::Allocation UniformAllocator::Allocate(const VkDeviceSize size)
+    {
+        if (m_buffers.empty())
+        {
+            return {};
+        }
+
+        const VkDeviceSize offset = (m_head + m_alignment - 1) & ~(m_alignment - 1);
+        if (offset + size > m_capacity)
+        {
+            // Only report once per frame, the rest of the frame would flood the log otherwise
+            if (!m_overflowed)
+            {
+                Logger::LogError("Uniform allocator out of space ({} of {} bytes used)", m_head, m_capacity);
+                m_overflowed = true;
+            }
+            return {};
+        }
+        m_head = offset + size;
+
+        Allocation allocation;
+        allocation.offset = static_cast<uint32_t>(offset);
+        allocation.size = size;
+        allocation.data = GetBuffer(m_frameIndex)->View<uint8_t>(offset);
+        allocation.address = GetBuffer(m_frameIndex)->GetDeviceAddress(offset);
+        return allocation;
+    }
+
+    void UniformAllocator::Flush() const
+    {
+        if (m_buffers.empty() || m_head == 0)
+        {
+            return;
+        }
+        GetBuffer(m_frameIndex)->Flush(0, m_head);
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Created by lepag on 7/14/2025.
+//
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include <volk.h>
+
+#include "buffer.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Resources
+{
+    /// @brief Linear allocator for per-object shader data, backed by one persistently mapped buffer per frame in flight
+    /// @note Allocations are only valid for the frame they were made in, the frame's region is reused once its fence signals
+    class UniformAllocator
+    {
+    public:
+        struct Allocation
+        {
+            uint32_t offset = 0;
+            VkDeviceSize size = 0;
+            void* data = nullptr;
+            /// @brief Device address of the allocation, 0 unless the allocator was created with SetDeviceAddress
+            VkDeviceAddress address = 0;
+
+            [[nodiscard]] bool IsValid() const
+            {
+                return data != nullptr;
+            }
+        };
+
+        explicit UniformAllocator(Device::RenderingDevice& device): m_device(device) {}
+        ~UniformAllocator() { Cleanup(); }
+
+        UniformAllocator& SetCapacity(VkDeviceSize capacity);
+        UniformAllocator& SetUsage(VkBufferUsageFlags usage);
+        /// @brief Gives every allocation a device address, so shaders can reach per-draw data through a pointer
+        UniformAllocator& SetDeviceAddress(bool enable = true);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Starts allocating from the region owned by frameIndex, discarding its previous contents
+        void Reset(uint32_t frameIndex);
+
+        /// @brief Reserves size bytes in the current frame's buffer, aligned for use as a dynamic offset
+        Allocation Allocate(VkDeviceSize size);
+
+        template <typename T>
+        Allocation Push(const T& data)
+        {
+            Allocation allocation = Allocate(sizeof(T));
+            if (allocation.IsValid())
+            {
+                std::memcpy(allocation.data, &data, sizeof(T));
+            }
+            return allocation;
+        }
+
+        /// @brief Flushes everything written to the current frame's buffer since the last reset
+        void Flush() const;
+
+        [[nodiscard]] BufferHandle GetBuffer(const uint32_t frameIndex) const
+        {
+            return m_buffers[frameIndex % m_buffers.size()];
+        }
+
+        /// @brief Index of the frame's buffer in the bindless heap, only valid when created with storage buffer usage
+        [[nodiscard]] uint32_t GetBindlessIndex(const uint32_t frameIndex) const
+        {
+            return m_buffers[frameIndex % m_buffers.size()]->GetBindlessIndex();
+        }
+
+        [[nodiscard]] VkDeviceSize GetCapacity() const
+        {
+            return m_capacity;
+        }
+
+        [[nodiscard]] VkDeviceSize GetUsed() const
+        {
+            return m_head;
+        }
+
+        [[nodiscard]] VkDeviceSize GetAlignment() const
+        {
+            return m_alignment;
+        }
+    private:
+        Device::RenderingDevice& m_device;
+
+        std::vector<BufferHandle> m_buffers;
+        VkDeviceSize m_capacity = 4 * 1024 * 1024;
+        VkDeviceSize m_alignment = 256;
+        VkDeviceSize m_head = 0;
+        VkBufferUsageFlags m_usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        uint32_t m_frameIndex = 0;
+        bool m_overflowed = false;
+        bool m_useDeviceAddress = false;
+    };
+
+    using UniformAllocatorHandle = std::shared_ptr<UniformAllocator>;
+}
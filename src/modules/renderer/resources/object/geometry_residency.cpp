@@ -0,0 +1,98 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#include "geometry_residency.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "debug/logger.h"
+#include "mesh_geometry.h"
+
+namespace GyroEngine::Resources
+{
+    void GeometryResidency::Register(MeshGeometry* geometry)
+    {
+        std::lock_guard lock(m_mutex);
+        m_geometries.insert(geometry);
+    }
+
+    void GeometryResidency::Unregister(MeshGeometry* geometry)
+    {
+        std::lock_guard lock(m_mutex);
+        m_geometries.erase(geometry);
+    }
+
+    void GeometryResidency::Touch(MeshGeometry& geometry) const
+    {
+        geometry.SetLastUsedFrame(m_frame);
+    }
+
+    void GeometryResidency::Trim(const uint32_t framesInFlight)
+    {
+        std::lock_guard lock(m_mutex);
+        const uint64_t frame = m_frame++;
+        if (m_budget == 0)
+        {
+            return;
+        }
+
+        VkDeviceSize residentSize = 0;
+        std::vector<MeshGeometry*> candidates;
+        for (MeshGeometry* geometry : m_geometries)
+        {
+            residentSize += geometry->GetGpuSize();
+            if (geometry->CanEvict() && geometry->GetLastUsedFrame() + framesInFlight < frame)
+            {
+                candidates.push_back(geometry);
+            }
+        }
+        if (residentSize <= m_budget)
+        {
+            m_overBudget = false;
+            return;
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const MeshGeometry* a, const MeshGeometry* b)
+        {
+            return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+        });
+
+        size_t evicted = 0;
+        for (MeshGeometry* geometry : candidates)
+        {
+            if (residentSize <= m_budget)
+            {
+                break;
+            }
+            residentSize -= geometry->GetGpuSize();
+            geometry->ReleaseGpuData();
+            m_geometries.erase(geometry);
+            ++evicted;
+        }
+
+        // Warned once per overrun, it lasts as long as the meshes stay in use
+        if (residentSize > m_budget && !m_overBudget)
+        {
+            m_overBudget = true;
+            Logger::LogWarning("Geometry uses {} bytes over its budget of {} bytes, all of it is in use",
+                               residentSize - m_budget, m_budget);
+        }
+        else if (evicted > 0)
+        {
+            Logger::Log("Evicted {} meshes to stay within the geometry budget", evicted);
+        }
+    }
+
+    VkDeviceSize GeometryResidency::GetResidentSize()
+    {
+        std::lock_guard lock(m_mutex);
+        VkDeviceSize residentSize = 0;
+        for (const MeshGeometry* geometry : m_geometries)
+        {
+            residentSize += geometry->GetGpuSize();
+        }
+        return residentSize;
+    }
+}
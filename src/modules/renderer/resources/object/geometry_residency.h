@@ -0,0 +1,61 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+#include <volk.h>
+
+#include "singleton.h"
+
+namespace GyroEngine::Resources
+{
+    class MeshGeometry;
+
+    /// @brief Keeps the GPU buffers of generated mesh geometry under a memory budget
+    /// @note Geometry no mesh drew for a while is evicted least recently used first once the budget is exceeded, and
+    /// streams back in from its source the next time a mesh using it is updated
+    class GeometryResidency : public Utils::ISingleton<GeometryResidency>
+    {
+        friend class ISingleton;
+    public:
+        /// @brief Bytes of vertex, index and meshlet buffers allowed to stay resident, 0 for no limit
+        void SetBudget(const VkDeviceSize budget)
+        {
+            m_budget = budget;
+        }
+
+        /// @brief Called by geometry as its buffers are created and destroyed
+        void Register(MeshGeometry* geometry);
+        void Unregister(MeshGeometry* geometry);
+
+        /// @brief Marks the geometry as used by the current frame
+        void Touch(MeshGeometry& geometry) const;
+
+        /// @brief Evicts least recently used geometry until the budget holds, then moves on to the next frame
+        /// @param framesInFlight Geometry used this recently may still be read by the GPU and are never evicted
+        void Trim(uint32_t framesInFlight);
+
+        [[nodiscard]] VkDeviceSize GetResidentSize();
+
+        [[nodiscard]] VkDeviceSize GetBudget() const
+        {
+            return m_budget;
+        }
+
+        [[nodiscard]] uint64_t GetFrame() const
+        {
+            return m_frame;
+        }
+    private:
+        GeometryResidency() = default;
+
+        std::mutex m_mutex;
+        std::unordered_set<MeshGeometry*> m_geometries;
+        VkDeviceSize m_budget = 1024ull * 1024ull * 1024ull;
+        uint64_t m_frame = 0;
+        bool m_overBudget = false;
+    };
+}
@@ -4,6 +4,142 @@
 
 #include "material.h"
 
+#include "context/rendering_device.h"
+#include "../texture/texture_streamer.h"
+
 namespace GyroEngine::Resources
 {
+    Material& Material::SetPipeline(const PipelineHandle& pipeline)
+    {
+        m_pipeline = pipeline.get();
+        return *this;
+    }
+
+    Material& Material::SetBaseColor(const glm::vec4& baseColor)
+    {
+        m_data.baseColor = baseColor;
+        m_dirty = true;
+        return *this;
+    }
+
+    Material& Material::SetAlbedo(const TextureHandle& texture)
+    {
+        m_albedo = texture;
+        m_dirty = true;
+        return *this;
+    }
+
+    Material& Material::SetNormal(const TextureHandle& texture)
+    {
+        m_normal = texture;
+        m_dirty = true;
+        return *this;
+    }
+
+    Material& Material::SetMetallic(const TextureHandle& texture)
+    {
+        m_metallic = texture;
+        m_dirty = true;
+        return *this;
+    }
+
+    Material& Material::SetRoughness(const TextureHandle& texture)
+    {
+        m_roughness = texture;
+        m_dirty = true;
+        return *this;
+    }
+
+    Material& Material::SetAO(const TextureHandle& texture)
+    {
+        m_ao = texture;
+        m_dirty = true;
+        return *this;
+    }
+
+    bool Material::Init()
+    {
+        m_dataBuffer = std::make_unique<Buffer>(m_device);
+        m_dataBuffer->SetUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+            .SetPersistentMapping(true)
+            .SetDeviceAddress(m_device.SupportsBufferDeviceAddress())
+            .SetCategory(Device::MemoryCategory::Uniforms)
+            .SetDebugName("Material")
+            .SetSize(sizeof(MaterialData));
+        if (!m_dataBuffer->Init())
+        {
+            Logger::LogError("Failed to create material data buffer");
+            m_dataBuffer.reset();
+            return false;
+        }
+        if (m_dataBuffer->RegisterBindless() == Device::BindlessHeap::InvalidIndex)
+        {
+            Logger::LogError("Failed to register material in the bindless heap");
+            m_dataBuffer.reset();
+            return false;
+        }
+
+        m_dirty = true;
+        Update();
+        return true;
+    }
+
+    void Material::Cleanup()
+    {
+        m_dataBuffer.reset();
+    }
+
+    void Material::Update()
+    {
+        if (!m_dirty || !m_dataBuffer)
+        {
+            return;
+        }
+
+        m_data.albedo = GetTextureIndex(m_albedo);
+        m_data.normal = GetTextureIndex(m_normal);
+        m_data.metallic = GetTextureIndex(m_metallic);
+        m_data.roughness = GetTextureIndex(m_roughness);
+        m_data.ao = GetTextureIndex(m_ao);
+
+        // All material textures are sampled the same way, so the albedo's sampler stands in for the others
+        const TextureHandle& samplerSource = m_albedo ? m_albedo : m_normal;
+        m_data.sampler = samplerSource && samplerSource->GetSampler()
+                             ? samplerSource->GetSampler()->GetBindlessIndex()
+                             : Device::BindlessHeap::InvalidIndex;
+
+        // Written in place, frames still in flight may read a mix of old and new values for one frame
+        m_dataBuffer->Map(&m_data);
+
+        // Textures still uploading are filled in once they're ready
+        m_dirty = false;
+        for (const TextureHandle* texture : {&m_albedo, &m_normal, &m_metallic, &m_roughness, &m_ao})
+        {
+            if (*texture && (*texture)->IsUploading())
+            {
+                m_dirty = true;
+            }
+        }
+    }
+
+    void Material::RequestDetail(const float screenSize) const
+    {
+        for (const TextureHandle* texture : {&m_albedo, &m_normal, &m_metallic, &m_roughness, &m_ao})
+        {
+            if (*texture && (*texture)->IsStreamed())
+            {
+                TextureStreamer::Get().Request(**texture, screenSize);
+            }
+        }
+    }
+
+    uint32_t Material::GetTextureIndex(const TextureHandle& texture)
+    {
+        if (!texture || !texture->IsReady())
+        {
+            return Device::BindlessHeap::InvalidIndex;
+        }
+        return texture->GetImage()->GetBindlessIndex();
+    }
 }
@@ -3,20 +3,94 @@
 //
 
 #pragma once
+
+#include <glm/glm.hpp>
+
+#include "../buffer/buffer.h"
 #include "../pipeline/pipeline.h"
 #include "../texture/texture.h"
 
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
 namespace GyroEngine::Resources
 {
+    /// @brief GPU layout of a material, mirrors MaterialData in the bindless shaders
+    /// @note Texture fields are bindless image indices, UINT32_MAX when the material has no such texture
+    struct MaterialData
+    {
+        glm::vec4 baseColor{1.0f};
+        uint32_t albedo = UINT32_MAX;
+        uint32_t normal = UINT32_MAX;
+        uint32_t metallic = UINT32_MAX;
+        uint32_t roughness = UINT32_MAX;
+        uint32_t ao = UINT32_MAX;
+        uint32_t sampler = UINT32_MAX;
+        uint32_t padding[2] = {};
+    };
+
+    /// @brief Textures and parameters of a surface, exposed to bindless shaders as a storage buffer in the heap
     class Material
     {
+    public:
+        explicit Material(Device::RenderingDevice& device): m_device(device) {}
+        ~Material() { Cleanup(); }
+
+        Material& SetPipeline(const PipelineHandle& pipeline);
+        Material& SetBaseColor(const glm::vec4& baseColor);
+        Material& SetAlbedo(const TextureHandle& texture);
+        Material& SetNormal(const TextureHandle& texture);
+        Material& SetMetallic(const TextureHandle& texture);
+        Material& SetRoughness(const TextureHandle& texture);
+        Material& SetAO(const TextureHandle& texture);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Rewrites the material's data after a setter changed it
+        void Update();
+
+        /// @brief Asks the streamer for enough texture detail to cover screenSize pixels this frame
+        void RequestDetail(float screenSize) const;
+
+        [[nodiscard]] Pipeline* GetPipeline() const
+        {
+            return m_pipeline;
+        }
+
+        [[nodiscard]] const MaterialData& GetData() const
+        {
+            return m_data;
+        }
+
+        /// @brief Index of the material's data buffer in the bindless heap
+        [[nodiscard]] uint32_t GetBindlessIndex() const
+        {
+            return m_dataBuffer ? m_dataBuffer->GetBindlessIndex() : Device::BindlessHeap::InvalidIndex;
+        }
+
+        /// @brief Address of the material's data, 0 when the device doesn't support buffer device addresses
+        [[nodiscard]] VkDeviceAddress GetDeviceAddress() const
+        {
+            return m_dataBuffer ? m_dataBuffer->GetDeviceAddress() : 0;
+        }
     private:
-        Pipeline* m_pipeline;
+        Device::RenderingDevice& m_device;
+
+        Pipeline* m_pipeline = nullptr;
         TextureHandle m_albedo;
         TextureHandle m_normal;
         TextureHandle m_metallic;
         TextureHandle m_roughness;
         TextureHandle m_ao;
+
+        MaterialData m_data;
+        std::unique_ptr<Buffer> m_dataBuffer;
+        bool m_dirty = true;
+
+        static uint32_t GetTextureIndex(const TextureHandle& texture);
     };
 
     using MaterialHandle = std::shared_ptr<Material>;
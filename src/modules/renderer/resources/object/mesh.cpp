@@ -4,21 +4,37 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+
 #include "debug/logger.h"
+#include "geometry_residency.h"
 #include "rendering/renderer.h"
+#include "resources/asset_registry.h"
 
 
 namespace GyroEngine::Resources
 {
     Mesh & Mesh::UseVertices(const std::vector<Types::Vertex> &vertices)
     {
-        m_vertices = vertices;
+        m_geometry->UseVertices(vertices);
+        return *this;
+    }
+
+    Mesh & Mesh::UseVertices(std::vector<Types::Vertex> &&vertices)
+    {
+        m_geometry->UseVertices(std::move(vertices));
         return *this;
     }
 
     Mesh & Mesh::UseIndices(const std::vector<uint32_t> &indices)
     {
-        m_indices = indices;
+        m_geometry->UseIndices(indices);
+        return *this;
+    }
+
+    Mesh & Mesh::UseIndices(std::vector<uint32_t> &&indices)
+    {
+        m_geometry->UseIndices(std::move(indices));
         return *this;
     }
 
@@ -29,26 +45,101 @@ namespace GyroEngine::Resources
         return *this;
     }
 
+    Mesh & Mesh::UseMaterial(const MaterialHandle &material)
+    {
+        m_material = material;
+        return *this;
+    }
+
+    Mesh & Mesh::UseLods(const std::vector<Types::MeshLod> &lods)
+    {
+        m_geometry->UseLods(lods);
+        m_currentLod = 0;
+        return *this;
+    }
+
+    Mesh & Mesh::SetLodThreshold(const float pixels)
+    {
+        m_lodThreshold = pixels;
+        return *this;
+    }
+
+    Mesh & Mesh::SetLodHysteresis(const float hysteresis)
+    {
+        m_lodHysteresis = hysteresis;
+        return *this;
+    }
+
+    Mesh & Mesh::UseMeshlets(const std::vector<Types::Meshlet> &meshlets)
+    {
+        m_geometry->UseMeshlets(meshlets);
+        return *this;
+    }
+
+    Mesh & Mesh::UseVertexFormat(const Types::VertexFormat format)
+    {
+        m_pulledVertexFormat = format;
+        return *this;
+    }
+
+    Mesh & Mesh::SetSource(const Source &source)
+    {
+        m_geometry->SetSource(source);
+        return *this;
+    }
+
+    Mesh & Mesh::KeepCpuData(const bool keep)
+    {
+        m_geometry->KeepCpuData(keep);
+        return *this;
+    }
+
+    Mesh & Mesh::UseSubmeshes(const std::vector<Types::Submesh> &submeshes)
+    {
+        m_geometry->UseSubmeshes(submeshes);
+        return *this;
+    }
+
+    Mesh & Mesh::SetName(const std::string &name)
+    {
+        m_geometry->SetName(name);
+        return *this;
+    }
+
     bool Mesh::Generate()
     {
-        if (m_isBuilt)
+        const Types::VertexFormat format = GetPipelineVertexFormat();
+        const bool pullVertices = UsesVertexPulling();
+        // Meshes sharing the geometry keep reading it in the format it was built in, the registry's own reference
+        // doesn't count as one
+        if (m_geometry->IsResident() && !m_geometry->IsBuiltAs(format, pullVertices) &&
+            AssetRegistry::Get().GetMeshes().GetUserCount(m_geometry) > 1)
         {
-            return RegenerateObject();
+            m_geometry = m_geometry->Clone();
         }
-        if (!CreateBuffers()) return false;
-        FillBuffers();
-        m_isBuilt = true;
-        return true;
+        if (!m_geometry->Generate(format, pullVertices)) return false;
+        if (m_currentLod >= m_geometry->GetLods().size())
+        {
+            m_currentLod = 0;
+        }
+        m_pipelineDirty = false;
+        return CreateDrawBuffers();
     }
 
     void Mesh::Destroy()
     {
-        if (!m_isBuilt)
+        m_drawBuffers.clear();
+        m_culled = false;
+        // Shared geometry goes with its last user
+        if (m_geometry && AssetRegistry::Get().GetMeshes().GetUserCount(m_geometry) == 1)
         {
-            return;
+            m_geometry->Destroy();
         }
-        DestroyBuffers();
-        m_isBuilt = false;
+    }
+
+    void Mesh::Evict()
+    {
+        m_geometry->Evict();
     }
 
     void Mesh::SetTransforms(const glm::mat4 &view, const glm::mat4 &proj)
@@ -57,104 +148,299 @@ namespace GyroEngine::Resources
         m_mvp.projection = proj;
     }
 
-    void Mesh::Update(const uint32_t frameIndex)
+    void Mesh::Update(const Rendering::FrameContext& frame)
     {
-        m_mvp.model = m_transform.ToMatrix();
-        m_mvpBuffer->Map(&m_mvp);
+        if (m_geometry->IsEvicted() && !Generate())
+        {
+            Logger::LogError("Failed to stream mesh {} back in", m_geometry->GetName());
+            return;
+        }
+        GeometryResidency::Get().Touch(*m_geometry);
+
+        m_mvp.model = m_transform.ToMatrix() * m_geometry->GetDequantization();
+        SelectLod(frame);
+        m_culled = false;
+
+        const auto allocation = frame.uniformAllocator->Push(m_mvp);
+        if (!allocation.IsValid())
+        {
+            return;
+        }
 
         auto pipelineBindings = m_pipeline->GetPipelineBindings();
-        if (pipelineBindings->DoesBindingExist("mvp"))
+        if (pipelineBindings->IsBindless())
+        {
+            // Bindless shaders read the MVP straight out of the allocator's buffer, no descriptor has to change
+            m_drawConstants.objectBuffer = frame.uniformAllocator->GetBindlessIndex(frame.frameIndex);
+            m_drawConstants.objectOffset = allocation.offset / 16;
+            m_drawConstants.materialBuffer = Device::BindlessHeap::InvalidIndex;
+            if (m_material)
+            {
+                // Streamed textures get the detail the mesh covers on screen
+                m_material->RequestDetail(2.0f * m_geometry->GetBoundsRadius() * GetMaxScale() * GetPixelsPerUnit(frame));
+                m_material->Update();
+                m_drawConstants.materialBuffer = m_material->GetBindlessIndex();
+            }
+            m_drawConstants.materialIndex = 0;
+            if (m_geometry->IsPullingVertices())
+            {
+                const Buffer* attributeBuffer = m_geometry->GetAttributeBuffer();
+                m_drawConstants.vertexBuffer = m_geometry->GetVertexBuffer()->GetBindlessIndex();
+                m_drawConstants.attributeBuffer = attributeBuffer ? attributeBuffer->GetBindlessIndex()
+                                                                  : Device::BindlessHeap::InvalidIndex;
+                m_drawConstants.vertexFormat = static_cast<uint32_t>(m_geometry->GetVertexFormat());
+                m_drawConstants.baseVertex = 0;
+            }
+            return;
+        }
+        // The bindings always create the MVP as a dynamic buffer, a binding of another kind isn't written per object
+        if (!pipelineBindings->IsDynamicBinding(PipelineBindings::ObjectBinding))
         {
-            pipelineBindings->UpdateDescriptorBuffer("mvp", m_mvpBuffer, frameIndex);
+            return;
         }
+
+        // The descriptor always points at the start of the frame's buffer, so only the first object writes it and
+        // objects only differ by dynamic offset
+        const auto buffer = frame.uniformAllocator->GetBuffer(frame.frameIndex);
+        pipelineBindings->UpdateDescriptorBuffer(PipelineBindings::ObjectBinding, buffer, frame.frameIndex, 0,
+                                                 sizeof(Types::MVP));
+        m_mvpOffset = allocation.offset;
+    }
+
+    void Mesh::Cull(const Rendering::FrameContext& frame, const MeshletCuller& culler, const MeshletCullData& cullData)
+    {
+        m_culled = false;
+        const Buffer* meshletBuffer = m_geometry->GetMeshletBuffer();
+        if (!meshletBuffer || m_drawBuffers.empty() || m_currentLod != 0 || !culler.IsValid())
+        {
+            return;
+        }
+
+        // Meshlet bounds are in object space, before quantization
+        MeshletCullData data = cullData;
+        const glm::vec3 scale = glm::abs(m_transform.scale);
+        data.model = m_transform.ToMatrix();
+        data.camera.w = std::max({scale.x, scale.y, scale.z});
+
+        const auto allocation = frame.uniformAllocator->Push(data);
+        if (!allocation.IsValid())
+        {
+            return;
+        }
+
+        MeshletCullConstants constants;
+        constants.meshletBuffer = meshletBuffer->GetBindlessIndex();
+        constants.drawBuffer = m_drawBuffers[frame.frameIndex]->GetBindlessIndex();
+        constants.cullBuffer = frame.uniformAllocator->GetBindlessIndex(frame.frameIndex);
+        constants.cullOffset = allocation.offset / 16;
+        constants.meshletCount = static_cast<uint32_t>(m_geometry->GetMeshlets().size());
+        culler.Dispatch(frame, constants);
+
+        m_culled = true;
+        m_cullFrame = frame.frameIndex;
     }
 
     void Mesh::Bind(const Rendering::FrameContext& frame) const
     {
-        m_pipeline->Bind(frame);
-        m_indexBuffer->Bind(frame);
-        m_vertexBuffer->Bind(frame);
-        m_mvpBuffer->Bind(frame);
+        if (!m_geometry->IsResident())
+        {
+            return;
+        }
 
         auto pipelineBindings = m_pipeline->GetPipelineBindings();
-        pipelineBindings->Bind(frame, m_pipeline->GetPipelineLayout());
+        if (pipelineBindings->IsDynamicBinding(PipelineBindings::ObjectBinding))
+        {
+            pipelineBindings->SetDynamicOffset(PipelineBindings::ObjectBinding, m_mvpOffset);
+        }
+
+        // Binds the pipeline along with its descriptor sets
+        m_pipeline->Bind(frame);
+        if (pipelineBindings->IsBindless())
+        {
+            vkCmdPushConstants(frame.cmd, m_pipeline->GetPipelineLayout(), VK_SHADER_STAGE_ALL, 0,
+                               sizeof(DrawConstants), &m_drawConstants);
+        }
+        m_geometry->GetIndexBuffer()->Bind(frame);
+        if (m_geometry->IsPullingVertices())
+        {
+            // The vertex shader reads the streams through the heap
+            return;
+        }
+        m_geometry->GetVertexBuffer()->Bind(frame);
+        if (const Buffer* attributeBuffer = m_geometry->GetAttributeBuffer())
+        {
+            // Pipelines reading positions only have no binding 1, binding it anyway is harmless
+            attributeBuffer->Bind(frame);
+        }
     }
 
     void Mesh::Draw(const Rendering::FrameContext &frame) const
     {
-        vkCmdDrawIndexed(frame.cmd, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
+        if (!m_geometry->IsResident())
+        {
+            return;
+        }
+
+        if (m_culled && m_cullFrame == frame.frameIndex)
+        {
+            // Culled meshlets were written with no instances, so every meshlet can be issued
+            VkBuffer drawBuffer = m_drawBuffers[frame.frameIndex]->GetBuffer();
+            const auto meshletCount = static_cast<uint32_t>(m_geometry->GetMeshlets().size());
+            constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+            if (m_device.SupportsMultiDrawIndirect())
+            {
+                vkCmdDrawIndexedIndirect(frame.cmd, drawBuffer, 0, meshletCount, stride);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < meshletCount; ++i)
+                {
+                    vkCmdDrawIndexedIndirect(frame.cmd, drawBuffer, static_cast<VkDeviceSize>(i) * stride, 1, stride);
+                }
+            }
+            return;
+        }
+
+        const auto& lods = m_geometry->GetLods();
+        if (lods.empty())
+        {
+            vkCmdDrawIndexed(frame.cmd, m_geometry->GetIndexCount(), 1, 0, 0, 0);
+            return;
+        }
+
+        const auto& lod = lods[m_currentLod];
+        vkCmdDrawIndexed(frame.cmd, lod.indexCount, 1, lod.indexOffset, 0, 0);
     }
 
-    bool Mesh::CreateBuffers()
+    void Mesh::DrawSubmesh(const Rendering::FrameContext &frame, const size_t index) const
     {
-        // Create vertex buffer
-        m_vertexBuffer = std::make_unique<Buffer>(m_device);
-        m_vertexBuffer->SetUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
-            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
-            .SetBufferType(Buffer::BufferType::Vertex)
-            .SetSize(sizeof(Types::Vertex) * m_vertices.size());
-        if (!m_vertexBuffer->Init())
+        if (!m_geometry->IsResident())
         {
-            Logger::LogError("Failed to create vertex buffer");
-            return false;
+            return;
         }
+        const auto& submeshes = m_geometry->GetSubmeshes();
+        if (index >= submeshes.size())
+        {
+            Logger::LogError("Submesh {} is out of range for mesh {}", index, m_geometry->GetName());
+            return;
+        }
+
+        // Submesh indices already point into the shared vertex buffer
+        const auto& submesh = submeshes[index];
+        vkCmdDrawIndexed(frame.cmd, submesh.indexCount, 1, submesh.firstIndex, 0, 0);
+    }
 
-        // Create index buffer
-        m_indexBuffer = std::make_unique<Buffer>(m_device);
-        m_indexBuffer->SetUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
-            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
-            .SetBufferType(Buffer::BufferType::Index)
-            .SetSize(sizeof(uint32_t) * m_indices.size());
-        if (!m_indexBuffer->Init())
+    bool Mesh::CreateDrawBuffers()
+    {
+        const size_t meshletCount = m_geometry->GetMeshlets().size();
+        const VkDeviceSize size = sizeof(VkDrawIndexedIndirectCommand) * meshletCount;
+        if (meshletCount == 0 || !m_geometry->GetMeshletBuffer())
         {
-            Logger::LogError("Failed to create index buffer");
-            return false;
+            m_drawBuffers.clear();
+            return true;
+        }
+        if (!m_drawBuffers.empty() && m_drawBuffers.front()->GetSize() == size)
+        {
+            return true;
         }
 
-        // Create MVP buffer (Model-View-Projection)
-        m_mvpBuffer = std::make_shared<Buffer>(m_device);
-        m_mvpBuffer->SetUsage(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
-            .SetBufferType(Buffer::BufferType::Uniform)
-            .SetSize(sizeof(Types::MVP));
-        if (!m_mvpBuffer->Init())
+        // Written by the cull shader every frame, so each frame in flight needs its own
+        if (!m_drawBuffers.empty())
+        {
+            m_device.WaitForIdle();
+            m_drawBuffers.clear();
+        }
+        for (uint32_t i = 0; i < m_device.GetMaxFramesInFlight(); ++i)
         {
-            Logger::LogError("Failed to create MVP buffer");
-            return false;
+            auto drawBuffer = std::make_unique<Buffer>(m_device);
+            drawBuffer->SetUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+                .SetCategory(Device::MemoryCategory::Geometry)
+                .SetDebugName(m_geometry->GetName() + " meshlet draws")
+                .SetSize(size);
+            if (!drawBuffer->Init() || drawBuffer->RegisterBindless() == Device::BindlessHeap::InvalidIndex)
+            {
+                Logger::LogError("Failed to create meshlet draw buffer");
+                m_drawBuffers.clear();
+                return false;
+            }
+            m_drawBuffers.push_back(std::move(drawBuffer));
         }
         return true;
     }
 
-    void Mesh::DestroyBuffers()
+    VkDeviceSize Mesh::GetGpuSize() const
     {
-        if (m_vertexBuffer)
+        VkDeviceSize size = m_geometry->GetGpuSize();
+        for (const auto& drawBuffer : m_drawBuffers)
         {
-            m_vertexBuffer->Cleanup();
-            m_vertexBuffer.reset();
+            size += drawBuffer->GetSize();
         }
+        return size;
+    }
 
-        if (m_indexBuffer)
+    Types::VertexFormat Mesh::GetPipelineVertexFormat() const
+    {
+        if (!m_pipeline || !m_pipeline->GetPipelineBindings())
         {
-            m_indexBuffer->Cleanup();
-            m_indexBuffer.reset();
+            return Types::VertexFormat::Full;
         }
+        if (m_pipeline->GetPipelineBindings()->UsesVertexPulling())
+        {
+            return m_pulledVertexFormat;
+        }
+        return m_pipeline->GetPipelineBindings()->GetVertexFormat();
+    }
 
-        if (m_mvpBuffer)
+    bool Mesh::UsesVertexPulling() const
+    {
+        return m_pipeline && m_pipeline->GetPipelineBindings() &&
+               m_pipeline->GetPipelineBindings()->UsesVertexPulling();
+    }
+
+    void Mesh::SelectLod(const Rendering::FrameContext& frame)
+    {
+        const auto& lods = m_geometry->GetLods();
+        if (lods.size() <= 1)
         {
-            m_mvpBuffer->Cleanup();
-            m_mvpBuffer.reset();
+            m_currentLod = 0;
+            return;
+        }
+
+        // Object space errors grow with the largest axis of the scale
+        const float maxScale = GetMaxScale();
+        const float pixelsPerUnit = GetPixelsPerUnit(frame);
+
+        // Coarsest level whose error stays under the threshold, moving coarser needs the error to drop further
+        uint32_t target = 0;
+        for (auto i = static_cast<uint32_t>(lods.size() - 1); i > 0; --i)
+        {
+            const float limit = i > m_currentLod ? m_lodThreshold * (1.0f - m_lodHysteresis) : m_lodThreshold;
+            if (lods[i].error * maxScale * pixelsPerUnit <= limit)
+            {
+                target = i;
+                break;
+            }
         }
+        m_currentLod = target;
     }
 
-    void Mesh::FillBuffers() const
+    float Mesh::GetMaxScale() const
     {
-        m_vertexBuffer->Map(m_vertices.data());
-        m_indexBuffer->Map(m_indices.data());
+        const glm::vec3 scale = glm::abs(m_transform.scale);
+        return std::max({scale.x, scale.y, scale.z});
     }
 
-    bool Mesh::RegenerateObject()
+    float Mesh::GetPixelsPerUnit(const Rendering::FrameContext& frame) const
     {
-        FillBuffers();
-        return true;
+        // Distance to the nearest point of the bounds, so large meshes switch from their closest edge
+        const glm::vec3 viewCenter = glm::vec3(m_mvp.view * m_transform.ToMatrix() *
+                                               glm::vec4(m_geometry->GetBoundsCenter(), 1.0f));
+        const float distance = std::max(glm::length(viewCenter) - m_geometry->GetBoundsRadius() * GetMaxScale(),
+                                        0.001f);
+
+        // Pixels one object space unit covers at that distance
+        return std::abs(m_mvp.projection[1][1]) * 0.5f * static_cast<float>(frame.swapchainExtent.height) / distance;
     }
+
 }
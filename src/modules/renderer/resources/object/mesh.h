@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include <functional>
+
 #include "../buffer/buffer.h"
 #include "../pipeline/pipeline.h"
+#include "../pipeline/push_constant.h"
+#include "material.h"
+#include "mesh_geometry.h"
+#include "meshlet_culler.h"
 #include "types.h"
 
 namespace GyroEngine::Device
@@ -16,29 +22,76 @@ namespace GyroEngine::Device
 namespace GyroEngine::Resources
 {
 
+    /// @brief Placement of geometry in the scene, with the material, pipeline and level of detail it's drawn with
+    /// @note Meshes can share one MeshGeometry, e.g. every mesh the factory loads from the same file
     class Mesh
     {
     public:
-        explicit Mesh(Device::RenderingDevice& device): m_device(device) {}
+        using Source = MeshGeometry::Source;
+
+        /// @brief Mesh with geometry of its own
+        explicit Mesh(Device::RenderingDevice& device): Mesh(device, std::make_shared<MeshGeometry>(device)) {}
+        /// @brief Mesh placing geometry other meshes may share
+        Mesh(Device::RenderingDevice& device, MeshGeometryHandle geometry): m_device(device),
+                                                                            m_geometry(std::move(geometry)) {}
         ~Mesh() { Destroy(); }
 
+        /// @note The geometry setters change the geometry for every mesh sharing it
         Mesh& UseVertices(const std::vector<Types::Vertex>& vertices);
+        Mesh& UseVertices(std::vector<Types::Vertex>&& vertices);
         Mesh& UseIndices(const std::vector<uint32_t>& indices);
+        Mesh& UseIndices(std::vector<uint32_t>&& indices);
         Mesh& UsePipeline(const std::shared_ptr<Pipeline>& pipeline);
+        /// @brief Material bindless pipelines read through the draw constants
+        Mesh& UseMaterial(const MaterialHandle& material);
+        /// @brief Name the geometry's buffers are reported under in the memory statistics
+        Mesh& SetName(const std::string& name);
+        /// @brief Index ranges of the geometry's levels of detail, the first one being full detail
+        /// @note Without levels the whole index list is drawn
+        Mesh& UseLods(const std::vector<Types::MeshLod>& lods);
+        /// @brief Screen-space error in pixels a level of detail may show before a finer one is picked
+        Mesh& SetLodThreshold(float pixels);
+        /// @brief Fraction the error has to drop below the threshold before a coarser level is picked
+        /// @note Keeps meshes near a switching distance from flickering between levels
+        Mesh& SetLodHysteresis(float hysteresis);
+        /// @brief Clusters of the full detail level, each drawing its own range of the index buffer
+        /// @note Enables per-meshlet culling through Cull, the indices have to be in meshlet order
+        Mesh& UseMeshlets(const std::vector<Types::Meshlet>& meshlets);
+        /// @brief Per material ranges of the full detail level, drawn one at a time through DrawSubmesh
+        Mesh& UseSubmeshes(const std::vector<Types::Submesh>& submeshes);
+        /// @brief Format the vertices are stored in when the pipeline pulls them, Full by default
+        /// @note Other pipelines dictate the format through their vertex inputs
+        Mesh& UseVertexFormat(Types::VertexFormat format);
+        /// @brief Where the geometry can be streamed back from after it was released, see MeshGeometry::SetSource
+        Mesh& SetSource(const Source& source);
+        /// @brief Keeps the CPU copies after upload even when the geometry has a source, e.g. for physics or picking
+        Mesh& KeepCpuData(bool keep = true);
         Mesh& UseObjectMap(const Types::ObjectMap& objectMap)
         {
-            m_vertices = objectMap.vertices;
-            m_indices = objectMap.indices;
+            m_geometry->UseObjectMap(objectMap);
             return *this;
         }
 
+        /// @brief Creates the geometry's buffers in the vertex format of the mesh's pipeline, Full without a pipeline
+        /// @note Call again after switching to a pipeline with a different vertex format. Geometry shared in another
+        /// format is copied for this mesh rather than changed under the meshes sharing it
         bool Generate();
+        /// @brief Frees the mesh's own buffers, and the geometry's when no other mesh shares it
         void Destroy();
+        /// @brief Frees the geometry's GPU buffers but keeps everything needed to stream it back in, see SetSource
+        void Evict();
 
         void SetTransforms(const glm::mat4& view, const glm::mat4& proj);
-        void Update(uint32_t frameIndex);
+        /// @brief Streams this frame's MVP into the frame's uniform allocator and picks the level of detail
+        /// @note Streams evicted geometry back in first
+        void Update(const Rendering::FrameContext& frame);
+        /// @brief Records the culling of the geometry's meshlets, after Update and before rendering starts
+        /// @note Draw then only draws the meshlets that survived, skipped for coarser levels of detail
+        void Cull(const Rendering::FrameContext& frame, const MeshletCuller& culler, const MeshletCullData& cullData);
         void Bind(const Rendering::FrameContext& frame) const;
         void Draw(const Rendering::FrameContext& frame) const;
+        /// @brief Draws one submesh at full detail, e.g. after binding its material
+        void DrawSubmesh(const Rendering::FrameContext& frame, size_t index) const;
 
         [[nodiscard]] glm::vec3& GetPosition()
         {
@@ -57,30 +110,87 @@ namespace GyroEngine::Resources
         {
             return m_pipeline;
         }
+
+        [[nodiscard]] const MeshGeometryHandle& GetGeometry() const
+        {
+            return m_geometry;
+        }
+
+        [[nodiscard]] Types::VertexFormat GetVertexFormat() const
+        {
+            return m_geometry->GetVertexFormat();
+        }
+
+        [[nodiscard]] uint32_t GetCurrentLod() const
+        {
+            return m_currentLod;
+        }
+
+        [[nodiscard]] size_t GetMeshletCount() const
+        {
+            return m_geometry->GetMeshlets().size();
+        }
+
+        [[nodiscard]] const std::vector<Types::Submesh>& GetSubmeshes() const
+        {
+            return m_geometry->GetSubmeshes();
+        }
+
+        [[nodiscard]] size_t GetLodCount() const
+        {
+            return m_geometry->GetLods().size();
+        }
+
+        [[nodiscard]] bool IsResident() const
+        {
+            return m_geometry->IsResident();
+        }
+
+        /// @brief Whether the geometry can be evicted and streamed back in, i.e. it has a source
+        [[nodiscard]] bool CanEvict() const
+        {
+            return m_geometry->CanEvict();
+        }
+
+        /// @brief Bytes of GPU buffers the mesh uses, the geometry's included even when it's shared
+        [[nodiscard]] VkDeviceSize GetGpuSize() const;
+
+        /// @brief VK_INDEX_TYPE_UINT16 whenever every vertex can be addressed with 16 bits
+        [[nodiscard]] VkIndexType GetIndexType() const
+        {
+            return m_geometry->GetIndexType();
+        }
     private:
         Device::RenderingDevice& m_device;
 
+        MeshGeometryHandle m_geometry;
         Pipeline* m_pipeline = nullptr;
-        std::unique_ptr<Buffer> m_vertexBuffer;
-        std::unique_ptr<Buffer> m_indexBuffer;
-        BufferHandle m_mvpBuffer;
-
-        uint32_t m_indexCount = 0;
-        uint32_t m_vertexCount = 0;
-        std::vector<Types::Vertex> m_vertices;
-        std::vector<uint32_t> m_indices;
+        MaterialHandle m_material;
+        uint32_t m_mvpOffset = 0;
+        DrawConstants m_drawConstants;
+
+        Types::VertexFormat m_pulledVertexFormat = Types::VertexFormat::Full;
+        uint32_t m_currentLod = 0;
+        float m_lodThreshold = 1.0f;
+        float m_lodHysteresis = 0.25f;
+        /// @brief One indirect draw per meshlet, for each frame in flight
+        std::vector<std::unique_ptr<Buffer>> m_drawBuffers;
+        bool m_culled = false;
+        uint32_t m_cullFrame = 0;
         Types::Transform m_transform;
         Types::MVP m_mvp;
 
-        bool m_isBuilt = false;
         bool m_pipelineDirty = false;
 
-        bool CreateBuffers();
-        void DestroyBuffers();
-
-        void FillBuffers() const;
+        [[nodiscard]] Types::VertexFormat GetPipelineVertexFormat() const;
+        [[nodiscard]] bool UsesVertexPulling() const;
+        void SelectLod(const Rendering::FrameContext& frame);
+        [[nodiscard]] float GetMaxScale() const;
+        /// @brief Pixels one object space unit covers at the nearest point of the bounds
+        [[nodiscard]] float GetPixelsPerUnit(const Rendering::FrameContext& frame) const;
 
-        bool RegenerateObject();
+        /// @brief Written by the cull shader, so every mesh needs its own even when the geometry is shared
+        bool CreateDrawBuffers();
     };
 
     using MeshHandle = std::shared_ptr<Mesh>;
@@ -0,0 +1,493 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#include "mesh_geometry.h"
+
+#include "context/rendering_device.h"
+#include "debug/logger.h"
+#include "geometry_residency.h"
+#include "utilities/renderer.h"
+#include "utilities/vertex.h"
+
+namespace GyroEngine::Resources
+{
+    MeshGeometry & MeshGeometry::UseVertices(const std::vector<Types::Vertex> &vertices)
+    {
+        m_vertices = vertices;
+        m_dirty = true;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseVertices(std::vector<Types::Vertex> &&vertices)
+    {
+        m_vertices = std::move(vertices);
+        m_dirty = true;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseIndices(const std::vector<uint32_t> &indices)
+    {
+        m_indices = indices;
+        m_dirty = true;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseIndices(std::vector<uint32_t> &&indices)
+    {
+        m_indices = std::move(indices);
+        m_dirty = true;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::SetName(const std::string &name)
+    {
+        m_name = name;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseLods(const std::vector<Types::MeshLod> &lods)
+    {
+        m_lods = lods;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseMeshlets(const std::vector<Types::Meshlet> &meshlets)
+    {
+        m_meshlets = meshlets;
+        m_dirty = true;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::UseSubmeshes(const std::vector<Types::Submesh> &submeshes)
+    {
+        m_submeshes = submeshes;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::SetSource(const Source &source)
+    {
+        m_source = source;
+        return *this;
+    }
+
+    MeshGeometry & MeshGeometry::KeepCpuData(const bool keep)
+    {
+        m_keepCpuData = keep;
+        return *this;
+    }
+
+    bool MeshGeometry::Generate(const Types::VertexFormat format, const bool pullVertices)
+    {
+        if (!m_dirty && IsBuiltAs(format, pullVertices))
+        {
+            return true;
+        }
+        if (!LoadCpuData()) return false;
+        if (m_isBuilt)
+        {
+            if (!RegenerateObject(format, pullVertices)) return false;
+            m_dirty = false;
+            ReleaseCpuData();
+            return true;
+        }
+        EncodeVertices(format, pullVertices);
+        EncodeIndices();
+        ComputeBounds();
+        if (!CreateBuffers() || !FillBuffers()) return false;
+        m_isBuilt = true;
+        m_evicted = false;
+        m_dirty = false;
+
+        auto& residency = GeometryResidency::Get();
+        residency.Register(this);
+        residency.Touch(*this);
+        ReleaseCpuData();
+        return true;
+    }
+
+    void MeshGeometry::Destroy()
+    {
+        if (!m_isBuilt)
+        {
+            return;
+        }
+        GeometryResidency::Get().Unregister(this);
+        DestroyBuffers();
+        m_isBuilt = false;
+    }
+
+    void MeshGeometry::Evict()
+    {
+        if (!m_isBuilt)
+        {
+            return;
+        }
+        GeometryResidency::Get().Unregister(this);
+        ReleaseGpuData();
+    }
+
+    std::shared_ptr<MeshGeometry> MeshGeometry::Clone() const
+    {
+        // Released CPU copies come back from the shared source when the clone is generated
+        auto clone = std::make_shared<MeshGeometry>(m_device);
+        clone->m_name = m_name;
+        clone->m_vertices = m_vertices;
+        clone->m_indices = m_indices;
+        clone->m_lods = m_lods;
+        clone->m_meshlets = m_meshlets;
+        clone->m_submeshes = m_submeshes;
+        clone->m_source = m_source;
+        clone->m_keepCpuData = m_keepCpuData;
+        return clone;
+    }
+
+    void MeshGeometry::ReleaseGpuData()
+    {
+        DestroyBuffers();
+        m_isBuilt = false;
+        m_evicted = true;
+    }
+
+    bool MeshGeometry::CreateBuffers()
+    {
+        // Pulling pipelines read the vertex streams as storage buffers
+        VkBufferUsageFlags vertexUsage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        if (m_pullVertices)
+        {
+            vertexUsage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        }
+
+        // Create vertex buffer
+        m_vertexBuffer = std::make_unique<Buffer>(m_device);
+        m_vertexBuffer->SetUsage(vertexUsage)
+            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+            .SetBufferType(Buffer::BufferType::Vertex)
+            .SetCategory(Device::MemoryCategory::Geometry)
+            .SetDebugName(m_name + " vertices")
+            .SetSize(static_cast<VkDeviceSize>(Utils::Vertex::GetStride(m_vertexFormat)) * m_vertices.size());
+        if (!m_vertexBuffer->Init() ||
+            (m_pullVertices && m_vertexBuffer->RegisterBindless() == Device::BindlessHeap::InvalidIndex))
+        {
+            Logger::LogError("Failed to create vertex buffer");
+            return false;
+        }
+
+        // Split vertices keep everything but the positions in a second stream, bound to binding 1
+        if (m_vertexFormat == Types::VertexFormat::Split)
+        {
+            m_attributeBuffer = std::make_unique<Buffer>(m_device);
+            m_attributeBuffer->SetUsage(vertexUsage)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+                .SetBufferType(Buffer::BufferType::Vertex)
+                .SetVertexBinding(1)
+                .SetCategory(Device::MemoryCategory::Geometry)
+                .SetDebugName(m_name + " vertex attributes")
+                .SetSize(sizeof(Types::VertexAttributes) * m_vertices.size());
+            if (!m_attributeBuffer->Init() ||
+                (m_pullVertices && m_attributeBuffer->RegisterBindless() == Device::BindlessHeap::InvalidIndex))
+            {
+                Logger::LogError("Failed to create vertex attribute buffer");
+                return false;
+            }
+        }
+
+        // Create index buffer
+        m_indexBuffer = std::make_unique<Buffer>(m_device);
+        m_indexBuffer->SetUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+            .SetBufferType(Buffer::BufferType::Index)
+            .SetIndexType(m_indexType)
+            .SetCategory(Device::MemoryCategory::Geometry)
+            .SetDebugName(m_name + " indices")
+            .SetSize(GetIndexBufferSize());
+        if (!m_indexBuffer->Init())
+        {
+            Logger::LogError("Failed to create index buffer");
+            return false;
+        }
+
+        if (m_meshlets.empty())
+        {
+            return true;
+        }
+
+        m_meshletBuffer = std::make_unique<Buffer>(m_device);
+        m_meshletBuffer->SetUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+            .SetCategory(Device::MemoryCategory::Geometry)
+            .SetDebugName(m_name + " meshlets")
+            .SetSize(sizeof(Types::Meshlet) * m_meshlets.size());
+        if (!m_meshletBuffer->Init() ||
+            m_meshletBuffer->RegisterBindless() == Device::BindlessHeap::InvalidIndex)
+        {
+            Logger::LogError("Failed to create meshlet buffer");
+            return false;
+        }
+        return true;
+    }
+
+    void MeshGeometry::DestroyBuffers()
+    {
+        if (m_vertexBuffer)
+        {
+            m_vertexBuffer->Cleanup();
+            m_vertexBuffer.reset();
+        }
+
+        if (m_attributeBuffer)
+        {
+            m_attributeBuffer->Cleanup();
+            m_attributeBuffer.reset();
+        }
+
+        if (m_indexBuffer)
+        {
+            m_indexBuffer->Cleanup();
+            m_indexBuffer.reset();
+        }
+
+        m_meshletBuffer.reset();
+    }
+
+    void MeshGeometry::EncodeVertices(const Types::VertexFormat format, const bool pullVertices)
+    {
+        m_vertexFormat = format;
+        m_pullVertices = pullVertices;
+        m_vertexCount = static_cast<uint32_t>(m_vertices.size());
+        m_packedVertices.clear();
+        m_dequantization = glm::mat4(1.0f);
+
+        m_positions.clear();
+        m_attributes.clear();
+
+        if (m_vertexFormat == Types::VertexFormat::Split)
+        {
+            Utils::Vertex::SplitVertices(m_vertices, m_positions, m_attributes);
+        }
+        if (m_vertexFormat == Types::VertexFormat::Packed)
+        {
+            // Positions are quantized relative to the bounds, the model matrix scales them back
+            const auto bounds = Utils::Vertex::ComputeBounds(m_vertices);
+            m_packedVertices = Utils::Vertex::PackVertices(m_vertices, bounds);
+            m_dequantization = Utils::Vertex::GetDequantizationMatrix(bounds);
+        }
+    }
+
+    void MeshGeometry::EncodeIndices()
+    {
+        m_shortIndices.clear();
+        m_indexType = VK_INDEX_TYPE_UINT32;
+        m_indexCount = static_cast<uint32_t>(m_indices.size());
+
+        // Half the index bandwidth and post-transform cache footprint whenever the vertex count allows it
+        if (m_vertices.size() <= static_cast<size_t>(UINT16_MAX) + 1)
+        {
+            m_shortIndices.assign(m_indices.begin(), m_indices.end());
+            m_indexType = VK_INDEX_TYPE_UINT16;
+        }
+    }
+
+    void MeshGeometry::ComputeBounds()
+    {
+        if (m_vertices.empty())
+        {
+            m_boundsCenter = glm::vec3(0.0f);
+            m_boundsRadius = 0.0f;
+            return;
+        }
+
+        glm::vec3 min = m_vertices.front().position;
+        glm::vec3 max = m_vertices.front().position;
+        for (const auto& vertex : m_vertices)
+        {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        m_boundsCenter = (min + max) * 0.5f;
+        m_boundsRadius = glm::length(max - min) * 0.5f;
+    }
+
+    VkDeviceSize MeshGeometry::GetIndexBufferSize() const
+    {
+        return m_indexType == VK_INDEX_TYPE_UINT16
+                   ? sizeof(uint16_t) * m_shortIndices.size()
+                   : sizeof(uint32_t) * m_indices.size();
+    }
+
+    VkDeviceSize MeshGeometry::GetGpuSize() const
+    {
+        VkDeviceSize size = 0;
+        size += m_vertexBuffer ? m_vertexBuffer->GetSize() : 0;
+        size += m_attributeBuffer ? m_attributeBuffer->GetSize() : 0;
+        size += m_indexBuffer ? m_indexBuffer->GetSize() : 0;
+        size += m_meshletBuffer ? m_meshletBuffer->GetSize() : 0;
+        return size;
+    }
+
+    bool MeshGeometry::LoadCpuData()
+    {
+        if (!m_vertices.empty() && !m_indices.empty())
+        {
+            return true;
+        }
+        if (!m_source)
+        {
+            Logger::LogError("Mesh {} has no vertices or indices to generate from", m_name);
+            return false;
+        }
+
+        try
+        {
+            if (!m_source(*this))
+            {
+                Logger::LogError("Failed to stream mesh {} from its source", m_name);
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            Logger::LogError("Failed to stream mesh {} from its source: {}", m_name, e.what());
+            return false;
+        }
+        return !m_vertices.empty() && !m_indices.empty();
+    }
+
+    void MeshGeometry::ReleaseCpuData()
+    {
+        // Without a source nothing could bring the data back
+        if (m_keepCpuData || !m_source)
+        {
+            return;
+        }
+
+        // Swapped with empty vectors, clear alone keeps the capacity
+        std::vector<Types::Vertex>().swap(m_vertices);
+        std::vector<Types::PackedVertex>().swap(m_packedVertices);
+        std::vector<glm::vec3>().swap(m_positions);
+        std::vector<Types::VertexAttributes>().swap(m_attributes);
+        std::vector<uint32_t>().swap(m_indices);
+        std::vector<uint16_t>().swap(m_shortIndices);
+    }
+
+    bool MeshGeometry::FillBuffers() const
+    {
+        // Device local buffers, every stream goes through one staging buffer and one submission
+        std::vector<std::pair<Buffer*, const void*>> uploads;
+        if (m_vertexFormat == Types::VertexFormat::Packed)
+        {
+            uploads.emplace_back(m_vertexBuffer.get(), m_packedVertices.data());
+        }
+        else if (m_vertexFormat == Types::VertexFormat::Split)
+        {
+            uploads.emplace_back(m_vertexBuffer.get(), m_positions.data());
+            uploads.emplace_back(m_attributeBuffer.get(), m_attributes.data());
+        }
+        else
+        {
+            uploads.emplace_back(m_vertexBuffer.get(), m_vertices.data());
+        }
+        if (m_indexType == VK_INDEX_TYPE_UINT16)
+        {
+            uploads.emplace_back(m_indexBuffer.get(), m_shortIndices.data());
+        }
+        else
+        {
+            uploads.emplace_back(m_indexBuffer.get(), m_indices.data());
+        }
+        if (m_meshletBuffer)
+        {
+            uploads.emplace_back(m_meshletBuffer.get(), m_meshlets.data());
+        }
+
+        VkDeviceSize stagingSize = 0;
+        for (const auto& [buffer, data] : uploads)
+        {
+            stagingSize += buffer->GetSize();
+        }
+        if (stagingSize == 0)
+        {
+            return true;
+        }
+
+        Buffer staging(m_device);
+        staging.SetSize(stagingSize)
+               .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+               .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+               .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+               .SetPersistentMapping(true)
+               .SetCategory(Device::MemoryCategory::Staging)
+               .SetDebugName(m_name + " staging");
+        if (!staging.Init())
+        {
+            Logger::LogError("Failed to create the staging buffer of mesh {}", m_name);
+            return false;
+        }
+        VkDeviceSize offset = 0;
+        for (const auto& [buffer, data] : uploads)
+        {
+            staging.Write(offset, data, buffer->GetSize());
+            offset += buffer->GetSize();
+        }
+        staging.Flush();
+
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer commandBuffer)
+            {
+                // Refilled buffers may still be read by frames in flight, the copy waits for all earlier submissions
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+                VkDeviceSize srcOffset = 0;
+                for (const auto& [buffer, data] : uploads)
+                {
+                    VkBufferCopy region = {};
+                    region.srcOffset = srcOffset;
+                    region.size = buffer->GetSize();
+                    vkCmdCopyBuffer(commandBuffer, staging.GetBuffer(), buffer->GetBuffer(), 1, &region);
+                    srcOffset += region.size;
+                }
+
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                        VK_ACCESS_SHADER_READ_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            }
+        );
+        return true;
+    }
+
+    bool MeshGeometry::RegenerateObject(const Types::VertexFormat format, const bool pullVertices)
+    {
+        const Types::VertexFormat previousFormat = m_vertexFormat;
+        const bool previousPullVertices = m_pullVertices;
+        const VkDeviceSize previousVertexSize = m_vertexBuffer ? m_vertexBuffer->GetSize() : 0;
+        const VkIndexType previousIndexType = m_indexType;
+        const VkDeviceSize previousIndexSize = m_indexBuffer ? m_indexBuffer->GetSize() : 0;
+        const VkDeviceSize previousMeshletSize = m_meshletBuffer ? m_meshletBuffer->GetSize() : 0;
+        EncodeVertices(format, pullVertices);
+        EncodeIndices();
+        ComputeBounds();
+
+        // Buffers only have to be recreated when the data no longer fits them, refilling them in place is ordered after
+        // the frames in flight by FillBuffers
+        const VkDeviceSize vertexSize = static_cast<VkDeviceSize>(Utils::Vertex::GetStride(m_vertexFormat)) *
+                                        m_vertices.size();
+        if (m_vertexFormat != previousFormat || m_pullVertices != previousPullVertices ||
+            vertexSize != previousVertexSize ||
+            m_indexType != previousIndexType || GetIndexBufferSize() != previousIndexSize ||
+            sizeof(Types::Meshlet) * m_meshlets.size() != previousMeshletSize)
+        {
+            m_device.WaitForIdle();
+            DestroyBuffers();
+            if (!CreateBuffers()) return false;
+        }
+        return FillBuffers();
+    }
+}
@@ -0,0 +1,242 @@
+//
+// Created by lepag on 7/22/2025.
+//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../buffer/buffer.h"
+#include "types.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Resources
+{
+    /// @brief Vertices, indices and ranges of a mesh along with their GPU buffers, shared by every mesh placing them
+    /// @note Holds nothing about where or how it's drawn, that's the state of each Mesh using it
+    class MeshGeometry
+    {
+        friend class GeometryResidency;
+    public:
+        /// @brief Fills the geometry's vertices, indices and ranges again, e.g. from the file it was imported from
+        using Source = std::function<bool(MeshGeometry&)>;
+
+        explicit MeshGeometry(Device::RenderingDevice& device): m_device(device) {}
+        ~MeshGeometry() { Destroy(); }
+
+        MeshGeometry& UseVertices(const std::vector<Types::Vertex>& vertices);
+        MeshGeometry& UseVertices(std::vector<Types::Vertex>&& vertices);
+        MeshGeometry& UseIndices(const std::vector<uint32_t>& indices);
+        MeshGeometry& UseIndices(std::vector<uint32_t>&& indices);
+        /// @brief Name the buffers are reported under in the memory statistics
+        MeshGeometry& SetName(const std::string& name);
+        /// @brief Index ranges of the levels of detail, the first one being full detail
+        MeshGeometry& UseLods(const std::vector<Types::MeshLod>& lods);
+        /// @brief Clusters of the full detail level, each drawing its own range of the index buffer
+        MeshGeometry& UseMeshlets(const std::vector<Types::Meshlet>& meshlets);
+        /// @brief Per material ranges of the full detail level
+        MeshGeometry& UseSubmeshes(const std::vector<Types::Submesh>& submeshes);
+        /// @brief Where the data can be streamed back from after it was released
+        /// @note With a source the CPU copies are released once uploaded, and the geometry residency may evict the GPU
+        /// buffers, both come back from the source on next use. Without one the geometry keeps everything
+        MeshGeometry& SetSource(const Source& source);
+        /// @brief Keeps the CPU copies after upload even with a source, e.g. for physics or picking
+        MeshGeometry& KeepCpuData(bool keep = true);
+        MeshGeometry& UseObjectMap(const Types::ObjectMap& objectMap)
+        {
+            m_vertices = objectMap.vertices;
+            m_indices = objectMap.indices;
+            m_dirty = true;
+            return *this;
+        }
+
+        /// @brief Creates the buffers in the given vertex format
+        /// @note Resident geometry is only refilled when its data or format changed since
+        bool Generate(Types::VertexFormat format, bool pullVertices);
+        void Destroy();
+        /// @brief Frees the GPU buffers but keeps everything needed to stream the geometry back in, see SetSource
+        void Evict();
+
+        /// @brief New geometry with the same data and source, generated on its own
+        [[nodiscard]] std::shared_ptr<MeshGeometry> Clone() const;
+
+        /// @brief Whether the buffers hold the data in this format
+        [[nodiscard]] bool IsBuiltAs(const Types::VertexFormat format, const bool pullVertices) const
+        {
+            return m_isBuilt && m_vertexFormat == format && m_pullVertices == pullVertices;
+        }
+
+        [[nodiscard]] const std::string& GetName() const
+        {
+            return m_name;
+        }
+
+        [[nodiscard]] Buffer* GetVertexBuffer() const
+        {
+            return m_vertexBuffer.get();
+        }
+
+        /// @brief Second stream of split vertices, null for the other formats
+        [[nodiscard]] Buffer* GetAttributeBuffer() const
+        {
+            return m_attributeBuffer.get();
+        }
+
+        [[nodiscard]] Buffer* GetIndexBuffer() const
+        {
+            return m_indexBuffer.get();
+        }
+
+        [[nodiscard]] Buffer* GetMeshletBuffer() const
+        {
+            return m_meshletBuffer.get();
+        }
+
+        [[nodiscard]] Types::VertexFormat GetVertexFormat() const
+        {
+            return m_vertexFormat;
+        }
+
+        /// @brief Whether the vertex streams were created as storage buffers for a vertex pulling pipeline
+        [[nodiscard]] bool IsPullingVertices() const
+        {
+            return m_pullVertices;
+        }
+
+        /// @brief Maps packed positions back to object space, identity for the other formats
+        [[nodiscard]] const glm::mat4& GetDequantization() const
+        {
+            return m_dequantization;
+        }
+
+        [[nodiscard]] uint32_t GetIndexCount() const
+        {
+            return m_indexCount;
+        }
+
+        /// @brief VK_INDEX_TYPE_UINT16 whenever every vertex can be addressed with 16 bits
+        [[nodiscard]] VkIndexType GetIndexType() const
+        {
+            return m_indexType;
+        }
+
+        [[nodiscard]] const std::vector<Types::MeshLod>& GetLods() const
+        {
+            return m_lods;
+        }
+
+        [[nodiscard]] const std::vector<Types::Meshlet>& GetMeshlets() const
+        {
+            return m_meshlets;
+        }
+
+        [[nodiscard]] const std::vector<Types::Submesh>& GetSubmeshes() const
+        {
+            return m_submeshes;
+        }
+
+        /// @brief Object space bounding sphere
+        [[nodiscard]] const glm::vec3& GetBoundsCenter() const
+        {
+            return m_boundsCenter;
+        }
+
+        [[nodiscard]] float GetBoundsRadius() const
+        {
+            return m_boundsRadius;
+        }
+
+        [[nodiscard]] bool IsResident() const
+        {
+            return m_isBuilt;
+        }
+
+        /// @brief Whether the residency released the buffers, the next user streams them back in
+        [[nodiscard]] bool IsEvicted() const
+        {
+            return m_evicted;
+        }
+
+        /// @brief Whether the geometry can be evicted and streamed back in, i.e. it has a source
+        [[nodiscard]] bool CanEvict() const
+        {
+            return m_isBuilt && static_cast<bool>(m_source);
+        }
+
+        /// @brief Bytes of vertex, index and meshlet buffers the geometry holds on the GPU
+        [[nodiscard]] VkDeviceSize GetGpuSize() const;
+
+        [[nodiscard]] uint64_t GetLastUsedFrame() const
+        {
+            return m_lastUsedFrame;
+        }
+
+        void SetLastUsedFrame(const uint64_t frame)
+        {
+            m_lastUsedFrame = frame;
+        }
+    private:
+        Device::RenderingDevice& m_device;
+
+        std::string m_name = "Mesh";
+        std::unique_ptr<Buffer> m_vertexBuffer;
+        std::unique_ptr<Buffer> m_attributeBuffer;
+        std::unique_ptr<Buffer> m_indexBuffer;
+        std::unique_ptr<Buffer> m_meshletBuffer;
+
+        uint32_t m_indexCount = 0;
+        uint32_t m_vertexCount = 0;
+        std::vector<Types::Vertex> m_vertices;
+        std::vector<Types::PackedVertex> m_packedVertices;
+        std::vector<glm::vec3> m_positions;
+        std::vector<Types::VertexAttributes> m_attributes;
+        Types::VertexFormat m_vertexFormat = Types::VertexFormat::Full;
+        bool m_pullVertices = false;
+        glm::mat4 m_dequantization{1.0f};
+        std::vector<uint32_t> m_indices;
+        std::vector<uint16_t> m_shortIndices;
+        VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+        std::vector<Types::MeshLod> m_lods;
+        std::vector<Types::Meshlet> m_meshlets;
+        std::vector<Types::Submesh> m_submeshes;
+        glm::vec3 m_boundsCenter{0.0f};
+        float m_boundsRadius = 0.0f;
+
+        Source m_source;
+        bool m_keepCpuData = false;
+        bool m_evicted = false;
+        uint64_t m_lastUsedFrame = 0;
+
+        bool m_isBuilt = false;
+        /// @brief Whether the data changed since the buffers were filled
+        bool m_dirty = false;
+
+        void EncodeVertices(Types::VertexFormat format, bool pullVertices);
+        void EncodeIndices();
+        void ComputeBounds();
+        [[nodiscard]] VkDeviceSize GetIndexBufferSize() const;
+
+        bool CreateBuffers();
+        void DestroyBuffers();
+
+        /// @brief Copies the encoded data into the device local buffers through a staging buffer
+        bool FillBuffers() const;
+
+        /// @brief Frees the GPU buffers without unregistering, used by the residency while it holds its lock
+        void ReleaseGpuData();
+        /// @brief Streams the CPU copies back in from the source when they were released
+        bool LoadCpuData();
+        void ReleaseCpuData();
+
+        bool RegenerateObject(Types::VertexFormat format, bool pullVertices);
+    };
+
+    using MeshGeometryHandle = std::shared_ptr<MeshGeometry>;
+}
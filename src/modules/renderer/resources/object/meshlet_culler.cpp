@@ -0,0 +1,135 @@
+//
+// Created by lepag on 7/19/2025.
+//
+
+#include "meshlet_culler.h"
+
+#include "context/rendering_device.h"
+#include "rendering/renderer.h"
+
+namespace GyroEngine::Resources
+{
+    MeshletCuller& MeshletCuller::SetShader(const ShaderHandle& shader)
+    {
+        m_shader = shader;
+        return *this;
+    }
+
+    MeshletCuller& MeshletCuller::SetDepthPyramid(const ImageHandle& depthPyramid, const SamplerHandle& sampler)
+    {
+        m_depthPyramid = depthPyramid;
+        m_depthSampler = sampler;
+        return *this;
+    }
+
+    bool MeshletCuller::Init()
+    {
+        if (!m_shader || m_shader->GetShaderStage() != Utils::Shader::ShaderStage::Compute)
+        {
+            Logger::LogError("Meshlet culler needs a compute shader");
+            return false;
+        }
+
+        m_pipelineBindings = std::make_shared<PipelineBindings>(m_device);
+        m_pipelineBindings->AddShader(m_shader).UseBindless();
+        if (!m_pipelineBindings->Init())
+        {
+            Logger::LogError("Failed to create meshlet cull bindings");
+            m_pipelineBindings.reset();
+            return false;
+        }
+
+        m_pipeline = std::make_shared<Pipeline>(m_device);
+        m_pipeline->SetPipelineBindings(m_pipelineBindings);
+        if (!m_pipeline->Init())
+        {
+            Logger::LogError("Failed to create meshlet cull pipeline");
+            Cleanup();
+            return false;
+        }
+        return true;
+    }
+
+    void MeshletCuller::Cleanup()
+    {
+        m_pipeline.reset();
+        m_pipelineBindings.reset();
+    }
+
+    void MeshletCuller::Begin(const Rendering::FrameContext& frameContext) const
+    {
+        if (m_pipeline)
+        {
+            m_pipeline->Bind(frameContext);
+        }
+    }
+
+    void MeshletCuller::Dispatch(const Rendering::FrameContext& frameContext, MeshletCullConstants constants) const
+    {
+        if (!m_pipeline || constants.meshletCount == 0)
+        {
+            return;
+        }
+
+        const bool occlusion = m_depthPyramid && m_depthSampler &&
+                               m_depthPyramid->GetBindlessIndex() != Device::BindlessHeap::InvalidIndex &&
+                               m_depthSampler->GetBindlessIndex() != Device::BindlessHeap::InvalidIndex;
+        constants.depthPyramid = occlusion ? m_depthPyramid->GetBindlessIndex() : Device::BindlessHeap::InvalidIndex;
+        constants.depthSampler = occlusion ? m_depthSampler->GetBindlessIndex() : Device::BindlessHeap::InvalidIndex;
+
+        vkCmdPushConstants(frameContext.cmd, m_pipeline->GetPipelineLayout(), VK_SHADER_STAGE_ALL, 0,
+                           sizeof(MeshletCullConstants), &constants);
+
+        // One invocation per meshlet, 64 to a group
+        m_pipeline->Dispatch(frameContext, (constants.meshletCount + 63) / 64);
+    }
+
+    void MeshletCuller::End(const Rendering::FrameContext& frameContext) const
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(frameContext.cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    MeshletCullData MeshletCuller::MakeCullData(const glm::mat4& view, const glm::mat4& projection) const
+    {
+        MeshletCullData data;
+        data.view = view;
+        data.projection = projection;
+
+        // Gribb-Hartmann, the planes are combinations of the rows of the view-projection matrix
+        const glm::mat4 viewProjection = projection * view;
+        const glm::vec4 row0 = {viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]};
+        const glm::vec4 row1 = {viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]};
+        const glm::vec4 row2 = {viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]};
+        const glm::vec4 row3 = {viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]};
+
+        // The near plane assumes a -1 to 1 depth range, which is only looser for 0 to 1 projections
+        data.frustumPlanes[0] = row3 + row0;
+        data.frustumPlanes[1] = row3 - row0;
+        data.frustumPlanes[2] = row3 + row1;
+        data.frustumPlanes[3] = row3 - row1;
+        data.frustumPlanes[4] = row3 + row2;
+        data.frustumPlanes[5] = row3 - row2;
+        for (auto& plane : data.frustumPlanes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        const glm::mat4 inverseView = glm::inverse(view);
+        data.camera = glm::vec4(glm::vec3(inverseView[3]), 1.0f);
+
+        // Near plane of a perspective projection with glm's default -1 to 1 depth range
+        const float zNear = projection[3][2] / (projection[2][2] - 1.0f);
+        data.parameters.x = std::abs(zNear);
+        if (m_depthPyramid)
+        {
+            data.parameters.y = static_cast<float>(m_depthPyramid->GetExtent().width);
+            data.parameters.z = static_cast<float>(m_depthPyramid->GetExtent().height);
+        }
+        return data;
+    }
+}
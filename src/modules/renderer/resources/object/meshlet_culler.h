@@ -0,0 +1,97 @@
+//
+// Created by lepag on 7/19/2025.
+//
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "../pipeline/pipeline.h"
+#include "../pipeline/shader.h"
+#include "../texture/image.h"
+#include "../texture/sampler.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Rendering
+{
+    struct FrameContext;
+}
+
+namespace GyroEngine::Resources
+{
+    /// @brief Per-mesh data of the cull shader, mirrors the cull data read by meshlet_cull.comp
+    struct MeshletCullData
+    {
+        glm::mat4 model{1.0f};
+        /// @brief World space planes, pointing into the frustum
+        glm::vec4 frustumPlanes[6] = {};
+        /// @brief World space camera position, w is the largest axis of the model's scale
+        glm::vec4 camera{0.0f};
+        glm::mat4 view{1.0f};
+        glm::mat4 projection{1.0f};
+        /// @brief Near plane distance, depth pyramid width and height
+        glm::vec4 parameters{0.0f};
+    };
+
+    /// @brief Per-dispatch push constants of the cull shader, mirrors CullConstants in meshlet_cull.comp
+    /// @note Buffer fields are bindless heap indices, the cull offset is counted in vec4s
+    struct MeshletCullConstants
+    {
+        uint32_t meshletBuffer = UINT32_MAX;
+        uint32_t drawBuffer = UINT32_MAX;
+        uint32_t cullBuffer = UINT32_MAX;
+        uint32_t cullOffset = 0;
+        uint32_t meshletCount = 0;
+        uint32_t depthPyramid = UINT32_MAX;
+        uint32_t depthSampler = UINT32_MAX;
+        uint32_t padding = 0;
+    };
+
+    /// @brief Compute pass that culls meshlets by frustum, normal cone and, with a depth pyramid, occlusion
+    /// @note Meshes record their dispatches between Begin and End, which has to happen outside of rendering. Each
+    /// dispatch writes one indirect draw per meshlet, with no instances when the meshlet was culled
+    class MeshletCuller
+    {
+    public:
+        explicit MeshletCuller(Device::RenderingDevice& device): m_device(device) {}
+        ~MeshletCuller() { Cleanup(); }
+
+        /// @brief Compiled meshlet_cull.comp
+        MeshletCuller& SetShader(const ShaderHandle& shader);
+        /// @brief Last frame's depth pyramid, every texel holding the farthest depth it covers
+        /// @note Both have to be registered in the bindless heap, without them occlusion culling is skipped
+        MeshletCuller& SetDepthPyramid(const ImageHandle& depthPyramid, const SamplerHandle& sampler);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Binds the cull pipeline
+        void Begin(const Rendering::FrameContext& frameContext) const;
+        void Dispatch(const Rendering::FrameContext& frameContext, MeshletCullConstants constants) const;
+        /// @brief Makes the written draws visible to the indirect draws that follow
+        void End(const Rendering::FrameContext& frameContext) const;
+
+        /// @brief Fills the cull data shared by every mesh seen from the same camera
+        [[nodiscard]] MeshletCullData MakeCullData(const glm::mat4& view, const glm::mat4& projection) const;
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return m_pipeline != nullptr;
+        }
+    private:
+        Device::RenderingDevice& m_device;
+
+        ShaderHandle m_shader;
+        ImageHandle m_depthPyramid;
+        SamplerHandle m_depthSampler;
+
+        std::shared_ptr<PipelineBindings> m_pipelineBindings;
+        std::shared_ptr<Pipeline> m_pipeline;
+    };
+
+    using MeshletCullerHandle = std::shared_ptr<MeshletCuller>;
+}
@@ -4,6 +4,7 @@
 
 #include "pipeline.h"
 
+#include <algorithm>
 #include <map>
 
 #include "context/rendering_device.h"
@@ -37,6 +38,12 @@ namespace GyroEngine::Resources
             return false;
         }
         if (!BuildPipelineLayout()) return false;
+        if (m_pipelineBindings->IsCompute())
+        {
+            m_bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+            return BuildComputePipeline();
+        }
+        m_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
         if (!BuildPipeline()) return false;
         return true;
     }
@@ -62,12 +69,13 @@ namespace GyroEngine::Resources
         if (m_pipeline == VK_NULL_HANDLE || m_pipelineLayout == VK_NULL_HANDLE)
             return;
 
-        vkCmdBindPipeline(frameContext.cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+        vkCmdBindPipeline(frameContext.cmd, m_bindPoint, m_pipeline);
 
         if (!m_pipelineBindings)
             return;
 
-        m_pipelineBindings->Bind(frameContext, m_pipelineLayout);
+        m_pipelineBindings->Bind(frameContext, m_pipelineLayout, m_bindPoint);
+        m_pipelineBindings->BindConstants(frameContext, m_pipelineLayout);
     }
 
     void Pipeline::DrawFullscreenQuad(const Rendering::FrameContext &frameContext) const
@@ -82,6 +90,15 @@ namespace GyroEngine::Resources
         }
     }
 
+    void Pipeline::Dispatch(const Rendering::FrameContext &frameContext, const uint32_t groupCountX,
+                            const uint32_t groupCountY, const uint32_t groupCountZ) const
+    {
+        if (m_pipeline == VK_NULL_HANDLE || m_bindPoint != VK_PIPELINE_BIND_POINT_COMPUTE)
+            return;
+
+        vkCmdDispatch(frameContext.cmd, groupCountX, groupCountY, groupCountZ);
+    }
+
     bool Pipeline::BuildPipelineLayout()
     {
         VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
@@ -91,6 +108,12 @@ namespace GyroEngine::Resources
         m_descriptorSetLayouts.clear();
         std::map<uint32_t, VkDescriptorSetLayout> descriptorSetLayouts;
 
+        const bool bindless = m_pipelineBindings->IsBindless();
+        if (bindless)
+        {
+            descriptorSetLayouts[0] = m_device.GetBindlessHeap().GetLayout();
+        }
+
         // Fill the map
         for (const auto set : m_pipelineBindings->GetSets()) {
             descriptorSetLayouts[set->set] = set->layout;
@@ -106,7 +129,22 @@ namespace GyroEngine::Resources
 
         const auto pushConstants = m_pipelineBindings->GetPushConstants();
 
-        if (!pushConstants.empty())
+        if (bindless)
+        {
+            // Every bindless layout has to declare the same range, otherwise binding a pipeline would disturb the heap
+            for (const auto &pushConstant: pushConstants)
+            {
+                if (pushConstant.offset + pushConstant.size > Device::BindlessHeap::PushConstantSize)
+                {
+                    Logger::LogError("Push constant block {} exceeds the {} bytes available to bindless pipelines",
+                                     pushConstant.name, Device::BindlessHeap::PushConstantSize);
+                    return false;
+                }
+            }
+            m_pushConstantRanges = {m_device.GetBindlessHeap().GetPushConstantRange()};
+            pipelineLayoutInfo.pushConstantRangeCount = 1;
+            pipelineLayoutInfo.pPushConstantRanges = m_pushConstantRanges.data();
+        } else if (!pushConstants.empty())
         {
             m_pushConstantRanges.clear();
             m_pushConstantRanges.reserve(pushConstants.size());
@@ -158,10 +196,16 @@ namespace GyroEngine::Resources
         pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
         pipelineInfo.pStages = shaderStages.data();
 
-        // Vertex input
         std::vector<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions;
         std::vector<VkVertexInputBindingDescription> vertexInputBindingDescriptions;
 
+        // Vertex input, the shader's vertex format layout unless it was configured by hand
+        if (m_pipelineConfig.vertexInputState.inputBindings.empty())
+        {
+            vertexInputBindingDescriptions = m_pipelineBindings->GetVertexBindingDescriptions();
+            vertexInputAttributeDescriptions = m_pipelineBindings->GetVertexAttributeDescriptions();
+        }
+
         uint32_t attributeCount = 0;
         for (const auto& binding : m_pipelineConfig.vertexInputState.inputBindings)
         {
@@ -179,7 +223,7 @@ namespace GyroEngine::Resources
             vertexInputBindingDescription.inputRate = inputRate;
             vertexInputBindingDescriptions.push_back(vertexInputBindingDescription);
 
-            for (const auto& [name, offset] : attributes)
+            for (const auto& [name, offset, format] : attributes)
             {
                 PipelineBindings::VertexInput inputAttr = {};
                 for (const auto& attr : m_pipelineBindings->GetVertexInputs())
@@ -198,7 +242,7 @@ namespace GyroEngine::Resources
                 VkVertexInputAttributeDescription vertexInputAttributeDescription = {};
                 vertexInputAttributeDescription.binding = binding;
                 vertexInputAttributeDescription.location = inputAttr.location;
-                vertexInputAttributeDescription.format = inputAttr.format;
+                vertexInputAttributeDescription.format = format != VK_FORMAT_UNDEFINED ? format : inputAttr.format;
                 vertexInputAttributeDescription.offset = offset;
                 vertexInputAttributeDescriptions.push_back(vertexInputAttributeDescription);
             }
@@ -314,4 +358,31 @@ namespace GyroEngine::Resources
         }
         return true;
     }
+
+    bool Pipeline::BuildComputePipeline()
+    {
+        m_pipelineConfig.pipelineLayout = m_pipelineLayout;
+
+        const auto& shaders = m_pipelineBindings->GetShaderStages();
+        const auto shader = std::find_if(shaders.begin(), shaders.end(), [](const ShaderHandle& stage)
+        {
+            return stage->GetShaderStage() == Utils::Shader::ShaderStage::Compute;
+        });
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = (*shader)->GetShaderModule();
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = m_pipelineLayout;
+
+        if (vkCreateComputePipelines(m_device.GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                     &m_pipeline) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create compute pipeline for shader {}", (*shader)->GetShaderPath());
+            return false;
+        }
+        return true;
+    }
 }
@@ -36,6 +36,9 @@ namespace GyroEngine::Resources
 
         void Bind(const Rendering::FrameContext& frameContext) const;
         void DrawFullscreenQuad(const Rendering::FrameContext& frameContext) const;
+        /// @brief Records a dispatch of a compute pipeline, bind it first
+        void Dispatch(const Rendering::FrameContext& frameContext, uint32_t groupCountX, uint32_t groupCountY = 1,
+                      uint32_t groupCountZ = 1) const;
 
         [[nodiscard]] Utils::Pipeline::PipelineConfig& GetPipelineConfig()
         {
@@ -56,11 +59,17 @@ namespace GyroEngine::Resources
         {
             return m_pipelineBindings;
         }
+
+        [[nodiscard]] VkPipelineBindPoint GetBindPoint() const
+        {
+            return m_bindPoint;
+        }
     private:
         Device::RenderingDevice& m_device;
 
         VkPipeline m_pipeline = VK_NULL_HANDLE;
         VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipelineBindPoint m_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
         std::shared_ptr<PipelineBindings> m_pipelineBindings;
 
         Utils::Pipeline::PipelineConfig m_pipelineConfig{};
@@ -73,6 +82,7 @@ namespace GyroEngine::Resources
 
         bool BuildPipelineLayout();
         bool BuildPipeline();
+        bool BuildComputePipeline();
     };
 
     using PipelineHandle = std::shared_ptr<Pipeline>;
@@ -4,6 +4,7 @@
 
 #include "pipeline_bindings.h"
 
+#include <algorithm>
 #include <map>
 #include <spirv_reflect.h>
 
@@ -11,9 +12,12 @@
 #include "debug/logger.h"
 #include "rendering/renderer.h"
 #include "utilities/shader.h"
+#include "utilities/vertex.h"
 
 namespace GyroEngine::Resources
 {
+    std::vector<PipelineBindings::BoundSet> PipelineBindings::s_boundSets;
+
     bool PipelineBindings::Init()
     {
         if (!CreateSpvModules())
@@ -84,10 +88,13 @@ namespace GyroEngine::Resources
         m_sets.clear();
         m_spvModules.clear();
         m_descriptorPools.clear();
+        m_bufferWrites.clear();
+        m_imageWrites.clear();
+        m_relocationGenerations.clear();
     }
 
     void PipelineBindings::UpdateDescriptorBuffer(const std::string& name, const BufferHandle& buffer,
-                                                  uint32_t index)
+                                                  uint32_t index, VkDeviceSize offset, VkDeviceSize range)
     {
         auto bindingOpt = GetBinding(name);
         if (!bindingOpt.has_value())
@@ -99,10 +106,27 @@ namespace GyroEngine::Resources
         const auto set = bindingOpt->first;
         const auto binding = bindingOpt->second;
 
+        if (range == VK_WHOLE_SIZE)
+        {
+            range = buffer->GetSize() - offset;
+        }
+
+        // Skip the write if this frame's set already references the same range
+        auto& writes = m_bufferWrites[name];
+        if (writes.size() < set.descriptorSets.size())
+        {
+            writes.resize(set.descriptorSets.size());
+        }
+        BufferWrite& lastWrite = writes[index];
+        if (lastWrite.buffer == buffer->GetBuffer() && lastWrite.offset == offset && lastWrite.range == range)
+        {
+            return;
+        }
+
         VkDescriptorBufferInfo bufferInfoDesc = {};
         bufferInfoDesc.buffer = buffer->GetBuffer();
-        bufferInfoDesc.offset = 0;
-        bufferInfoDesc.range = buffer->GetSize();
+        bufferInfoDesc.offset = offset;
+        bufferInfoDesc.range = range;
 
         VkWriteDescriptorSet writeDesc = {};
         writeDesc.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -114,9 +138,37 @@ namespace GyroEngine::Resources
         writeDesc.pBufferInfo = &bufferInfoDesc;
 
         vkUpdateDescriptorSets(m_device.GetLogicalDevice(), 1, &writeDesc, 0, nullptr);
+        lastWrite = {buffer, buffer->GetBuffer(), offset, range};
         //Logger::Log("Updated descriptor buffer for binding: {}", name);
     }
 
+    void PipelineBindings::SetDynamicOffset(const std::string& name, const uint32_t offset)
+    {
+        for (const auto& set : m_sets)
+        {
+            for (auto& binding : set->bindings)
+            {
+                if (binding.name == name)
+                {
+                    binding.dynamicOffset = offset;
+                    return;
+                }
+            }
+        }
+        Logger::LogError("Dynamic binding {} was not found", name);
+    }
+
+    bool PipelineBindings::IsDynamicBinding(const std::string& name)
+    {
+        const auto bindingOpt = GetBinding(name);
+        if (!bindingOpt.has_value())
+        {
+            return false;
+        }
+        const VkDescriptorType type = bindingOpt->second.type;
+        return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+
     void PipelineBindings::UpdateDescriptorImage(const std::string& name, const SamplerHandle& sampler,
                                                  const ImageHandle& image,
                                                  uint32_t index)
@@ -128,6 +180,19 @@ namespace GyroEngine::Resources
             return;
         }
 
+        // Skip the write if this frame's set already references the same view
+        auto& writes = m_imageWrites[name];
+        if (writes.size() < bindingOpt->first.descriptorSets.size())
+        {
+            writes.resize(bindingOpt->first.descriptorSets.size());
+        }
+        ImageWrite& lastWrite = writes[index];
+        if (lastWrite.imageView == image->GetImageView() && lastWrite.sampler == sampler &&
+            lastWrite.imageLayout == image->GetImageLayout())
+        {
+            return;
+        }
+
         VkDescriptorImageInfo imageInfoDesc = {};
         imageInfoDesc.imageLayout = image->GetImageLayout();
         imageInfoDesc.imageView = image->GetImageView();
@@ -143,6 +208,7 @@ namespace GyroEngine::Resources
         writeDesc.pImageInfo = &imageInfoDesc;
 
         vkUpdateDescriptorSets(m_device.GetLogicalDevice(), 1, &writeDesc, 0, nullptr);
+        lastWrite = {image, sampler, image->GetImageView(), image->GetImageLayout()};
         //Logger::Log("Updated descriptor image for binding: {}", name);
     }
 
@@ -156,49 +222,89 @@ namespace GyroEngine::Resources
             return;
         }
 
-        auto pushConstantOpt = GetPushConstant(block, name);
-        if (!pushConstantOpt.has_value())
+        // Look the member up in place, the values have to outlive this call
+        const auto blockIt = std::find_if(m_pushConstants.begin(), m_pushConstants.end(),
+                                          [&](const PushConstantBlock& b) { return b.name == block; });
+        if (blockIt == m_pushConstants.end())
+        {
+            Logger::LogError("Push constant {} in block {} was not found", name, block);
+            return;
+        }
+        const auto memberIt = std::find_if(blockIt->members.begin(), blockIt->members.end(),
+                                           [&](const PushConstantMember& m) { return m.name == name; });
+        if (memberIt == blockIt->members.end())
         {
             Logger::LogError("Push constant {} in block {} was not found", name, block);
             return;
         }
-
-        auto& [b, m] = pushConstantOpt.value();
-        uint32_t memberOffset = m.offset + offset;
 
         // Ensure the size does not exceed the push constant member size
-        if (size + offset > m.size)
+        if (size + offset > memberIt->size)
         {
             Logger::LogError("Push constant {} in block {} exceeds size limit", name, block);
             return;
         }
 
-        // Allocate memory for the push constant data if not already allocated
-        if (!m.data)
+        if (blockIt->data.empty())
         {
-            m.data = malloc(m.size);
-            if (!m.data)
-            {
-                Logger::LogError("Failed to allocate memory for push constant {} in block {}", name, block);
-                return;
-            }
-            memset(m.data, 0, m.size);
+            blockIt->data.resize(blockIt->size, 0);
         }
 
-        // Copy new data to the push constant data
-        uint8_t* dataPtr = static_cast<uint8_t*>(m.data) + memberOffset;
-        memcpy(dataPtr, data, size);
+        // Member offsets are relative to the start of the push constant range, the block's data starts at its offset
+        const uint32_t dataOffset = memberIt->offset - blockIt->offset + offset;
+        memcpy(blockIt->data.data() + dataOffset, data, size);
+    }
+
+    void PipelineBindings::UpdatePushConstantAddress(const std::string& block, const std::string& name,
+                                                     const BufferHandle& buffer, const VkDeviceSize offset)
+    {
+        const VkDeviceAddress address = buffer ? buffer->GetDeviceAddress(offset) : 0;
+        if (address == 0)
+        {
+            Logger::LogError("Buffer for push constant {} in block {} has no device address", name, block);
+            return;
+        }
+        UpdatePushConstant(block, name, &address, sizeof(VkDeviceAddress));
     }
 
     void PipelineBindings::BindConstants(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout)
     {
-        return; // No push constants to bind in this implementation
+        for (const auto& pushConstant : m_pushConstants)
+        {
+            if (pushConstant.data.empty())
+            {
+                continue;
+            }
+
+            // Bindless layouts declare a single range visible to all stages, pushes have to name all of them
+            const VkShaderStageFlags stageFlags = m_bindless ? VK_SHADER_STAGE_ALL : pushConstant.stageFlags;
+            vkCmdPushConstants(frameContext.cmd, pipelineLayout, stageFlags, pushConstant.offset,
+                               static_cast<uint32_t>(pushConstant.data.size()), pushConstant.data.data());
+        }
     }
 
-    void PipelineBindings::Bind(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout)
+    void PipelineBindings::Bind(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout,
+                                const VkPipelineBindPoint bindPoint)
     {
         VkCommandBuffer cmd = frameContext.cmd;
 
+        // This frame's sets aren't in use by the GPU anymore, so moved resources can be rewritten now
+        RefreshRelocatedDescriptors(frameContext.frameIndex);
+
+        // Bindless layouts all agree on set 0, so the heap stays bound across them. Any other layout may disturb it
+        auto& bindlessHeap = m_device.GetBindlessHeap();
+        if (m_bindless)
+        {
+            // The heap is bound through its own layout, which may disturb the sets above it
+            if (bindlessHeap.Bind(cmd, bindPoint))
+            {
+                s_boundSets.clear();
+            }
+        } else if (!m_sets.empty())
+        {
+            bindlessHeap.Invalidate();
+        }
+
         // Bind descriptor sets for each set
         for (const auto& set : m_sets)
         {
@@ -210,9 +316,97 @@ namespace GyroEngine::Resources
             if (frameIndex >= set->descriptorSets.size())
                 frameIndex = frameIndex % set->descriptorSets.size();
 
+            // Dynamic offsets are consumed in binding order
+            std::vector<std::pair<uint32_t, uint32_t>> dynamicBindings;
+            for (const auto& binding : set->bindings)
+            {
+                if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                    binding.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+                {
+                    dynamicBindings.emplace_back(binding.binding, binding.dynamicOffset);
+                }
+            }
+            std::sort(dynamicBindings.begin(), dynamicBindings.end());
+
+            std::vector<uint32_t> dynamicOffsets;
+            dynamicOffsets.reserve(dynamicBindings.size());
+            for (const auto& [binding, offset] : dynamicBindings)
+            {
+                dynamicOffsets.push_back(offset);
+            }
+
             VkDescriptorSet descriptorSet = set->descriptorSets[frameIndex].descriptorSet;
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
-                                    set->set, 1, &descriptorSet, 0, nullptr);
+            if (s_boundSets.size() <= set->set)
+            {
+                s_boundSets.resize(set->set + 1);
+            }
+            const BoundSet& bound = s_boundSets[set->set];
+            if (bound.cmd == cmd && bound.bindPoint == bindPoint && bound.layout == pipelineLayout &&
+                bound.descriptorSet == descriptorSet && bound.dynamicOffsets == dynamicOffsets)
+            {
+                continue;
+            }
+
+            vkCmdBindDescriptorSets(cmd, bindPoint, pipelineLayout,
+                                    set->set, 1, &descriptorSet,
+                                    static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+
+            // Only sets bound through the same layout are known to be compatible, the others may be disturbed
+            for (BoundSet& other : s_boundSets)
+            {
+                if (other.layout != pipelineLayout)
+                {
+                    other = {};
+                }
+            }
+            s_boundSets[set->set] = {cmd, bindPoint, pipelineLayout, descriptorSet, std::move(dynamicOffsets)};
+        }
+    }
+
+    void PipelineBindings::BeginFrame()
+    {
+        s_boundSets.clear();
+    }
+
+    void PipelineBindings::RefreshRelocatedDescriptors(const uint32_t frameIndex)
+    {
+        const uint64_t generation = m_device.GetDefragmenter().GetGeneration();
+        if (m_relocationGenerations.size() <= frameIndex)
+        {
+            m_relocationGenerations.resize(frameIndex + 1, 0);
+        }
+        if (m_relocationGenerations[frameIndex] == generation)
+        {
+            return;
+        }
+        m_relocationGenerations[frameIndex] = generation;
+
+        for (auto& [name, writes] : m_bufferWrites)
+        {
+            if (frameIndex >= writes.size())
+            {
+                continue;
+            }
+            const BufferWrite write = writes[frameIndex];
+            const auto buffer = write.source.lock();
+            if (buffer && buffer->GetBuffer() != write.buffer)
+            {
+                UpdateDescriptorBuffer(name, buffer, frameIndex, write.offset, write.range);
+            }
+        }
+
+        for (auto& [name, writes] : m_imageWrites)
+        {
+            if (frameIndex >= writes.size())
+            {
+                continue;
+            }
+            const ImageWrite write = writes[frameIndex];
+            const auto image = write.source.lock();
+            if (image && write.sampler && image->GetImageView() != write.imageView)
+            {
+                UpdateDescriptorImage(name, write.sampler, image, frameIndex);
+            }
         }
     }
 
@@ -289,6 +483,12 @@ namespace GyroEngine::Resources
 
     bool PipelineBindings::GetInputAttributes()
     {
+        if (m_vertexPulling && !m_bindless)
+        {
+            Logger::LogError("Vertex pulling reads the vertices through the bindless heap, it requires UseBindless");
+            return false;
+        }
+
         // Iterate through each shader stage and reflect input attributes
         for (const auto& [stage, spvModule] : m_spvModules)
         {
@@ -329,6 +529,60 @@ namespace GyroEngine::Resources
                 m_vertexInputs.push_back(attribute);
             }
         }
+
+        // The whole input signature picks the format, the layout read most exactly wins and full vertices win ties.
+        // Packed attributes are narrower, e.g. a packed normal is read as a vec2 where a full one is a vec3
+        const int fullMatch = Utils::Vertex::GetLayout(Types::VertexFormat::Full).Match(m_vertexInputs);
+        const int packedMatch = Utils::Vertex::GetLayout(Types::VertexFormat::Packed).Match(m_vertexInputs);
+        if (fullMatch < 0 && packedMatch < 0)
+        {
+            Logger::LogError("Vertex shader inputs match neither the full nor the packed vertex layout");
+            return false;
+        }
+        m_vertexFormat = packedMatch > fullMatch ? Types::VertexFormat::Packed : Types::VertexFormat::Full;
+        if (m_splitVertexStreams && m_vertexFormat == Types::VertexFormat::Full)
+        {
+            m_vertexFormat = Types::VertexFormat::Split;
+        }
+
+        if (m_vertexPulling && !m_vertexInputs.empty())
+        {
+            Logger::LogError("Vertex pulling pipelines fetch their vertices themselves, the vertex shader can't have inputs");
+            return false;
+        }
+
+        // Validate the shader against the format's compile time layout once, pipelines then take the descriptions as is
+        m_vertexBindingDescriptions.clear();
+        m_vertexAttributeDescriptions.clear();
+        const auto layout = Utils::Vertex::GetLayout(m_vertexFormat);
+        for (const auto& input : m_vertexInputs)
+        {
+            const auto* attribute = layout.FindAttribute(input.location);
+            if (!attribute)
+            {
+                Logger::LogError("Vertex input {} at location {} isn't part of the vertex format", input.name,
+                                 input.location);
+                return false;
+            }
+            if (Utils::Vertex::GetNumericType(attribute->format) != Utils::Vertex::GetNumericType(input.format))
+            {
+                Logger::LogError("Vertex input {} at location {} doesn't read the vertex format's type", input.name,
+                                 input.location);
+                return false;
+            }
+            m_vertexAttributeDescriptions.push_back(*attribute);
+        }
+
+        // Only streams the shader reads from are bound, a position only shader on split vertices fetches 12 bytes
+        for (uint32_t i = 0; i < layout.bindingCount; ++i)
+        {
+            const auto& binding = layout.bindings[i];
+            if (std::any_of(m_vertexAttributeDescriptions.begin(), m_vertexAttributeDescriptions.end(),
+                            [&](const auto& attribute) { return attribute.binding == binding.binding; }))
+            {
+                m_vertexBindingDescriptions.push_back(binding);
+            }
+        }
         return true;
     }
 
@@ -358,6 +612,12 @@ namespace GyroEngine::Resources
 
                 // Check if this set has already been created
                 const SpvReflectDescriptorSet* spvSet = sets[i];
+                if (m_bindless && spvSet->set == 0)
+                {
+                    // Set 0 is the bindless heap, its layout is owned by the device
+                    continue;
+                }
+
                 auto it = std::find_if(m_sets.begin(), m_sets.end(),
                                        [&](const std::shared_ptr<Set>& thisSet)
                                        {
@@ -370,6 +630,9 @@ namespace GyroEngine::Resources
                     set->set = spvSet->set;
                     set->layout = VK_NULL_HANDLE;
                     m_sets.push_back(set);
+                } else
+                {
+                    set = *it;
                 }
 
                 for (uint32_t j = 0; j < spvSet->binding_count; ++j)
@@ -388,8 +651,13 @@ namespace GyroEngine::Resources
                         {
                         case Utils::Shader::ShaderStage::Vertex:
                             shaderStage = VK_SHADER_STAGE_VERTEX_BIT;
+                            break;
                         case Utils::Shader::ShaderStage::Fragment:
                             shaderStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+                            break;
+                        case Utils::Shader::ShaderStage::Compute:
+                            shaderStage = VK_SHADER_STAGE_COMPUTE_BIT;
+                            break;
                         default: break;
                         }
 
@@ -402,6 +670,19 @@ namespace GyroEngine::Resources
                     binding.type = ToVkDescriptorType(spvBinding->descriptor_type);
                     binding.name = spvBinding->name ? spvBinding->name : "UNKNOWN SET";
 
+                    // SPIR-V has no notion of dynamic buffers, so promote the bindings that were requested as dynamic
+                    if (std::find(m_dynamicBindings.begin(), m_dynamicBindings.end(), binding.name) != m_dynamicBindings.end())
+                    {
+                        if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                        {
+                            binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                        }
+                        else if (binding.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                        {
+                            binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+                        }
+                    }
+
                     switch (stage->GetShaderStage())
                     {
                     case Utils::Shader::ShaderStage::Vertex:
@@ -410,6 +691,9 @@ namespace GyroEngine::Resources
                     case Utils::Shader::ShaderStage::Fragment:
                         binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
                         break;
+                    case Utils::Shader::ShaderStage::Compute:
+                        binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                        break;
                     default:
                         binding.stageFlags = VK_SHADER_STAGE_ALL;
                         break;
@@ -417,7 +701,7 @@ namespace GyroEngine::Resources
 
                     // Create layout binding
                     binding.layoutBinding.binding = spvBinding->binding;
-                    binding.layoutBinding.descriptorType = ToVkDescriptorType(spvBinding->descriptor_type);
+                    binding.layoutBinding.descriptorType = binding.type;
                     binding.layoutBinding.descriptorCount = spvBinding->count;
                     binding.layoutBinding.stageFlags = binding.stageFlags;
 
@@ -507,6 +791,9 @@ namespace GyroEngine::Resources
                 case Utils::Shader::ShaderStage::Fragment:
                     stageFlag = VK_SHADER_STAGE_FRAGMENT_BIT;
                     break;
+                case Utils::Shader::ShaderStage::Compute:
+                    stageFlag = VK_SHADER_STAGE_COMPUTE_BIT;
+                    break;
                 default:
                     stageFlag = VK_SHADER_STAGE_ALL;
                     break;
@@ -535,7 +822,6 @@ namespace GyroEngine::Resources
                         pushConstantMember.name = member->name ? member->name : "";
                         pushConstantMember.offset = member->offset;
                         pushConstantMember.size = member->size;
-                        pushConstantMember.data = nullptr;
                         pushConstantBlock.members.push_back(pushConstantMember);
                     }
 
@@ -556,18 +842,11 @@ namespace GyroEngine::Resources
 
     void PipelineBindings::DestroyPushConstantRanges()
     {
-        // Enumerate through all push constants and free data from the members
+        // Enumerate through all push constants and drop their values
         for (auto& pushConstant : m_pushConstants)
         {
-            for (auto& member : pushConstant.members)
-            {
-                if (member.data)
-                {
-                    free(member.data);
-                    member.data = nullptr;
-                }
-            }
             pushConstant.members.clear();
+            pushConstant.data.clear();
         }
     }
 
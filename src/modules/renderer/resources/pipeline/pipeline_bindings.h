@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -15,6 +16,7 @@
 #include "../texture/image.h"
 #include "../texture/sampler.h"
 #include "shader.h"
+#include "types.h"
 
 namespace GyroEngine::Rendering
 {
@@ -36,10 +38,37 @@ namespace GyroEngine::Resources
             uint32_t binding = 0;
             VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
             VkShaderStageFlags stageFlags = VK_SHADER_STAGE_ALL;
+            uint32_t dynamicOffset = 0;
 
             VkDescriptorSetLayoutBinding layoutBinding = {};
         };
 
+        struct BufferWrite
+        {
+            std::weak_ptr<Buffer> source;
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize range = 0;
+        };
+
+        struct ImageWrite
+        {
+            std::weak_ptr<Image> source;
+            SamplerHandle sampler;
+            VkImageView imageView = VK_NULL_HANDLE;
+            VkImageLayout imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        /// @brief What was last bound at a set number, shared since every pipeline binds on the same commands
+        struct BoundSet
+        {
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_MAX_ENUM;
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            std::vector<uint32_t> dynamicOffsets;
+        };
+
         struct AllocatedSet
         {
             VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
@@ -61,7 +90,6 @@ namespace GyroEngine::Resources
             std::string name;
             uint32_t offset = 0;
             uint32_t size = 0;
-            void* data;
         };
 
         struct PushConstantBlock
@@ -72,6 +100,8 @@ namespace GyroEngine::Resources
             VkShaderStageFlags stageFlags = VK_SHADER_STAGE_ALL;
 
             std::vector<PushConstantMember> members;
+            /// @brief Values pushed by BindConstants, empty until a member is updated
+            std::vector<uint8_t> data;
         };
     public:
         struct VertexInput
@@ -83,6 +113,10 @@ namespace GyroEngine::Resources
             VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
         };
 
+        /// @brief Per-object uniform meshes stream through the frame's uniform allocator, always created dynamic
+        /// @note So its descriptor is written once per frame in flight and every object only binds its own offset
+        static constexpr const char* ObjectBinding = "mvp";
+
         explicit PipelineBindings(Device::RenderingDevice& device) : m_device(device) {}
         ~PipelineBindings() { Cleanup(); }
 
@@ -92,17 +126,75 @@ namespace GyroEngine::Resources
             return *this;
         }
 
+        /// @brief Creates the binding as a dynamic uniform/storage buffer, must be called before Init
+        PipelineBindings& SetDynamicBinding(const std::string& name)
+        {
+            m_dynamicBindings.push_back(name);
+            return *this;
+        }
+
+        /// @brief Shares the device's bindless heap as set 0 instead of reflecting it, must be called before Init
+        /// @note Shaders then reach textures, samplers and storage buffers through heap indices, and push constants use
+        /// the heap's fixed range
+        PipelineBindings& UseBindless(const bool bindless = true)
+        {
+            m_bindless = bindless;
+            return *this;
+        }
+
+        /// @brief Vertex shaders fetch their vertices from the bindless heap by gl_VertexIndex, must be called before Init
+        /// @note Requires UseBindless. The pipeline has no vertex input state, so meshes in any vertex format can be
+        /// drawn with it, each picking its format through Mesh::UseVertexFormat
+        PipelineBindings& UseVertexPulling(const bool pull = true)
+        {
+            m_vertexPulling = pull;
+            return *this;
+        }
+
+        /// @brief Reads full vertices as a position stream and an attribute stream, must be called before Init
+        /// @note Meshes using the pipeline then store VertexFormat::Split, and passes reading only positions bind only
+        /// the position stream. Pipelines drawing the same meshes should agree on it
+        PipelineBindings& SplitVertexStreams(const bool split = true)
+        {
+            m_splitVertexStreams = split;
+            return *this;
+        }
+
         bool Init();
         void Cleanup();
 
-        void UpdateDescriptorBuffer(const std::string& name, const BufferHandle& buffer, uint32_t index);
+        /// @note Writes are skipped when the descriptor already points at the same buffer range
+        void UpdateDescriptorBuffer(const std::string& name, const BufferHandle& buffer, uint32_t index,
+                                    VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        void SetDynamicOffset(const std::string& name, uint32_t offset);
+        /// @note Writes are skipped when the descriptor already points at the same image view
         void UpdateDescriptorImage(const std::string& name, const SamplerHandle& sampler, const ImageHandle& image, uint32_t index);
         void UpdatePushConstant(const std::string& block, const std::string& name, const void* data, size_t size, uint32_t offset = 0);
+        /// @brief Writes the buffer's device address into a 64-bit pointer member, e.g. a buffer_reference in GLSL
+        void UpdatePushConstantAddress(const std::string& block, const std::string& name, const BufferHandle& buffer,
+                                       VkDeviceSize offset = 0);
 
+        /// @brief Pushes every block that had a member updated
         void BindConstants(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout);
-        void Bind(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout);
+        /// @note Sets still bound on the command buffer through the same layout and offsets aren't bound again
+        void Bind(const Rendering::FrameContext& frameContext, VkPipelineLayout pipelineLayout,
+                  VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        /// @brief Forgets which sets are bound, command buffers are recorded from scratch every frame
+        static void BeginFrame();
 
+        [[nodiscard]] bool IsBindless() const { return m_bindless; }
+        [[nodiscard]] bool UsesVertexPulling() const { return m_bindless && m_vertexPulling; }
+        /// @brief Whether the bindings were made for a compute shader instead of a graphics pipeline
+        [[nodiscard]] bool IsCompute() const
+        {
+            return std::any_of(m_shaderStages.begin(), m_shaderStages.end(), [](const ShaderHandle& shader)
+            {
+                return shader->GetShaderStage() == Utils::Shader::ShaderStage::Compute;
+            });
+        }
         bool DoesBindingExist(const std::string& name) { return GetBinding(name).has_value(); }
+        bool IsDynamicBinding(const std::string& name);
         bool DoesPushConstantExist(const std::string& block, const std::string& name) { return GetPushConstant(block, name).has_value(); }
 
         [[nodiscard]] std::vector<ShaderHandle>& GetShaderStages()
@@ -125,6 +217,26 @@ namespace GyroEngine::Resources
             return m_vertexInputs;
         }
 
+        /// @brief Vertex format the vertex shader was written for, deduced from its reflected inputs
+        /// @note A two component normal means the shader decodes octahedral normals, i.e. it expects packed vertices.
+        /// Full vertices become Split when SplitVertexStreams was set
+        [[nodiscard]] Types::VertexFormat GetVertexFormat() const
+        {
+            return m_vertexFormat;
+        }
+
+        /// @brief Vertex buffer bindings the vertex shader reads, validated against its reflected inputs
+        [[nodiscard]] const std::vector<VkVertexInputBindingDescription>& GetVertexBindingDescriptions() const
+        {
+            return m_vertexBindingDescriptions;
+        }
+
+        /// @brief Attributes of the vertex format at the vertex shader's input locations
+        [[nodiscard]] const std::vector<VkVertexInputAttributeDescription>& GetVertexAttributeDescriptions() const
+        {
+            return m_vertexAttributeDescriptions;
+        }
+
         [[nodiscard]] std::vector<std::shared_ptr<Set>> GetSets()
         {
             return m_sets;
@@ -136,12 +248,28 @@ namespace GyroEngine::Resources
         std::vector<ShaderHandle> m_shaderStages;
         std::vector<PushConstantBlock> m_pushConstants;
         std::vector<VertexInput> m_vertexInputs;
+        std::vector<VkVertexInputBindingDescription> m_vertexBindingDescriptions;
+        std::vector<VkVertexInputAttributeDescription> m_vertexAttributeDescriptions;
         std::vector<std::shared_ptr<Set>> m_sets;
         std::unordered_map<ShaderHandle, SpvReflectShaderModule> m_spvModules;
+        std::vector<std::string> m_dynamicBindings = {ObjectBinding};
+        std::unordered_map<std::string, std::vector<BufferWrite>> m_bufferWrites;
+        std::unordered_map<std::string, std::vector<ImageWrite>> m_imageWrites;
+        std::vector<uint64_t> m_relocationGenerations;
+        bool m_bindless = false;
+        bool m_splitVertexStreams = false;
+        bool m_vertexPulling = false;
+        Types::VertexFormat m_vertexFormat = Types::VertexFormat::Full;
+
+        /// @brief Indexed by set number
+        static std::vector<BoundSet> s_boundSets;
 
         std::optional<std::pair<Set, Binding>> GetBinding(const std::string& name);
         std::optional<std::pair<PushConstantBlock, PushConstantMember>> GetPushConstant(const std::string& block, const std::string& name);
 
+        /// @brief Rewrites the frame's descriptors whose buffers or images were moved by the defragmenter
+        void RefreshRelocatedDescriptors(uint32_t frameIndex);
+
         bool CreateSpvModules();
         void DestroySpvModules();
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
 #include <volk.h>
 
@@ -15,6 +16,25 @@ using namespace GyroEngine;
 
 namespace GyroEngine::Resources
 {
+    /// @brief Per-draw push constants of the bindless pipelines, mirrors DrawConstants in the bindless shaders
+    /// @note Buffer fields are bindless heap indices, offsets are counted in vec4s. The vertex fields are only read by
+    /// pipelines pulling their vertices, see PipelineBindings::UseVertexPulling
+    struct DrawConstants
+    {
+        uint32_t objectBuffer = UINT32_MAX;
+        uint32_t objectOffset = 0;
+        uint32_t materialBuffer = UINT32_MAX;
+        uint32_t materialIndex = 0;
+        /// @brief Heap index of the vertices, the positions for split vertices
+        uint32_t vertexBuffer = UINT32_MAX;
+        /// @brief Heap index of the attribute stream of split vertices
+        uint32_t attributeBuffer = UINT32_MAX;
+        /// @brief Types::VertexFormat the vertices are stored in
+        uint32_t vertexFormat = 0;
+        /// @brief Added to gl_VertexIndex, e.g. where the mesh starts in a shared geometry buffer
+        uint32_t baseVertex = 0;
+    };
+
     class PushConstant {
     public:
         PushConstant& SetSize(const uint32_t size) {
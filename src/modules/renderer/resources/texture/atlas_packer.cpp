@@ -0,0 +1,211 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "atlas_packer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace GyroEngine::Resources
+{
+    namespace
+    {
+        bool Contains(const AtlasRect& outer, const AtlasRect& inner)
+        {
+            return inner.x >= outer.x && inner.y >= outer.y &&
+                   inner.x + inner.width <= outer.x + outer.width &&
+                   inner.y + inner.height <= outer.y + outer.height;
+        }
+
+        bool Overlaps(const AtlasRect& a, const AtlasRect& b)
+        {
+            return a.x < b.x + b.width && b.x < a.x + a.width &&
+                   a.y < b.y + b.height && b.y < a.y + a.height;
+        }
+    }
+
+    AtlasPacker& AtlasPacker::SetSize(const uint32_t width, const uint32_t height)
+    {
+        m_width = width;
+        m_height = height;
+        Reset();
+        return *this;
+    }
+
+    AtlasPacker& AtlasPacker::SetAlignment(const uint32_t alignment)
+    {
+        m_alignment = std::max(alignment, 1u);
+        Reset();
+        return *this;
+    }
+
+    void AtlasPacker::Reset()
+    {
+        m_usedArea = 0;
+        m_freeRects.clear();
+        // The area is trimmed to the alignment so free rects never end off the grid
+        const uint32_t width = m_width & ~(m_alignment - 1);
+        const uint32_t height = m_height & ~(m_alignment - 1);
+        if (width > 0 && height > 0)
+        {
+            m_freeRects.push_back({0, 0, width, height});
+        }
+    }
+
+    bool AtlasPacker::Insert(const uint32_t width, const uint32_t height, AtlasRect& rect)
+    {
+        if (width == 0 || height == 0)
+        {
+            return false;
+        }
+        const uint32_t alignedWidth = (width + m_alignment - 1) & ~(m_alignment - 1);
+        const uint32_t alignedHeight = (height + m_alignment - 1) & ~(m_alignment - 1);
+
+        // Best short side fit, ties go to the best long side fit
+        const AtlasRect* best = nullptr;
+        uint32_t bestShortSide = std::numeric_limits<uint32_t>::max();
+        uint32_t bestLongSide = std::numeric_limits<uint32_t>::max();
+        for (const AtlasRect& freeRect : m_freeRects)
+        {
+            if (freeRect.width < alignedWidth || freeRect.height < alignedHeight)
+            {
+                continue;
+            }
+            const uint32_t leftoverWidth = freeRect.width - alignedWidth;
+            const uint32_t leftoverHeight = freeRect.height - alignedHeight;
+            const uint32_t shortSide = std::min(leftoverWidth, leftoverHeight);
+            const uint32_t longSide = std::max(leftoverWidth, leftoverHeight);
+            if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                best = &freeRect;
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+            }
+        }
+        if (!best)
+        {
+            return false;
+        }
+
+        rect = {best->x, best->y, alignedWidth, alignedHeight};
+        SplitFreeRects(rect);
+        PruneFreeRects();
+        m_usedArea += static_cast<uint64_t>(alignedWidth) * alignedHeight;
+        return true;
+    }
+
+    void AtlasPacker::Remove(const AtlasRect& rect)
+    {
+        const uint64_t area = static_cast<uint64_t>(rect.width) * rect.height;
+        m_usedArea -= std::min(area, m_usedArea);
+        if (m_usedArea == 0)
+        {
+            Reset();
+            return;
+        }
+        m_freeRects.push_back(rect);
+        MergeFreeRects();
+        PruneFreeRects();
+    }
+
+    float AtlasPacker::GetOccupancy() const
+    {
+        const uint64_t area = static_cast<uint64_t>(m_width) * m_height;
+        return area > 0 ? static_cast<float>(static_cast<double>(m_usedArea) / static_cast<double>(area)) : 0.0f;
+    }
+
+    void AtlasPacker::SplitFreeRects(const AtlasRect& used)
+    {
+        std::vector<AtlasRect> split;
+        for (auto it = m_freeRects.begin(); it != m_freeRects.end();)
+        {
+            if (!Overlaps(*it, used))
+            {
+                ++it;
+                continue;
+            }
+            // The parts of the free rect on each side of used, each as large as it can be
+            const AtlasRect freeRect = *it;
+            if (used.x > freeRect.x)
+            {
+                split.push_back({freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.height});
+            }
+            if (used.x + used.width < freeRect.x + freeRect.width)
+            {
+                split.push_back({
+                    used.x + used.width, freeRect.y,
+                    freeRect.x + freeRect.width - (used.x + used.width), freeRect.height
+                });
+            }
+            if (used.y > freeRect.y)
+            {
+                split.push_back({freeRect.x, freeRect.y, freeRect.width, used.y - freeRect.y});
+            }
+            if (used.y + used.height < freeRect.y + freeRect.height)
+            {
+                split.push_back({
+                    freeRect.x, used.y + used.height,
+                    freeRect.width, freeRect.y + freeRect.height - (used.y + used.height)
+                });
+            }
+            it = m_freeRects.erase(it);
+        }
+        m_freeRects.insert(m_freeRects.end(), split.begin(), split.end());
+    }
+
+    void AtlasPacker::PruneFreeRects()
+    {
+        for (size_t i = 0; i < m_freeRects.size(); ++i)
+        {
+            for (size_t j = i + 1; j < m_freeRects.size();)
+            {
+                if (Contains(m_freeRects[i], m_freeRects[j]))
+                {
+                    m_freeRects.erase(m_freeRects.begin() + static_cast<std::ptrdiff_t>(j));
+                    continue;
+                }
+                if (Contains(m_freeRects[j], m_freeRects[i]))
+                {
+                    m_freeRects.erase(m_freeRects.begin() + static_cast<std::ptrdiff_t>(i));
+                    --i;
+                    break;
+                }
+                ++j;
+            }
+        }
+    }
+
+    void AtlasPacker::MergeFreeRects()
+    {
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (size_t i = 0; i < m_freeRects.size() && !merged; ++i)
+            {
+                for (size_t j = i + 1; j < m_freeRects.size() && !merged; ++j)
+                {
+                    AtlasRect& a = m_freeRects[i];
+                    const AtlasRect& b = m_freeRects[j];
+                    if (a.x == b.x && a.width == b.width && (a.y + a.height == b.y || b.y + b.height == a.y))
+                    {
+                        a.y = std::min(a.y, b.y);
+                        a.height += b.height;
+                        merged = true;
+                    }
+                    else if (a.y == b.y && a.height == b.height && (a.x + a.width == b.x || b.x + b.width == a.x))
+                    {
+                        a.x = std::min(a.x, b.x);
+                        a.width += b.width;
+                        merged = true;
+                    }
+                    if (merged)
+                    {
+                        m_freeRects.erase(m_freeRects.begin() + static_cast<std::ptrdiff_t>(j));
+                    }
+                }
+            }
+        }
+    }
+}
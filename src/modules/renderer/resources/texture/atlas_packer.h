@@ -0,0 +1,66 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace GyroEngine::Resources
+{
+    struct AtlasRect
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    /// @brief Places rects in an area with MaxRects, picking the free rect that leaves the shortest side
+    /// @note Sizes are rounded up to the alignment, so every placement is aligned too. Removed rects go back to the
+    /// free list and are merged with the free rects they share an edge with
+    class AtlasPacker
+    {
+    public:
+        AtlasPacker& SetSize(uint32_t width, uint32_t height);
+        /// @brief Grid placements snap to, a power of two
+        AtlasPacker& SetAlignment(uint32_t alignment);
+
+        /// @brief Frees the whole area
+        void Reset();
+
+        /// @brief Finds room for a rect, rect receives its aligned placement
+        bool Insert(uint32_t width, uint32_t height, AtlasRect& rect);
+
+        /// @brief Frees a rect Insert placed
+        void Remove(const AtlasRect& rect);
+
+        /// @brief Share of the area in use, alignment padding included
+        [[nodiscard]] float GetOccupancy() const;
+
+        [[nodiscard]] bool IsEmpty() const
+        {
+            return m_usedArea == 0;
+        }
+
+        [[nodiscard]] uint32_t GetAlignment() const
+        {
+            return m_alignment;
+        }
+    private:
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_alignment = 1;
+        uint64_t m_usedArea = 0;
+        /// @brief Maximal free rects, they may overlap each other
+        std::vector<AtlasRect> m_freeRects;
+
+        /// @brief Cuts used out of every free rect overlapping it
+        void SplitFreeRects(const AtlasRect& used);
+        /// @brief Drops free rects contained in another one
+        void PruneFreeRects();
+        /// @brief Joins free rects sharing a whole edge until none do
+        void MergeFreeRects();
+    };
+}
@@ -4,6 +4,11 @@
 
 #include "image.h"
 
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include "../buffer/buffer.h"
 #include "context/rendering_device.h"
 #include "utilities/renderer.h"
@@ -82,6 +87,18 @@ namespace GyroEngine::Resources
         return *this;
     }
 
+    Image &Image::SetCategory(const Device::MemoryCategory category)
+    {
+        m_category = category;
+        return *this;
+    }
+
+    Image &Image::SetDebugName(const std::string &name)
+    {
+        m_debugName = name;
+        return *this;
+    }
+
     bool Image::Init(VkImage externalImage, VkImageView imageView)
     {
         if (externalImage != VK_NULL_HANDLE && imageView != VK_NULL_HANDLE)
@@ -105,6 +122,11 @@ namespace GyroEngine::Resources
 
     void Image::Cleanup()
     {
+        if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+        {
+            m_device.GetBindlessHeap().ReleaseImage(m_bindlessIndex);
+            m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+        }
         DestroyImage();
         DestroyImageView();
     }
@@ -236,7 +258,433 @@ namespace GyroEngine::Resources
         MoveToLayout(oldLayout);
     }
 
-    bool Image::CreateImage()
+    void Image::CopyFromBuffer(VkBuffer buffer, const std::vector<VkBufferImageCopy> &regions)
+    {
+        if (regions.empty())
+        {
+            return;
+        }
+        VkImageLayout oldLayout = m_imageLayout;
+        MakeTransferDst();
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer commandBuffer)
+            {
+                vkCmdCopyBufferToImage(commandBuffer, buffer, m_image, m_imageLayout,
+                                       static_cast<uint32_t>(regions.size()), regions.data());
+            }
+        );
+        MoveToLayout(oldLayout);
+    }
+
+    bool Image::GenerateMipmaps()
+    {
+        if (m_mipLevels <= 1)
+        {
+            return true;
+        }
+        if (!CanBlitMipmaps())
+        {
+            Logger::LogError("Image {} can't blit its mip chain", m_debugName);
+            return false;
+        }
+
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer commandBuffer)
+            {
+                RecordMipmaps(commandBuffer);
+            }
+        );
+        return true;
+    }
+
+    bool Image::CanBlitMipmaps() const
+    {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(m_device.GetPhysicalDevice(), m_format, &formatProperties);
+        constexpr VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures &&
+               (m_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) && (m_usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    }
+
+    void Image::RecordMipmaps(VkCommandBuffer cmd)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = m_image;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = m_aspectMask;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = m_arrayLayers;
+
+        // The first level keeps its texels, the others are overwritten
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.oldLayout = m_imageLayout;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        VkImageMemoryBarrier chainBarrier = barrier;
+        chainBarrier.subresourceRange.baseMipLevel = 1;
+        chainBarrier.subresourceRange.levelCount = m_mipLevels - 1;
+        chainBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        chainBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        chainBarrier.srcAccessMask = 0;
+        chainBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        const VkImageMemoryBarrier initialBarriers[2] = {barrier, chainBarrier};
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 2, initialBarriers);
+
+        int32_t width = static_cast<int32_t>(m_extent.width);
+        int32_t height = static_cast<int32_t>(m_extent.height);
+        for (uint32_t mip = 1; mip < m_mipLevels; ++mip)
+        {
+            const int32_t mipWidth = std::max(1, width / 2);
+            const int32_t mipHeight = std::max(1, height / 2);
+
+            VkImageBlit blit{};
+            blit.srcSubresource = {m_aspectMask, mip - 1, 0, m_arrayLayers};
+            blit.srcOffsets[1] = {width, height, 1};
+            blit.dstSubresource = {m_aspectMask, mip, 0, m_arrayLayers};
+            blit.dstOffsets[1] = {mipWidth, mipHeight, 1};
+            vkCmdBlitImage(cmd, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            // The level just written is the source of the next one
+            barrier.subresourceRange.baseMipLevel = mip;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            width = mipWidth;
+            height = mipHeight;
+        }
+
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = m_mipLevels;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             Utils::Image::GetDestinationStageFlags(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    void Image::RecordLayout(VkCommandBuffer cmd, const VkImageLayout newLayout)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = m_image;
+        barrier.oldLayout = m_imageLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcAccessMask = Utils::Image::GetSourceAccessMask(m_imageLayout);
+        barrier.dstAccessMask = Utils::Image::GetDestinationAccessMask(newLayout);
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = {m_aspectMask, 0, m_mipLevels, 0, m_arrayLayers};
+        vkCmdPipelineBarrier(cmd, Utils::Image::GetSourceStageFlags(m_imageLayout),
+                             Utils::Image::GetDestinationStageFlags(newLayout), 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        m_imageLayout = newLayout;
+    }
+
+    bool Image::UploadAreas(const std::vector<ImageArea> &areas)
+    {
+        if (areas.empty())
+        {
+            return true;
+        }
+        const bool generateMips = m_mipLevels > 1;
+        if (generateMips && !CanBlitMipmaps())
+        {
+            Logger::LogError("Image {} can't blit its mip chain", m_debugName);
+            return false;
+        }
+
+        std::vector<VkBufferImageCopy> regions;
+        regions.reserve(areas.size());
+        VkDeviceSize size = 0;
+        for (const ImageArea &area : areas)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset = size;
+            region.imageSubresource = {m_aspectMask, 0, area.layer, 1};
+            region.imageOffset = {area.rect.offset.x, area.rect.offset.y, 0};
+            region.imageExtent = {area.rect.extent.width, area.rect.extent.height, 1};
+            regions.push_back(region);
+            size += area.texels.size();
+        }
+
+        Buffer staging(m_device);
+        staging.SetSize(size)
+               .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+               .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+               .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+               .SetPersistentMapping(true)
+               .SetCategory(Device::MemoryCategory::Staging)
+               .SetDebugName(m_debugName + " staging");
+        if (!staging.Init())
+        {
+            Logger::LogError("Failed to create the staging buffer of image {}", m_debugName);
+            return false;
+        }
+        for (size_t i = 0; i < areas.size(); ++i)
+        {
+            staging.Write(regions[i].bufferOffset, areas[i].texels.data(), areas[i].texels.size());
+        }
+        staging.Flush();
+
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer commandBuffer)
+            {
+                // Coming from the shader layout keeps the texels outside the areas
+                RecordLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                vkCmdCopyBufferToImage(commandBuffer, staging.GetBuffer(), m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       static_cast<uint32_t>(regions.size()), regions.data());
+                if (generateMips)
+                {
+                    for (const ImageArea &area : areas)
+                    {
+                        RecordAreaMipmaps(commandBuffer, area.rect, area.layer);
+                    }
+                }
+                RecordLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+        );
+        return true;
+    }
+
+    void Image::RecordAreaMipmaps(VkCommandBuffer cmd, const VkRect2D &area, const uint32_t layer)
+    {
+        const auto getLevelArea = [&area](const uint32_t level)
+        {
+            const VkOffset3D offset = {area.offset.x >> level, area.offset.y >> level, 0};
+            const VkOffset3D end = {
+                offset.x + static_cast<int32_t>(std::max(area.extent.width >> level, 1u)),
+                offset.y + static_cast<int32_t>(std::max(area.extent.height >> level, 1u)), 1
+            };
+            return std::make_pair(offset, end);
+        };
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = m_image;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = {m_aspectMask, 0, 1, layer, 1};
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        for (uint32_t mip = 1; mip < m_mipLevels; ++mip)
+        {
+            VkImageBlit blit{};
+            blit.srcSubresource = {m_aspectMask, mip - 1, layer, 1};
+            std::tie(blit.srcOffsets[0], blit.srcOffsets[1]) = getLevelArea(mip - 1);
+            blit.dstSubresource = {m_aspectMask, mip, layer, 1};
+            std::tie(blit.dstOffsets[0], blit.dstOffsets[1]) = getLevelArea(mip);
+            vkCmdBlitImage(cmd, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            barrier.subresourceRange.baseMipLevel = mip;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        // The layer's levels go back to the layout the rest of the image is in
+        barrier.subresourceRange = {m_aspectMask, 0, m_mipLevels, layer, 1};
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkImageView Image::CreateMipView(const uint32_t mipLevel, const VkFormat format) const
+    {
+        VkImageViewCreateInfo imageViewInfo{};
+        imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewInfo.image = m_image;
+        imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewInfo.format = format;
+        imageViewInfo.subresourceRange.aspectMask = m_aspectMask;
+        imageViewInfo.subresourceRange.baseMipLevel = mipLevel;
+        imageViewInfo.subresourceRange.levelCount = 1;
+        imageViewInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView imageView = VK_NULL_HANDLE;
+        if (vkCreateImageView(m_device.GetLogicalDevice(), &imageViewInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            return VK_NULL_HANDLE;
+        }
+        return imageView;
+    }
+
+    uint32_t Image::RegisterBindless(const VkImageLayout layout)
+    {
+        if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+        {
+            return m_bindlessIndex;
+        }
+        if (m_imageView == VK_NULL_HANDLE || !(m_usage & VK_IMAGE_USAGE_SAMPLED_BIT))
+        {
+            Logger::LogError("Only initialized sampled images can be registered in the bindless heap");
+            return Device::BindlessHeap::InvalidIndex;
+        }
+        m_bindlessLayout = layout;
+        m_bindlessIndex = m_device.GetBindlessHeap().RegisterImage(m_imageView, m_bindlessLayout);
+        return m_bindlessIndex;
+    }
+
+    uint32_t Image::TakeBindlessIndex(Image &other)
+    {
+        if (other.m_bindlessIndex == Device::BindlessHeap::InvalidIndex)
+        {
+            return RegisterBindless(other.m_bindlessLayout);
+        }
+        if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+        {
+            m_device.GetBindlessHeap().ReleaseImage(m_bindlessIndex);
+        }
+        m_bindlessIndex = other.m_bindlessIndex;
+        m_bindlessLayout = other.m_bindlessLayout;
+        other.m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+        m_device.GetBindlessHeap().UpdateImage(m_bindlessIndex, m_imageView, m_bindlessLayout);
+        return m_bindlessIndex;
+    }
+
+    bool Image::CanRelocate() const
+    {
+        return !m_isExternal && m_image != VK_NULL_HANDLE && m_imageLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+               IsRelocatableUsage();
+    }
+
+    bool Image::RecordRelocation(VkCommandBuffer cmd, VmaAllocation dstAllocation)
+    {
+        VkImageCreateInfo imageInfo = GetCreateInfo();
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(m_device.GetLogicalDevice(), &imageInfo, nullptr, &m_pendingImage) != VK_SUCCESS)
+        {
+            m_pendingImage = VK_NULL_HANDLE;
+            return false;
+        }
+        if (vmaBindImageMemory(m_device.GetAllocator(), dstAllocation, m_pendingImage) != VK_SUCCESS)
+        {
+            AbortRelocation();
+            return false;
+        }
+        m_pendingImageView = CreateView(m_pendingImage);
+        if (m_pendingImageView == VK_NULL_HANDLE)
+        {
+            AbortRelocation();
+            return false;
+        }
+
+        VkImageMemoryBarrier barriers[2] = {};
+        for (auto& barrier : barriers)
+        {
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask = m_aspectMask;
+            barrier.subresourceRange.levelCount = m_mipLevels;
+            barrier.subresourceRange.layerCount = m_arrayLayers;
+        }
+
+        // Old image is only read, so it goes back to its layout for the frames that still sample it
+        barriers[0].image = m_image;
+        barriers[0].oldLayout = m_imageLayout;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[1].image = m_pendingImage;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 2, barriers);
+
+        std::vector<VkImageCopy> regions(m_mipLevels);
+        for (uint32_t mip = 0; mip < m_mipLevels; ++mip)
+        {
+            VkImageCopy& region = regions[mip];
+            region.srcSubresource.aspectMask = m_aspectMask;
+            region.srcSubresource.mipLevel = mip;
+            region.srcSubresource.baseArrayLayer = 0;
+            region.srcSubresource.layerCount = m_arrayLayers;
+            region.dstSubresource = region.srcSubresource;
+            region.extent.width = std::max(1u, m_extent.width >> mip);
+            region.extent.height = std::max(1u, m_extent.height >> mip);
+            region.extent.depth = std::max(1u, m_extent.depth >> mip);
+        }
+        vkCmdCopyImage(cmd, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       m_pendingImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       static_cast<uint32_t>(regions.size()), regions.data());
+
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[0].newLayout = m_imageLayout;
+        barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].newLayout = m_imageLayout;
+        barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, 2, barriers);
+        return true;
+    }
+
+    std::function<void()> Image::CommitRelocation()
+    {
+        VkImage oldImage = m_image;
+        VkImageView oldImageView = m_imageView;
+        m_image = m_pendingImage;
+        m_imageView = m_pendingImageView;
+        m_pendingImage = VK_NULL_HANDLE;
+        m_pendingImageView = VK_NULL_HANDLE;
+        m_device.GetBindlessHeap().UpdateImage(m_bindlessIndex, m_imageView, m_bindlessLayout);
+
+        VkDevice device = m_device.GetLogicalDevice();
+        return [device, oldImage, oldImageView]
+        {
+            vkDestroyImageView(device, oldImageView, nullptr);
+            vkDestroyImage(device, oldImage, nullptr);
+        };
+    }
+
+    void Image::AbortRelocation()
+    {
+        if (m_pendingImageView != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_device.GetLogicalDevice(), m_pendingImageView, nullptr);
+            m_pendingImageView = VK_NULL_HANDLE;
+        }
+        if (m_pendingImage != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_device.GetLogicalDevice(), m_pendingImage, nullptr);
+            m_pendingImage = VK_NULL_HANDLE;
+        }
+    }
+
+    VkImageCreateInfo Image::GetCreateInfo() const
     {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -252,22 +700,28 @@ namespace GyroEngine::Resources
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.flags = m_createFlags;
 
-        VmaAllocationCreateInfo allocInfo{};
-        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-
-        if (vmaCreateImage(m_device.GetAllocator(), &imageInfo, &allocInfo, &m_image, &m_allocation, nullptr) !=
-            VK_SUCCESS)
+        // Images the defragmenter may move need to be both the source and the destination of a copy
+        if (IsRelocatableUsage())
         {
-            return false;
+            imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         }
-        return true;
+        return imageInfo;
     }
 
-    bool Image::CreateImageView()
+    bool Image::IsRelocatableUsage() const
+    {
+        // Attachments and storage images are written every frame, a copy would miss those writes
+        constexpr VkImageUsageFlags writtenUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                   VK_IMAGE_USAGE_STORAGE_BIT;
+        return !(m_usage & writtenUsage) && m_samples == VK_SAMPLE_COUNT_1_BIT && m_tiling == VK_IMAGE_TILING_OPTIMAL;
+    }
+
+    VkImageView Image::CreateView(VkImage image) const
     {
         VkImageViewCreateInfo imageViewInfo{};
         imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        imageViewInfo.image = m_image;
+        imageViewInfo.image = image;
         imageViewInfo.viewType = m_viewType;
         imageViewInfo.format = m_format;
         imageViewInfo.subresourceRange.aspectMask = m_aspectMask;
@@ -276,19 +730,61 @@ namespace GyroEngine::Resources
         imageViewInfo.subresourceRange.baseArrayLayer = 0;
         imageViewInfo.subresourceRange.layerCount = m_arrayLayers;
 
-        if (vkCreateImageView(m_device.GetLogicalDevice(), &imageViewInfo, nullptr, &m_imageView) != VK_SUCCESS)
+        // sRGB views can't be storage views, that usage is left to views of the image as another format
+        VkImageViewUsageCreateInfo usageInfo{};
+        usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+        usageInfo.usage = m_usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
+        if ((m_createFlags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) && (m_usage & VK_IMAGE_USAGE_STORAGE_BIT) &&
+            Utils::Image::IsSrgbFormat(m_format))
+        {
+            imageViewInfo.pNext = &usageInfo;
+        }
+
+        VkImageView imageView = VK_NULL_HANDLE;
+        if (vkCreateImageView(m_device.GetLogicalDevice(), &imageViewInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            return VK_NULL_HANDLE;
+        }
+        return imageView;
+    }
+
+    bool Image::CreateImage()
+    {
+        const VkImageCreateInfo imageInfo = GetCreateInfo();
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+
+        if (vmaCreateImage(m_device.GetAllocator(), &imageInfo, &allocInfo, &m_image, &m_allocation, nullptr) !=
+            VK_SUCCESS)
         {
             return false;
         }
+        m_device.GetMemoryTracker().Track(m_allocation, m_category, m_debugName);
+        vmaSetAllocationUserData(m_device.GetAllocator(), m_allocation, static_cast<Device::DefragmentationTarget*>(this));
         return true;
     }
 
+    bool Image::CreateImageView()
+    {
+        m_imageView = CreateView(m_image);
+        return m_imageView != VK_NULL_HANDLE;
+    }
+
     void Image::DestroyImage()
     {
         if (m_isExternal) { return; }
         if (m_image != VK_NULL_HANDLE)
         {
-            vmaDestroyImage(m_device.GetAllocator(), m_image, m_allocation);
+            m_device.GetMemoryTracker().Untrack(m_allocation);
+            if (m_device.GetDefragmenter().Release(m_allocation))
+            {
+                // Mid-move, the defragmenter frees the allocation when its pass ends
+                vkDestroyImage(m_device.GetLogicalDevice(), m_image, nullptr);
+            } else
+            {
+                vmaDestroyImage(m_device.GetAllocator(), m_image, m_allocation);
+            }
             m_image = VK_NULL_HANDLE;
             m_allocation = VK_NULL_HANDLE;
         }
@@ -5,9 +5,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <volk.h>
 
 #include "../../implementation/vma_implementation.h"
+#include "context/memory_tracker.h"
+#include "context/defragmenter.h"
+#include "context/bindless_heap.h"
 #include "utilities/device.h"
 
 #include "utilities/image.h"
@@ -21,7 +26,15 @@ using namespace GyroEngine;
 
 namespace GyroEngine::Resources
 {
-    class Image
+    /// @brief Tightly packed texels for one area of an image's first level
+    struct ImageArea
+    {
+        VkRect2D rect = {};
+        uint32_t layer = 0;
+        std::vector<uint8_t> texels;
+    };
+
+    class Image : public Device::DefragmentationTarget
     {
     public:
         explicit Image(Device::RenderingDevice &device) : m_device(device)
@@ -54,6 +67,11 @@ namespace GyroEngine::Resources
 
         Image &SetInitialLayout(VkImageLayout initialLayout);
 
+        Image &SetCategory(Device::MemoryCategory category);
+
+        /// @brief Owner name shown in the memory statistics and VMA dumps
+        Image &SetDebugName(const std::string &name);
+
         bool Init(VkImage externalImage = VK_NULL_HANDLE, VkImageView imageView = VK_NULL_HANDLE);
 
         void Cleanup();
@@ -78,6 +96,59 @@ namespace GyroEngine::Resources
 
         void CopyFromBuffer(VkBuffer buffer, VkExtent3D imageExtent, uint32_t layerCount = 1);
 
+        /// @brief Copies several regions in one submit, e.g. every level of a pre-built mip chain
+        void CopyFromBuffer(VkBuffer buffer, const std::vector<VkBufferImageCopy> &regions);
+
+        /// @brief Fills every level after the first by blitting each level into the next, the image ends up shader readable
+        /// @note Needs transfer source usage and a format that supports linear blits. sRGB formats are filtered in
+        /// linear space. MipGenerator does the same in a single compute dispatch
+        bool GenerateMipmaps();
+
+        /// @brief Whether GenerateMipmaps can blit this image's chain
+        [[nodiscard]] bool CanBlitMipmaps() const;
+
+        /// @brief Records GenerateMipmaps into cmd instead of submitting it, e.g. to batch several images
+        void RecordMipmaps(VkCommandBuffer cmd);
+
+        /// @brief Records a transition of every level into cmd, the tracked layout changes right away
+        void RecordLayout(VkCommandBuffer cmd, VkImageLayout newLayout);
+
+        /// @brief Copies areas of the first level in one submit and blits the levels under them, the rest is kept
+        /// @note An area's levels only stay apart from its neighbours when its rect is aligned to 2^(levels - 1)
+        bool UploadAreas(const std::vector<ImageArea> &areas);
+
+        /// @brief Records the blits refreshing every level under an area of the first level
+        /// @note The image has to be in transfer destination layout, and is left in it
+        void RecordAreaMipmaps(VkCommandBuffer cmd, const VkRect2D &area, uint32_t layer);
+
+        /// @brief View of a single level, e.g. to write it from a compute shader
+        /// @param format Format of the view, a mutable format image can be viewed as another compatible format
+        /// @note The caller owns the view
+        [[nodiscard]] VkImageView CreateMipView(uint32_t mipLevel, VkFormat format) const;
+
+        /// @brief Exposes the image view to shaders through the bindless heap
+        /// @param layout Layout the image is in whenever shaders sample it
+        /// @return Index into the heap's image array, stays valid until the image is destroyed
+        uint32_t RegisterBindless(VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        /// @brief Moves other's heap slot over to this image, shaders holding the index sample this image from now on
+        /// @note other keeps its handles but is no longer in the heap
+        uint32_t TakeBindlessIndex(Image &other);
+
+        [[nodiscard]] uint32_t GetBindlessIndex() const
+        {
+            return m_bindlessIndex;
+        }
+
+        [[nodiscard]] bool CanRelocate() const override;
+
+        bool RecordRelocation(VkCommandBuffer cmd, VmaAllocation dstAllocation) override;
+
+        std::function<void()> CommitRelocation() override;
+
+        void AbortRelocation() override;
+
+        /// @note The image and its view may change when the defragmenter moves the image
         [[nodiscard]] VkImage GetImage() const
         {
             return m_image;
@@ -128,13 +199,25 @@ namespace GyroEngine::Resources
             return m_imageType;
         }
 
+        [[nodiscard]] VkImageCreateFlags GetCreateFlags() const
+        {
+            return m_createFlags;
+        }
+
     private:
+        /// @brief Records its own layout transitions around the dispatch, and keeps m_imageLayout in sync
+        friend class MipGenerator;
+
         Device::RenderingDevice &m_device;
 
         VkImage m_image = VK_NULL_HANDLE;
         VkImageView m_imageView = VK_NULL_HANDLE;
+        VkImage m_pendingImage = VK_NULL_HANDLE;
+        VkImageView m_pendingImageView = VK_NULL_HANDLE;
         VkImageLayout m_imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         VmaAllocation m_allocation = VK_NULL_HANDLE;
+        uint32_t m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+        VkImageLayout m_bindlessLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
         uint32_t m_srcFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
@@ -150,9 +233,17 @@ namespace GyroEngine::Resources
         VkImageTiling m_tiling = VK_IMAGE_TILING_OPTIMAL;
         VkImageCreateFlags m_createFlags = 0;
         VkImageLayout m_initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Device::MemoryCategory m_category = Device::MemoryCategory::Unknown;
+        std::string m_debugName;
 
         bool m_isExternal = false;
 
+        [[nodiscard]] bool IsRelocatableUsage() const;
+
+        [[nodiscard]] VkImageCreateInfo GetCreateInfo() const;
+
+        [[nodiscard]] VkImageView CreateView(VkImage image) const;
+
         bool CreateImage();
 
         bool CreateImageView();
@@ -0,0 +1,301 @@
+//
+// Created by lepag on 7/24/2025.
+//
+
+#include "mip_generator.h"
+
+#include <algorithm>
+#include <array>
+
+#include "context/rendering_device.h"
+#include "utilities/renderer.h"
+
+namespace GyroEngine::Resources
+{
+    MipGenerator& MipGenerator::SetShader(const ShaderHandle& shader)
+    {
+        m_shader = shader;
+        return *this;
+    }
+
+    bool MipGenerator::Init()
+    {
+        if (!m_shader || m_shader->GetShaderStage() != Utils::Shader::ShaderStage::Compute)
+        {
+            Logger::LogError("Mip generator needs a compute shader");
+            return false;
+        }
+        if (!CreateDescriptors() || !CreatePipeline())
+        {
+            Cleanup();
+            return false;
+        }
+        return true;
+    }
+
+    void MipGenerator::Cleanup()
+    {
+        const VkDevice device = m_device.GetLogicalDevice();
+        if (m_pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, m_pipeline, nullptr);
+            m_pipeline = VK_NULL_HANDLE;
+        }
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_descriptorPool != VK_NULL_HANDLE)
+        {
+            // Frees the set with it
+            vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
+            m_descriptorPool = VK_NULL_HANDLE;
+            m_descriptorSet = VK_NULL_HANDLE;
+        }
+        if (m_setLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(device, m_setLayout, nullptr);
+            m_setLayout = VK_NULL_HANDLE;
+        }
+        m_counterBuffer.reset();
+    }
+
+    bool MipGenerator::Supports(const Image& image) const
+    {
+        const bool srgb = Utils::Image::IsSrgbFormat(image.GetFormat());
+        return Utils::Image::GetUnormFormat(image.GetFormat()) == VK_FORMAT_R8G8B8A8_UNORM &&
+               (image.GetUsage() & VK_IMAGE_USAGE_STORAGE_BIT) &&
+               (!srgb || (image.GetCreateFlags() & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT)) &&
+               image.GetImageType() == VK_IMAGE_TYPE_2D && image.GetArrayLayers() == 1 &&
+               image.GetMipLevels() <= MaxMipLevels;
+    }
+
+    bool MipGenerator::Generate(Image& image)
+    {
+        if (image.GetMipLevels() <= 1)
+        {
+            return true;
+        }
+        if (!IsValid() || !Supports(image))
+        {
+            return image.GenerateMipmaps();
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        // Every level gets a UNORM storage view, unused slots repeat the last level and are never touched
+        const uint32_t mipLevels = image.GetMipLevels();
+        std::array<VkImageView, MaxMipLevels> views = {};
+        std::array<VkDescriptorImageInfo, MaxMipLevels> imageInfos = {};
+        for (uint32_t mip = 0; mip < mipLevels; ++mip)
+        {
+            views[mip] = image.CreateMipView(mip, VK_FORMAT_R8G8B8A8_UNORM);
+            if (views[mip] == VK_NULL_HANDLE)
+            {
+                Logger::LogError("Failed to create mip view {} of image {}", mip, image.m_debugName);
+                for (uint32_t created = 0; created < mip; ++created)
+                {
+                    vkDestroyImageView(m_device.GetLogicalDevice(), views[created], nullptr);
+                }
+                return false;
+            }
+        }
+        for (uint32_t mip = 0; mip < MaxMipLevels; ++mip)
+        {
+            imageInfos[mip].imageView = views[std::min(mip, mipLevels - 1)];
+            imageInfos[mip].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkDescriptorBufferInfo counterInfo = {};
+        counterInfo.buffer = m_counterBuffer->GetBuffer();
+        counterInfo.offset = 0;
+        counterInfo.range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> writes = {};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = m_descriptorSet;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = MaxMipLevels;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[0].pImageInfo = imageInfos.data();
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = m_descriptorSet;
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo = &counterInfo;
+        vkUpdateDescriptorSets(m_device.GetLogicalDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                               nullptr);
+
+        // One group per 64x64 tile of the first level
+        const VkExtent3D extent = image.GetExtent();
+        const uint32_t groupsX = (extent.width + 63) / 64;
+        const uint32_t groupsY = (extent.height + 63) / 64;
+
+        MipConstants constants;
+        constants.mipLevels = mipLevels;
+        constants.srgb = Utils::Image::IsSrgbFormat(image.GetFormat()) ? 1 : 0;
+        constants.groupCount = groupsX * groupsY;
+
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer commandBuffer)
+            {
+                vkCmdFillBuffer(commandBuffer, m_counterBuffer->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+                VkBufferMemoryBarrier counterBarrier = {};
+                counterBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                counterBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                counterBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                counterBarrier.buffer = m_counterBuffer->GetBuffer();
+                counterBarrier.size = VK_WHOLE_SIZE;
+
+                // The first level is read, the others are overwritten
+                VkImageMemoryBarrier imageBarriers[2] = {};
+                for (auto& barrier : imageBarriers)
+                {
+                    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.image = image.GetImage();
+                    barrier.subresourceRange = {image.GetAspectMask(), 0, 1, 0, 1};
+                }
+                imageBarriers[0].oldLayout = image.GetImageLayout();
+                imageBarriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                imageBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                imageBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                imageBarriers[1].subresourceRange.baseMipLevel = 1;
+                imageBarriers[1].subresourceRange.levelCount = mipLevels - 1;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &counterBarrier, 2,
+                                     imageBarriers);
+
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1,
+                                        &m_descriptorSet, 0, nullptr);
+                vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                                   sizeof(MipConstants), &constants);
+                vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+                VkImageMemoryBarrier readableBarrier = imageBarriers[0];
+                readableBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+                readableBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                readableBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                readableBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                readableBarrier.subresourceRange.baseMipLevel = 0;
+                readableBarrier.subresourceRange.levelCount = mipLevels;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     Utils::Image::GetDestinationStageFlags(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+                                     0, 0, nullptr, 0, nullptr, 1, &readableBarrier);
+            }
+        );
+        image.m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        for (uint32_t mip = 0; mip < mipLevels; ++mip)
+        {
+            vkDestroyImageView(m_device.GetLogicalDevice(), views[mip], nullptr);
+        }
+        return true;
+    }
+
+    bool MipGenerator::CreateDescriptors()
+    {
+        const std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MaxMipLevels, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}
+        }};
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(m_device.GetLogicalDevice(), &layoutInfo, nullptr, &m_setLayout) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create mip generator descriptor set layout");
+            return false;
+        }
+
+        const std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MaxMipLevels},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}
+        }};
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        if (vkCreateDescriptorPool(m_device.GetLogicalDevice(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create mip generator descriptor pool");
+            return false;
+        }
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = m_descriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &m_setLayout;
+        if (vkAllocateDescriptorSets(m_device.GetLogicalDevice(), &allocateInfo, &m_descriptorSet) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to allocate mip generator descriptor set");
+            return false;
+        }
+
+        m_counterBuffer = std::make_unique<Buffer>(m_device);
+        m_counterBuffer->SetSize(sizeof(uint32_t))
+                .SetUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE)
+                .SetCategory(Device::MemoryCategory::Textures)
+                .SetDebugName("Mip generator counter");
+        if (!m_counterBuffer->Init())
+        {
+            Logger::LogError("Failed to create mip generator counter");
+            return false;
+        }
+        return true;
+    }
+
+    bool MipGenerator::CreatePipeline()
+    {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(MipConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(m_device.GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) !=
+            VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create mip generator pipeline layout");
+            return false;
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_shader->GetShaderModule();
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = m_pipelineLayout;
+        if (vkCreateComputePipelines(m_device.GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                     &m_pipeline) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create mip generator pipeline for shader {}", m_shader->GetShaderPath());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,80 @@
+//
+// Created by lepag on 7/24/2025.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <volk.h>
+
+#include "image.h"
+#include "../buffer/buffer.h"
+#include "../pipeline/shader.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Resources
+{
+    /// @brief Push constants of the downsampler, mirrors MipConstants in mip_downsample.comp
+    struct MipConstants
+    {
+        uint32_t mipLevels = 1;
+        uint32_t srgb = 0;
+        uint32_t groupCount = 0;
+        uint32_t padding = 0;
+    };
+
+    /// @brief Fills an image's mip chain from its first level in a single compute dispatch
+    /// @note Each workgroup reduces a 64x64 tile six levels down, the last one to finish reduces the rest, so no level
+    /// waits on a barrier between dispatches. sRGB images are filtered in linear space. Images the dispatch can't
+    /// write fall back to Image::GenerateMipmaps
+    class MipGenerator
+    {
+    public:
+        /// @brief Longest chain a dispatch writes, a 4096 texel wide level 0 included
+        static constexpr uint32_t MaxMipLevels = 13;
+
+        explicit MipGenerator(Device::RenderingDevice& device): m_device(device) {}
+        ~MipGenerator() { Cleanup(); }
+
+        /// @brief Compiled mip_downsample.comp
+        MipGenerator& SetShader(const ShaderHandle& shader);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Writes every level after the first, the image ends up shader readable
+        bool Generate(Image& image);
+
+        /// @brief Whether the dispatch can write the image: a single layer RGBA8 image with storage usage, and a mutable
+        /// format when it's sRGB
+        [[nodiscard]] bool Supports(const Image& image) const;
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return m_pipeline != VK_NULL_HANDLE;
+        }
+    private:
+        Device::RenderingDevice& m_device;
+
+        ShaderHandle m_shader;
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        /// @brief Groups that finished their tile, zeroed before every dispatch
+        std::unique_ptr<Buffer> m_counterBuffer;
+        /// @brief The descriptor set and counter are shared by every dispatch
+        std::mutex m_mutex;
+
+        bool CreateDescriptors();
+        bool CreatePipeline();
+    };
+
+    using MipGeneratorHandle = std::shared_ptr<MipGenerator>;
+}
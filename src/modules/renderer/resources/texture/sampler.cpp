@@ -10,67 +10,73 @@ namespace GyroEngine::Resources
 
 Sampler& Sampler::SetMinFilter(VkFilter minFilter)
 {
-    m_minFilter = minFilter;
+    m_state.minFilter = minFilter;
     return *this;
 }
 
 Sampler& Sampler::SetMagFilter(VkFilter magFilter)
 {
-    m_magFilter = magFilter;
+    m_state.magFilter = magFilter;
     return *this;
 }
 
 Sampler& Sampler::SetAddressModeU(VkSamplerAddressMode modeU)
 {
-    m_addressModeU = modeU;
+    m_state.addressModeU = modeU;
     return *this;
 }
 
 Sampler& Sampler::SetAddressModeV(VkSamplerAddressMode modeV)
 {
-    m_addressModeV = modeV;
+    m_state.addressModeV = modeV;
     return *this;
 }
 
 Sampler& Sampler::SetAddressModeW(VkSamplerAddressMode modeW)
 {
-    m_addressModeW = modeW;
+    m_state.addressModeW = modeW;
     return *this;
 }
 
 Sampler& Sampler::SetMipLodBias(const float bias)
 {
-    m_mipLodBias = bias;
+    m_state.mipLodBias = bias;
     return *this;
 }
 
 Sampler& Sampler::SetMinLod(const float minLod)
 {
-    m_minLod = minLod;
+    m_state.minLod = minLod;
     return *this;
 }
 
 Sampler& Sampler::SetMaxLod(const float maxLod)
 {
-    m_maxLod = maxLod;
+    m_state.maxLod = maxLod;
     return *this;
 }
 
 Sampler& Sampler::SetAnisotropy(const bool enable)
 {
-    m_anisotropyEnable = enable;
+    m_state.anisotropyEnable = enable;
     return *this;
 }
 
 Sampler& Sampler::SetAnisotropyLevel(const float level)
 {
-    m_anisotropyLevel = level;
+    m_state.anisotropyLevel = level;
     return *this;
 }
 
 Sampler& Sampler::SetCompareOp(VkCompareOp compareOp)
 {
-    m_compareOp = compareOp;
+    m_state.compareOp = compareOp;
+    return *this;
+}
+
+Sampler& Sampler::SetState(const SamplerState& state)
+{
+    m_state = state;
     return *this;
 }
 
@@ -83,8 +89,28 @@ bool Sampler::Init()
     return CreateSampler();
 }
 
+uint32_t Sampler::RegisterBindless()
+{
+    if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+    {
+        return m_bindlessIndex;
+    }
+    if (m_sampler == VK_NULL_HANDLE)
+    {
+        Logger::LogError("Only initialized samplers can be registered in the bindless heap");
+        return Device::BindlessHeap::InvalidIndex;
+    }
+    m_bindlessIndex = m_device.GetBindlessHeap().RegisterSampler(m_sampler);
+    return m_bindlessIndex;
+}
+
 void Sampler::Cleanup()
 {
+    if (m_bindlessIndex != Device::BindlessHeap::InvalidIndex)
+    {
+        m_device.GetBindlessHeap().ReleaseSampler(m_bindlessIndex);
+        m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
+    }
     if (m_sampler != VK_NULL_HANDLE)
     {
         vkDestroySampler(m_device.GetLogicalDevice(), m_sampler, nullptr);
@@ -94,7 +120,7 @@ void Sampler::Cleanup()
 
 bool Sampler::CreateSampler()
 {
-    if (m_anisotropyEnable && m_anisotropyLevel > m_device.GetPhysicalDeviceProperties().limits.maxSamplerAnisotropy) {
+    if (m_state.anisotropyEnable && m_state.anisotropyLevel > m_device.GetPhysicalDeviceProperties().limits.maxSamplerAnisotropy) {
         Logger::LogError("Anisotropy level exceeds device limits");
         return false;
     }
@@ -102,23 +128,23 @@ bool Sampler::CreateSampler()
     VkSamplerCreateInfo samplerInfo = {};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 
-    samplerInfo.magFilter = m_magFilter;
-    samplerInfo.minFilter = m_minFilter;
+    samplerInfo.magFilter = m_state.magFilter;
+    samplerInfo.minFilter = m_state.minFilter;
 
-    samplerInfo.addressModeU = m_addressModeU;
-    samplerInfo.addressModeV = m_addressModeV;
-    samplerInfo.addressModeW = m_addressModeW;
+    samplerInfo.addressModeU = m_state.addressModeU;
+    samplerInfo.addressModeV = m_state.addressModeV;
+    samplerInfo.addressModeW = m_state.addressModeW;
 
-    samplerInfo.mipmapMode = m_mipmapMode;
+    samplerInfo.mipmapMode = m_state.mipmapMode;
 
-    samplerInfo.mipLodBias = m_mipLodBias;
-    samplerInfo.minLod = m_minLod;
-    samplerInfo.maxLod = m_maxLod;
+    samplerInfo.mipLodBias = m_state.mipLodBias;
+    samplerInfo.minLod = m_state.minLod;
+    samplerInfo.maxLod = m_state.maxLod;
 
-    samplerInfo.anisotropyEnable = m_anisotropyEnable;
-    samplerInfo.maxAnisotropy = m_anisotropyLevel;
+    samplerInfo.anisotropyEnable = m_state.anisotropyEnable;
+    samplerInfo.maxAnisotropy = m_state.anisotropyLevel;
 
-    samplerInfo.compareOp = m_compareOp;
+    samplerInfo.compareOp = m_state.compareOp;
 
     VkResult result = vkCreateSampler(m_device.GetLogicalDevice(), &samplerInfo, nullptr, &m_sampler);
     if (result != VK_SUCCESS)
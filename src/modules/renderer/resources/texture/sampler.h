@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <volk.h>
 
+#include "context/bindless_heap.h"
+
 namespace GyroEngine::Device
 {
     class RenderingDevice;
@@ -14,6 +17,81 @@ namespace GyroEngine::Device
 
 namespace GyroEngine::Resources
 {
+    /// @brief Everything a sampler is created from, samplers with equal states are interchangeable
+    struct SamplerState
+    {
+        VkFilter minFilter = VK_FILTER_LINEAR;
+        VkFilter magFilter = VK_FILTER_LINEAR;
+        VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        float mipLodBias = 0.0f;
+        float minLod = 0.0f;
+        float maxLod = VK_LOD_CLAMP_NONE;
+        VkBool32 anisotropyEnable = VK_FALSE;
+        float anisotropyLevel = 0.0f;
+        VkCompareOp compareOp = VK_COMPARE_OP_ALWAYS;
+
+        /// @brief -0.0f compares equal to 0.0f but has other bits, so only 0.0f is kept
+        [[nodiscard]] static float Canonical(const float value)
+        {
+            return value == 0.0f ? 0.0f : value;
+        }
+
+        /// @brief Same state with the fields Vulkan ignores cleared, e.g. the anisotropy level while it's disabled,
+        /// and the floats canonical
+        [[nodiscard]] SamplerState Normalized() const
+        {
+            SamplerState state = *this;
+            if (!state.anisotropyEnable)
+            {
+                state.anisotropyLevel = 0.0f;
+            }
+            state.mipLodBias = Canonical(state.mipLodBias);
+            state.minLod = Canonical(state.minLod);
+            state.maxLod = Canonical(state.maxLod);
+            state.anisotropyLevel = Canonical(state.anisotropyLevel);
+            return state;
+        }
+
+        bool operator==(const SamplerState& other) const
+        {
+            return minFilter == other.minFilter && magFilter == other.magFilter &&
+                   addressModeU == other.addressModeU && addressModeV == other.addressModeV &&
+                   addressModeW == other.addressModeW && mipmapMode == other.mipmapMode &&
+                   mipLodBias == other.mipLodBias && minLod == other.minLod && maxLod == other.maxLod &&
+                   anisotropyEnable == other.anisotropyEnable && anisotropyLevel == other.anisotropyLevel &&
+                   compareOp == other.compareOp;
+        }
+    };
+
+    struct SamplerStateHash
+    {
+        size_t operator()(const SamplerState& state) const
+        {
+            size_t hash = 0;
+            const auto combine = [&hash](const size_t value)
+            {
+                hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            };
+            combine(std::hash<int>()(state.minFilter));
+            combine(std::hash<int>()(state.magFilter));
+            combine(std::hash<int>()(state.addressModeU));
+            combine(std::hash<int>()(state.addressModeV));
+            combine(std::hash<int>()(state.addressModeW));
+            combine(std::hash<int>()(state.mipmapMode));
+            // Equal floats have to hash equally, so signed zeros are hashed as one
+            combine(std::hash<float>()(SamplerState::Canonical(state.mipLodBias)));
+            combine(std::hash<float>()(SamplerState::Canonical(state.minLod)));
+            combine(std::hash<float>()(SamplerState::Canonical(state.maxLod)));
+            combine(std::hash<uint32_t>()(state.anisotropyEnable));
+            combine(std::hash<float>()(SamplerState::Canonical(state.anisotropyLevel)));
+            combine(std::hash<int>()(state.compareOp));
+            return hash;
+        }
+    };
+
     class Sampler final  {
     public:
         explicit Sampler(Device::RenderingDevice& device): m_device(device) {}
@@ -30,30 +108,33 @@ namespace GyroEngine::Resources
         Sampler& SetAnisotropy(bool enable);
         Sampler& SetAnisotropyLevel(float level);
         Sampler& SetCompareOp(VkCompareOp compareOp);
+        Sampler& SetState(const SamplerState& state);
 
         bool Init();
         void Cleanup();
 
+        /// @brief Exposes the sampler to shaders through the bindless heap
+        /// @return Index into the heap's sampler array, stays valid until the sampler is destroyed
+        uint32_t RegisterBindless();
+
         [[nodiscard]] VkSampler GetSampler() const {
             return m_sampler;
         }
+
+        [[nodiscard]] uint32_t GetBindlessIndex() const {
+            return m_bindlessIndex;
+        }
+
+        [[nodiscard]] const SamplerState& GetState() const {
+            return m_state;
+        }
     private:
         Device::RenderingDevice& m_device;
 
         VkSampler m_sampler = VK_NULL_HANDLE;
+        uint32_t m_bindlessIndex = Device::BindlessHeap::InvalidIndex;
 
-        VkFilter m_minFilter = VK_FILTER_LINEAR;
-        VkFilter m_magFilter = VK_FILTER_LINEAR;
-        VkSamplerAddressMode m_addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        VkSamplerAddressMode m_addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        VkSamplerAddressMode m_addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        VkSamplerMipmapMode m_mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-        float m_mipLodBias = 0.0f;
-        float m_minLod = 0.0f;
-        float m_maxLod = VK_LOD_CLAMP_NONE;
-        VkBool32 m_anisotropyEnable = VK_FALSE;
-        float m_anisotropyLevel = 0.0f;
-        VkCompareOp m_compareOp = VK_COMPARE_OP_ALWAYS;
+        SamplerState m_state;
 
         bool CreateSampler();
     };
@@ -4,8 +4,14 @@
 
 #include "texture.h"
 
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
 #include "../buffer/buffer.h"
 #include "context/rendering_device.h"
+#include "texture_streamer.h"
+#include "utilities/renderer.h"
 
 namespace GyroEngine::Resources
 {
@@ -16,7 +22,13 @@ namespace GyroEngine::Resources
             Logger::LogError("Failed to create texture sampler");
             return false;
         }
-        if (!CreateImage())
+        // KTX2 files decide the format, size and mip chain of the image, it's created once they're loaded, and uploads
+        // create theirs as they're recorded
+        if (Utils::Ktx::IsKtx2File(m_texturePath) || (m_uploader && m_uploader->IsValid()))
+        {
+            return true;
+        }
+        if (!EnsureImage(GetColorFormat(), GetExtent(), GetMipLevelCount(GetExtent()), true))
         {
             Logger::LogError("Failed to create texture image");
             return false;
@@ -26,31 +38,64 @@ namespace GyroEngine::Resources
 
     bool Texture::Generate()
     {
+        StopStreaming();
+        const bool isKtx = Utils::Ktx::IsKtx2File(m_texturePath);
+        if (isKtx && m_streaming && OpenStreamSource())
+        {
+            return SetUploadResult(GenerateStreamed());
+        }
+        if (m_uploader && m_uploader->IsValid())
+        {
+            m_upload = m_uploader->Upload(*this);
+            return true;
+        }
+        if (isKtx)
+        {
+            return SetUploadResult(GenerateFromKtx());
+        }
+
+        if (!EnsureImage(GetColorFormat(), GetExtent(), GetMipLevelCount(GetExtent()), true))
+        {
+            Logger::LogError("Failed to create texture image");
+            return false;
+        }
         auto imageData = LoadTextureFromFile();
         if (!imageData)
         {
             Logger::LogError("Failed to load texture from file");
-            return false;
+            return SetUploadResult(false);
         }
         if (!CopyTextureToImage(imageData))
         {
             Logger::LogError("Failed to copy texture to image");
-            return false;
+            return SetUploadResult(false);
         }
-        return true;
+        return SetUploadResult(true);
     }
 
     void Texture::Destroy()
     {
+        if (m_uploader)
+        {
+            m_uploader->Cancel(this);
+        }
+        StopStreaming();
         DestroyImage();
         DestroySampler();
     }
 
     void Texture::Update()
     {
+        // The queued upload sizes the image once it's recorded
+        if (IsUploading())
+        {
+            return;
+        }
 
-        if (m_texturePathDirty || m_image->GetExtent().width != static_cast<uint32_t>(m_size.x) ||
-            m_image->GetExtent().height != static_cast<uint32_t>(m_size.y))
+        // Streamed images hold fewer levels than the file, their size follows the resident levels
+        if (m_texturePathDirty || !m_image ||
+            (!IsStreamed() && (m_image->GetExtent().width != static_cast<uint32_t>(m_size.x) ||
+                               m_image->GetExtent().height != static_cast<uint32_t>(m_size.y))))
         {
             if (!Generate())
             {
@@ -61,17 +106,33 @@ namespace GyroEngine::Resources
         }
     }
 
+    bool Texture::IsReady() const
+    {
+        if (!m_image)
+        {
+            return false;
+        }
+        return !m_upload.valid() || (!IsUploading() && m_upload.get());
+    }
+
+    bool Texture::IsUploading() const
+    {
+        return m_upload.valid() && m_upload.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+
     bool Texture::CreateSampler()
     {
-        m_sampler = std::make_shared<Sampler>(m_device);
-        m_sampler->SetAddressModeU(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetAddressModeV(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetAddressModeW(VK_SAMPLER_ADDRESS_MODE_REPEAT)
-                .SetMagFilter(VK_FILTER_LINEAR)
-                .SetMinFilter(VK_FILTER_LINEAR)
-                .SetAnisotropy(false)
-                .SetCompareOp(VK_COMPARE_OP_ALWAYS);
-        if (!m_sampler->Init())
+        // Every texture samples the same way, they all share one sampler through the device's cache
+        SamplerState state;
+        state.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        state.magFilter = VK_FILTER_LINEAR;
+        state.minFilter = VK_FILTER_LINEAR;
+        state.anisotropyEnable = VK_FALSE;
+        state.compareOp = VK_COMPARE_OP_ALWAYS;
+        m_sampler = m_device.GetSamplerCache().Acquire(state);
+        if (!m_sampler)
         {
             Logger::LogError("Failed to initialize texture sampler");
             return false;
@@ -87,26 +148,73 @@ namespace GyroEngine::Resources
         }
     }
 
-    bool Texture::CreateImage()
+    bool Texture::CreateImage(const VkFormat format, const VkExtent3D extent, const uint32_t mipLevels,
+                              const bool generateMips, const bool makeReadable)
     {
+        // The mip chain is either blitted or written by the generator's storage views, which have to be UNORM
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        VkImageCreateFlags createFlags = 0;
+        const bool generated = generateMips && mipLevels > 1;
+        // Streamed images are copied into their replacement whenever their resident levels change
+        if (generated || IsStreamed())
+        {
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+        if (generated && mipLevels <= MipGenerator::MaxMipLevels && m_mipGenerator && m_mipGenerator->IsValid() &&
+            Utils::Image::GetUnormFormat(format) == VK_FORMAT_R8G8B8A8_UNORM)
+        {
+            usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+            createFlags = Utils::Image::IsSrgbFormat(format)
+                              ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT
+                              : 0;
+        }
+
         m_image = std::make_shared<Image>(m_device);
-        m_image->SetFormat(VK_FORMAT_R8G8B8A8_UNORM)
-                .SetExtent({static_cast<uint32_t>(m_size.x), static_cast<uint32_t>(m_size.y), 1})
-                .SetUsage(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+        m_image->SetFormat(format)
+                .SetExtent(extent)
+                .SetMipLevels(mipLevels)
+                .SetUsage(usage)
                 .SetAspectMask(VK_IMAGE_ASPECT_COLOR_BIT)
                 .SetImageType(VK_IMAGE_TYPE_2D)
                 .SetViewType(VK_IMAGE_VIEW_TYPE_2D)
                 .SetSamples(VK_SAMPLE_COUNT_1_BIT)
                 .SetTiling(VK_IMAGE_TILING_OPTIMAL)
-                .SetCreateFlags(0)
-                .SetInitialLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+                .SetCreateFlags(createFlags)
+                .SetInitialLayout(VK_IMAGE_LAYOUT_UNDEFINED)
+                .SetCategory(Device::MemoryCategory::Textures)
+                .SetDebugName(m_texturePath);
 
         if (!m_image->Init())
         {
             Logger::LogError("Failed to initialize texture image");
             return false;
         }
-        m_image->MakeShaderReadable();
+        if (makeReadable)
+        {
+            m_image->MakeShaderReadable();
+        }
+        return true;
+    }
+
+    bool Texture::EnsureImage(const VkFormat format, const VkExtent3D extent, const uint32_t mipLevels,
+                              const bool generateMips, const bool makeReadable)
+    {
+        if (m_image && m_image->GetFormat() == format && m_image->GetMipLevels() == mipLevels &&
+            m_image->GetExtent().width == extent.width && m_image->GetExtent().height == extent.height &&
+            (!generateMips || mipLevels <= 1 || (m_image->GetUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)))
+        {
+            return true;
+        }
+        // Frames in flight may still sample the previous image through its bindless slot
+        if (m_image)
+        {
+            TextureStreamer::Get().Retire(std::move(m_image));
+        }
+        if (!CreateImage(format, extent, mipLevels, generateMips, makeReadable))
+        {
+            return false;
+        }
+        m_image->RegisterBindless();
         return true;
     }
 
@@ -120,7 +228,8 @@ namespace GyroEngine::Resources
 
     Utils::Image::ImageData *Texture::LoadTextureFromFile() const
     {
-        const auto imageData = Utils::Image::LoadImageData(m_texturePath, static_cast<int>(m_size.x), static_cast<int>(m_size.y));
+        const auto imageData = Utils::Image::LoadImageData(m_texturePath, static_cast<int>(m_size.x),
+                                                           static_cast<int>(m_size.y), m_srgb);
         if (!imageData)
         {
             Logger::LogError("Failed to load texture data from path: " + m_texturePath);
@@ -135,7 +244,9 @@ namespace GyroEngine::Resources
         buffer->SetSize(imageData->width * imageData->height * 4)
               .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
               .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
-              .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE);
+              .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+              .SetCategory(Device::MemoryCategory::Staging)
+              .SetDebugName(m_texturePath + " staging");
         if (!buffer->Init())
         {
             Logger::LogError("Failed to create buffer for texture data");
@@ -146,10 +257,361 @@ namespace GyroEngine::Resources
                                 {static_cast<uint32_t>(imageData->width), static_cast<uint32_t>(imageData->height), 1},
                                 1);
 
+        if (!GenerateMips())
+        {
+            Logger::LogError("Failed to generate the mip chain of texture {}", m_texturePath);
+        }
         m_image->MakeShaderReadable();
 
         buffer.reset();
         delete imageData;
         return true;
     }
+
+    bool Texture::GenerateFromKtx()
+    {
+        const auto ktxData = Utils::Ktx::LoadKtx2(m_texturePath, m_device.GetPhysicalDevice());
+        if (!ktxData)
+        {
+            Logger::LogError("Failed to load KTX2 texture from path: " + m_texturePath);
+            return false;
+        }
+
+        // Block compressed levels can't be blitted, only files with an uncompressed first level get a generated chain
+        const bool generateMips = m_mipmaps && ktxData->mipLevels == 1 &&
+                                  !Utils::Ktx::IsBlockCompressedFormat(ktxData->format);
+        const uint32_t mipLevels = generateMips ? GetMipLevelCount(ktxData->extent) : ktxData->mipLevels;
+        m_size = glm::vec3(static_cast<float>(ktxData->extent.width), static_cast<float>(ktxData->extent.height),
+                           m_size.z);
+        if (!EnsureImage(ktxData->format, ktxData->extent, mipLevels, generateMips))
+        {
+            Logger::LogError("Failed to create image for KTX2 texture {}", m_texturePath);
+            return false;
+        }
+
+        auto buffer = std::make_shared<Buffer>(m_device);
+        buffer->SetSize(ktxData->dataSize)
+              .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+              .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+              .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+              .SetCategory(Device::MemoryCategory::Staging)
+              .SetDebugName(m_texturePath + " staging");
+        if (!buffer->Init())
+        {
+            Logger::LogError("Failed to create buffer for texture data");
+            return false;
+        }
+        buffer->Map(ktxData->data);
+        m_image->CopyFromBuffer(buffer->GetBuffer(), ktxData->regions);
+
+        if (generateMips && !GenerateMips())
+        {
+            Logger::LogError("Failed to generate the mip chain of texture {}", m_texturePath);
+        }
+        m_image->MakeShaderReadable();
+        return true;
+    }
+
+    std::unique_ptr<TexturePayload> Texture::Decode() const
+    {
+        auto payload = std::make_unique<TexturePayload>();
+        if (Utils::Ktx::IsKtx2File(m_texturePath))
+        {
+            payload->ktxData = Utils::Ktx::LoadKtx2(m_texturePath, m_device.GetPhysicalDevice());
+            if (!payload->ktxData)
+            {
+                return nullptr;
+            }
+            const Utils::Ktx::KtxData& ktxData = *payload->ktxData;
+            payload->format = ktxData.format;
+            payload->extent = ktxData.extent;
+            payload->generateMips = m_mipmaps && ktxData.mipLevels == 1 &&
+                                    !Utils::Ktx::IsBlockCompressedFormat(ktxData.format);
+            payload->mipLevels = payload->generateMips ? GetMipLevelCount(ktxData.extent) : ktxData.mipLevels;
+            payload->generateMips = payload->generateMips && payload->mipLevels > 1;
+            payload->data = ktxData.data;
+            payload->size = ktxData.dataSize;
+            payload->regions = ktxData.regions;
+            return payload;
+        }
+
+        payload->imageData = LoadTextureFromFile();
+        if (!payload->imageData)
+        {
+            return nullptr;
+        }
+        const Utils::Image::ImageData& imageData = *payload->imageData;
+        payload->format = GetColorFormat();
+        payload->extent = {static_cast<uint32_t>(imageData.width), static_cast<uint32_t>(imageData.height), 1};
+        payload->mipLevels = GetMipLevelCount(payload->extent);
+        payload->generateMips = payload->mipLevels > 1;
+        payload->data = imageData.data;
+        payload->size = static_cast<VkDeviceSize>(imageData.width) * imageData.height * 4;
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageExtent = payload->extent;
+        payload->regions.push_back(region);
+        return payload;
+    }
+
+    bool Texture::PrepareUpload(const TexturePayload& payload)
+    {
+        m_size = glm::vec3(static_cast<float>(payload.extent.width), static_cast<float>(payload.extent.height),
+                           m_size.z);
+        if (!EnsureImage(payload.format, payload.extent, payload.mipLevels, payload.generateMips, false))
+        {
+            Logger::LogError("Failed to create image for texture {}", m_texturePath);
+            return false;
+        }
+        return true;
+    }
+
+    bool Texture::OpenStreamSource()
+    {
+        auto file = std::make_unique<Utils::MappedFile>();
+        Utils::Ktx::Ktx2Layout layout;
+        if (!file->Open(m_texturePath) || !Utils::Ktx::ReadKtx2Layout(file->GetData(), file->GetSize(), layout) ||
+            layout.mipLevels <= 1 || !Utils::Ktx::IsSampledFormatSupported(m_device.GetPhysicalDevice(), layout.format))
+        {
+            return false;
+        }
+        m_streamFile = std::move(file);
+        m_streamLayout = std::move(layout);
+        return true;
+    }
+
+    bool Texture::GenerateStreamed()
+    {
+        // Only the levels that fit the base size are loaded up front, the streamer adds the rest
+        m_baseMip = m_streamLayout.mipLevels - 1;
+        while (m_baseMip > 0)
+        {
+            const VkExtent3D extent = m_streamLayout.GetLevelExtent(m_baseMip - 1);
+            if (std::max(extent.width, extent.height) > TextureStreamer::ResidentBaseSize)
+            {
+                break;
+            }
+            --m_baseMip;
+        }
+        m_targetMip = m_baseMip;
+        m_size = glm::vec3(static_cast<float>(m_streamLayout.extent.width),
+                           static_cast<float>(m_streamLayout.extent.height), m_size.z);
+
+        auto buffer = std::make_shared<Buffer>(m_device);
+        buffer->SetSize(m_streamLayout.GetSize(m_baseMip))
+              .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+              .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+              .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+              .SetPersistentMapping(true)
+              .SetCategory(Device::MemoryCategory::Staging)
+              .SetDebugName(m_texturePath + " staging");
+        if (!buffer->Init() || !WriteStreamLevels(*buffer, m_baseMip))
+        {
+            Logger::LogError("Failed to stage the base levels of texture {}", m_texturePath);
+            StopStreaming();
+            return false;
+        }
+
+        // Nothing is resident yet, a previous image only hands its bindless index over
+        ImageHandle previous;
+        m_residentMip = m_streamLayout.mipLevels;
+        bool restreamed = false;
+        Utils::Renderer::SubmitOneTimeCommand(
+            m_device.GetLogicalDevice(),
+            m_device.GetCommandPool(),
+            m_device.GetDeviceFamilies().GetGraphicsQueue().queue,
+            [&](VkCommandBuffer cmd)
+            {
+                restreamed = Restream(cmd, m_baseMip, buffer.get(), m_baseMip, previous);
+            }
+        );
+        if (!restreamed)
+        {
+            Logger::LogError("Failed to upload the base levels of texture {}", m_texturePath);
+            StopStreaming();
+            return false;
+        }
+        // Frames in flight may still sample the previous image through the index it handed over
+        if (previous)
+        {
+            TextureStreamer::Get().Retire(std::move(previous));
+        }
+        TextureStreamer::Get().Register(this);
+        return true;
+    }
+
+    void Texture::StopStreaming()
+    {
+        if (!m_streamFile)
+        {
+            return;
+        }
+        TextureStreamer::Get().Unregister(this);
+        m_streamFile.reset();
+        m_streamLayout = {};
+        m_residentMip = 0;
+        m_baseMip = 0;
+        m_targetMip = 0;
+    }
+
+    bool Texture::WriteStreamLevels(const Buffer& staging, const uint32_t firstMip) const
+    {
+        if (!m_streamFile || staging.GetSize() < m_streamLayout.GetSize(firstMip))
+        {
+            return false;
+        }
+        VkDeviceSize offset = 0;
+        for (uint32_t level = firstMip; level < m_streamLayout.mipLevels; ++level)
+        {
+            const Utils::Ktx::Ktx2Level& source = m_streamLayout.levels[level];
+            staging.Write(offset, m_streamFile->GetData() + source.offset, source.length);
+            offset += source.length;
+        }
+        staging.Flush(0, offset);
+        return true;
+    }
+
+    bool Texture::Restream(VkCommandBuffer cmd, const uint32_t mip, const Buffer* staging, const uint32_t stagingMip,
+                           ImageHandle& retired)
+    {
+        const ImageHandle previous = m_image;
+        const uint32_t previousMip = m_residentMip;
+        const uint32_t mipLevels = m_streamLayout.mipLevels;
+
+        // Levels the previous image holds are copied on the GPU, the ones above them come from the staging buffer
+        const uint32_t firstCopied = std::max(mip, std::min(previousMip, mipLevels));
+        if (mip < firstCopied && (!staging || stagingMip > mip))
+        {
+            Logger::LogError("Texture {} has no staged data for level {}", m_texturePath, mip);
+            return false;
+        }
+
+        if (!CreateImage(m_streamLayout.format, m_streamLayout.GetLevelExtent(mip), mipLevels - mip, false))
+        {
+            Logger::LogError("Failed to create image for level {} of texture {}", mip, m_texturePath);
+            m_image = previous;
+            return false;
+        }
+
+        std::vector<VkBufferImageCopy> uploads;
+        for (uint32_t level = mip; level < firstCopied; ++level)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset = m_streamLayout.GetSize(stagingMip) - m_streamLayout.GetSize(level);
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - mip, 0, 1};
+            region.imageExtent = m_streamLayout.GetLevelExtent(level);
+            uploads.push_back(region);
+        }
+        std::vector<VkImageCopy> copies;
+        for (uint32_t level = firstCopied; level < mipLevels; ++level)
+        {
+            VkImageCopy copy{};
+            copy.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - previousMip, 0, 1};
+            copy.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - mip, 0, 1};
+            copy.extent = m_streamLayout.GetLevelExtent(level);
+            copies.push_back(copy);
+        }
+
+        VkImage image = m_image->GetImage();
+        VkImageMemoryBarrier barriers[2] = {};
+        barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].image = image;
+        barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels - mip, 0, 1};
+        uint32_t barrierCount = 1;
+        if (!copies.empty())
+        {
+            barriers[1] = barriers[0];
+            barriers[1].oldLayout = previous->GetImageLayout();
+            barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barriers[1].image = previous->GetImage();
+            barriers[1].subresourceRange.levelCount = previous->GetMipLevels();
+            barrierCount = 2;
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, barrierCount, barriers);
+
+        if (!uploads.empty())
+        {
+            vkCmdCopyBufferToImage(cmd, staging->GetBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(uploads.size()), uploads.data());
+        }
+        if (!copies.empty())
+        {
+            vkCmdCopyImage(cmd, previous->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()),
+                           copies.data());
+        }
+
+        // Both images end up where shaders expect them, the previous one may still be sampled in flight
+        for (uint32_t i = 0; i < barrierCount; ++i)
+        {
+            barriers[i].oldLayout = barriers[i].newLayout;
+            barriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barriers[i].srcAccessMask = barriers[i].dstAccessMask;
+            barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        }
+        if (barrierCount == 2)
+        {
+            barriers[1].newLayout = previous->GetImageLayout();
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, barrierCount, barriers);
+
+
+        if (previous)
+        {
+            m_image->TakeBindlessIndex(*previous);
+        }
+        else
+        {
+            m_image->RegisterBindless();
+        }
+        m_residentMip = mip;
+        retired = previous;
+        return true;
+    }
+
+    bool Texture::SetUploadResult(const bool result)
+    {
+        std::promise<bool> upload;
+        upload.set_value(result);
+        m_upload = upload.get_future().share();
+        return result;
+    }
+
+    VkFormat Texture::GetColorFormat() const
+    {
+        return m_srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    VkExtent3D Texture::GetExtent() const
+    {
+        return {static_cast<uint32_t>(m_size.x), static_cast<uint32_t>(m_size.y), 1};
+    }
+
+    uint32_t Texture::GetMipLevelCount(const VkExtent3D extent) const
+    {
+        return m_mipmaps ? Utils::Image::GetMipLevelCount(extent.width, extent.height) : 1;
+    }
+
+    bool Texture::GenerateMips()
+    {
+        if (m_image->GetMipLevels() <= 1)
+        {
+            return true;
+        }
+        if (m_mipGenerator)
+        {
+            return m_mipGenerator->Generate(*m_image);
+        }
+        return m_image->GenerateMipmaps();
+    }
 }
@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 
 #include <glm/glm.hpp>
 
 #include "image.h"
+#include "mip_generator.h"
 #include "sampler.h"
+#include "texture_uploader.h"
+#include "io/mapped_file.h"
+#include "utilities/ktx.h"
 
 namespace GyroEngine::Device
 {
@@ -26,6 +31,10 @@ namespace GyroEngine::Resources
 
     class Texture
     {
+        /// @brief Moves the resident levels of streamed textures
+        friend class TextureStreamer;
+        /// @brief Decodes the file on a worker and fills the image in a batch
+        friend class TextureUploader;
     public:
         explicit Texture(Device::RenderingDevice& device)
             : m_device(device), m_texturePathDirty(false) {}
@@ -38,6 +47,45 @@ namespace GyroEngine::Resources
             return *this;
         }
 
+        /// @brief Fills the mip chain on import in a single dispatch, without one the chain is blitted
+        Texture& SetMipGenerator(const MipGeneratorHandle& mipGenerator)
+        {
+            m_mipGenerator = mipGenerator;
+            return *this;
+        }
+
+        /// @brief Creates a full mip chain, on by default, must be called before Init
+        Texture& UseMipmaps(const bool mipmaps = true)
+        {
+            m_mipmaps = mipmaps;
+            return *this;
+        }
+
+        /// @brief Treats the texels as sRGB encoded color, on by default, must be called before Init
+        /// @note Turn it off for data such as normal or roughness maps, which are already linear. KTX2 files carry their
+        /// own encoding, which is used instead
+        Texture& UseSrgb(const bool srgb = true)
+        {
+            m_srgb = srgb;
+            return *this;
+        }
+
+        /// @brief Starts with only the low levels resident and lets TextureStreamer load the rest as they're needed
+        /// @note Only KTX2 files storing a mip chain without supercompression stream, others are loaded whole
+        Texture& UseStreaming(const bool streaming = true)
+        {
+            m_streaming = streaming;
+            return *this;
+        }
+
+        /// @brief Loads the file on the uploader's workers instead of blocking Generate, see GetUpload
+        /// @note Streamed textures still load their base levels in Generate
+        Texture& SetUploader(const TextureUploaderHandle& uploader)
+        {
+            m_uploader = uploader;
+            return *this;
+        }
+
         bool Init();
         bool Generate();
         void Destroy();
@@ -64,10 +112,27 @@ namespace GyroEngine::Resources
             return m_channel;
         }
 
+        /// @brief Ready once the latest Generate filled the image, false when it failed
+        [[nodiscard]] std::shared_future<bool> GetUpload() const
+        {
+            return m_upload;
+        }
+
+        /// @brief Whether the image holds the file's texels and can be sampled
+        [[nodiscard]] bool IsReady() const;
+
+        [[nodiscard]] bool IsUploading() const;
+
         [[nodiscard]] const std::string& GetTexturePath() const
         {
             return m_texturePath;
         }
+
+        /// @brief Whether the levels above the base ones are streamed in and out
+        [[nodiscard]] bool IsStreamed() const
+        {
+            return m_streamFile != nullptr;
+        }
     private:
         Device::RenderingDevice& m_device;
 
@@ -78,15 +143,65 @@ namespace GyroEngine::Resources
         TextureChannel m_channel = TextureChannel::RGBA;
         std::string m_texturePath;
         bool m_texturePathDirty;
+        MipGeneratorHandle m_mipGenerator;
+        bool m_mipmaps = true;
+        bool m_srgb = true;
+        TextureUploaderHandle m_uploader;
+        std::shared_future<bool> m_upload;
+
+        // Streaming, the image holds the file's levels from m_residentMip down
+        bool m_streaming = false;
+        std::unique_ptr<Utils::MappedFile> m_streamFile;
+        Utils::Ktx::Ktx2Layout m_streamLayout;
+        uint32_t m_residentMip = 0;
+        /// @brief First of the levels that are always resident
+        uint32_t m_baseMip = 0;
+        /// @brief Level the streamer moves the texture to, within the budget
+        uint32_t m_targetMip = 0;
+        float m_requestedSize = 0.0f;
+        uint64_t m_requestFrame = 0;
 
         bool CreateSampler();
         void DestroySampler();
 
-        bool CreateImage();
+        /// @param makeReadable Moves the image to its shader layout, uploads recording their own barriers skip it
+        bool CreateImage(VkFormat format, VkExtent3D extent, uint32_t mipLevels, bool generateMips,
+                         bool makeReadable = true);
+        /// @brief Recreates the image when it doesn't match, e.g. after the path changed to a file of another format
+        /// @note The previous image is retired through the streamer, it's destroyed once no frame in flight uses it
+        bool EnsureImage(VkFormat format, VkExtent3D extent, uint32_t mipLevels, bool generateMips,
+                         bool makeReadable = true);
         void DestroyImage();
 
         [[nodiscard]] Utils::Image::ImageData* LoadTextureFromFile() const;
         bool CopyTextureToImage(const Utils::Image::ImageData* imageData);
+        /// @brief Uploads a KTX2 file's levels as they are, the image takes the file's format and size
+        bool GenerateFromKtx();
+
+        /// @brief Reads the file into memory without touching the device, runs on the thread pool
+        [[nodiscard]] std::unique_ptr<TexturePayload> Decode() const;
+        /// @brief Creates the image the payload is copied into, on the thread recording the upload
+        bool PrepareUpload(const TexturePayload& payload);
+
+        /// @brief Maps a KTX2 file whose levels can be read one at a time, false when it can't stream
+        bool OpenStreamSource();
+        bool GenerateStreamed();
+        void StopStreaming();
+        /// @brief Copies the file's levels from firstMip down into staging, runs on the thread pool
+        [[nodiscard]] bool WriteStreamLevels(const Buffer& staging, uint32_t firstMip) const;
+        /// @brief Replaces the image by one holding the levels from mip down, keeping the bindless index
+        /// @param cmd Receives the copies, the staging buffer and both images have to outlive its execution
+        /// @param staging Levels from stagingMip down, needed when mip is above the resident levels
+        /// @param retired Receives the previous image, frames in flight may still sample it
+        bool Restream(VkCommandBuffer cmd, uint32_t mip, const Buffer* staging, uint32_t stagingMip,
+                      ImageHandle& retired);
+        bool GenerateMips();
+        /// @brief Completes GetUpload right away for textures generated without the uploader
+        bool SetUploadResult(bool result);
+
+        [[nodiscard]] VkFormat GetColorFormat() const;
+        [[nodiscard]] VkExtent3D GetExtent() const;
+        [[nodiscard]] uint32_t GetMipLevelCount(VkExtent3D extent) const;
     };
 
     using TextureHandle = std::shared_ptr<Texture>;
@@ -0,0 +1,167 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "texture_array_pool.h"
+
+#include <algorithm>
+
+#include "context/rendering_device.h"
+#include "debug/logger.h"
+#include "utilities/image.h"
+
+namespace GyroEngine::Resources
+{
+    TextureArrayPool& TextureArrayPool::SetLayersPerArray(const uint32_t layers)
+    {
+        m_layersPerArray = std::max(layers, 1u);
+        return *this;
+    }
+
+    TextureArrayPool& TextureArrayPool::SetSrgb(const bool srgb)
+    {
+        m_srgb = srgb;
+        return *this;
+    }
+
+    void TextureArrayPool::Cleanup()
+    {
+        m_entries.clear();
+        m_arrays.clear();
+    }
+
+    bool TextureArrayPool::Insert(const uint8_t* pixels, const uint32_t width, const uint32_t height, ArraySlot& slot)
+    {
+        if (!pixels || width == 0 || height == 0)
+        {
+            Logger::LogError("Can't add an empty texture to a texture array");
+            return false;
+        }
+
+        const auto it = std::find_if(m_arrays.begin(), m_arrays.end(), [&](const auto& candidate)
+        {
+            return candidate->extent.width == width && candidate->extent.height == height &&
+                   !candidate->freeLayers.empty();
+        });
+        Array* array = it != m_arrays.end() ? it->get() : AddArray(width, height);
+        if (!array)
+        {
+            return false;
+        }
+
+        const uint32_t layer = array->freeLayers.back();
+        array->freeLayers.pop_back();
+
+        ImageArea area;
+        area.rect = {{0, 0}, {width, height}};
+        area.layer = layer;
+        area.texels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+        const uint32_t id = m_nextId++;
+        Entry& entry = m_entries[id];
+        entry.array = array;
+        entry.slot.id = id;
+        entry.slot.imageIndex = array->image->GetBindlessIndex();
+        entry.slot.layer = layer;
+        array->pending[id] = std::move(area);
+
+        slot = entry.slot;
+        return true;
+    }
+
+    bool TextureArrayPool::Insert(const std::string& filePath, ArraySlot& slot)
+    {
+        Utils::Image::ImageData* imageData = Utils::Image::LoadImageData(filePath, 0, 0, m_srgb);
+        if (!imageData)
+        {
+            return false;
+        }
+        const bool inserted = Insert(static_cast<const uint8_t*>(imageData->data),
+                                     static_cast<uint32_t>(imageData->width),
+                                     static_cast<uint32_t>(imageData->height), slot);
+        stbi_image_free(imageData->data);
+        delete imageData;
+        return inserted;
+    }
+
+    void TextureArrayPool::Remove(const uint32_t id)
+    {
+        const auto it = m_entries.find(id);
+        if (it == m_entries.end())
+        {
+            return;
+        }
+        Array& array = *it->second.array;
+        array.freeLayers.push_back(it->second.slot.layer);
+        array.pending.erase(id);
+        m_entries.erase(it);
+    }
+
+    bool TextureArrayPool::Flush()
+    {
+        bool flushed = true;
+        for (const auto& array : m_arrays)
+        {
+            if (array->pending.empty())
+            {
+                continue;
+            }
+            std::vector<ImageArea> areas;
+            areas.reserve(array->pending.size());
+            for (auto& [id, area] : array->pending)
+            {
+                areas.push_back(std::move(area));
+            }
+            array->pending.clear();
+            if (!array->image->UploadAreas(areas))
+            {
+                Logger::LogError("Failed to upload {} textures to a texture array", areas.size());
+                flushed = false;
+            }
+        }
+        return flushed;
+    }
+
+    const ArraySlot* TextureArrayPool::GetSlot(const uint32_t id) const
+    {
+        const auto it = m_entries.find(id);
+        return it != m_entries.end() ? &it->second.slot : nullptr;
+    }
+
+    TextureArrayPool::Array* TextureArrayPool::AddArray(const uint32_t width, const uint32_t height)
+    {
+        auto array = std::make_unique<Array>();
+        array->extent = {width, height};
+        array->image = std::make_shared<Image>(m_device);
+        array->image->SetFormat(m_srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM)
+                .SetExtent({width, height, 1})
+                .SetMipLevels(Utils::Image::GetMipLevelCount(width, height))
+                .SetArrayLayers(m_layersPerArray)
+                .SetUsage(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+                .SetAspectMask(VK_IMAGE_ASPECT_COLOR_BIT)
+                .SetImageType(VK_IMAGE_TYPE_2D)
+                .SetViewType(VK_IMAGE_VIEW_TYPE_2D_ARRAY)
+                .SetSamples(VK_SAMPLE_COUNT_1_BIT)
+                .SetTiling(VK_IMAGE_TILING_OPTIMAL)
+                .SetInitialLayout(VK_IMAGE_LAYOUT_UNDEFINED)
+                .SetCategory(Device::MemoryCategory::Textures)
+                .SetDebugName("Texture array " + std::to_string(width) + "x" + std::to_string(height));
+        if (!array->image->Init())
+        {
+            Logger::LogError("Failed to create a texture array of {}x{}", width, height);
+            return nullptr;
+        }
+        array->image->RegisterBindless();
+
+        // Popped from the back, so layers fill from the first
+        array->freeLayers.resize(m_layersPerArray);
+        for (uint32_t layer = 0; layer < m_layersPerArray; ++layer)
+        {
+            array->freeLayers[layer] = m_layersPerArray - 1 - layer;
+        }
+
+        m_arrays.push_back(std::move(array));
+        return m_arrays.back().get();
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+#include "image.h"
+
+namespace GyroEngine::Resources
+{
+    /// @brief Layer of a texture array holding a texture, shaders sample imageIndex as an array at layer
+    struct ArraySlot
+    {
+        uint32_t id = UINT32_MAX;
+        /// @brief Bindless index of the array
+        uint32_t imageIndex = Device::BindlessHeap::InvalidIndex;
+        uint32_t layer = 0;
+    };
+
+    /// @brief Groups textures of the same size into the layers of RGBA8 texture arrays
+    /// @note Unlike an atlas, layers need no borders and keep a full mip chain, but only same sized textures share
+    class TextureArrayPool
+    {
+    public:
+        explicit TextureArrayPool(Device::RenderingDevice& device): m_device(device) {}
+        ~TextureArrayPool() { Cleanup(); }
+
+        /// @brief Layers of every array, read as arrays are added
+        TextureArrayPool& SetLayersPerArray(uint32_t layers);
+        TextureArrayPool& SetSrgb(bool srgb);
+
+        void Cleanup();
+
+        /// @brief Takes a free layer of an array of the texture's size, adding an array when none is left
+        /// @note The texels reach the array on the next Flush
+        bool Insert(const uint8_t* pixels, uint32_t width, uint32_t height, ArraySlot& slot);
+        bool Insert(const std::string& filePath, ArraySlot& slot);
+
+        /// @brief Frees the texture's layer, its slot must not be sampled anymore
+        void Remove(uint32_t id);
+
+        /// @brief Copies every texture inserted since the last flush and blits their levels, one submission per array
+        bool Flush();
+
+        [[nodiscard]] const ArraySlot* GetSlot(uint32_t id) const;
+
+        [[nodiscard]] size_t GetArrayCount() const
+        {
+            return m_arrays.size();
+        }
+    private:
+        struct Array
+        {
+            ImageHandle image;
+            VkExtent2D extent = {};
+            std::vector<uint32_t> freeLayers;
+            /// @brief Layers waiting for Flush, by id
+            std::unordered_map<uint32_t, ImageArea> pending;
+        };
+
+        struct Entry
+        {
+            Array* array = nullptr;
+            ArraySlot slot;
+        };
+
+        Device::RenderingDevice& m_device;
+
+        uint32_t m_layersPerArray = 64;
+        bool m_srgb = true;
+
+        std::vector<std::unique_ptr<Array>> m_arrays;
+        std::unordered_map<uint32_t, Entry> m_entries;
+        uint32_t m_nextId = 0;
+
+        Array* AddArray(uint32_t width, uint32_t height);
+    };
+}
@@ -0,0 +1,204 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "texture_atlas.h"
+
+#include <algorithm>
+
+#include "context/rendering_device.h"
+#include "debug/logger.h"
+#include "utilities/image.h"
+
+namespace GyroEngine::Resources
+{
+    TextureAtlas& TextureAtlas::SetPageSize(const uint32_t size)
+    {
+        m_pageSize = std::max(size, 1u);
+        m_mipLevels = std::min(m_mipLevels, Utils::Image::GetMipLevelCount(m_pageSize, m_pageSize));
+        return *this;
+    }
+
+    TextureAtlas& TextureAtlas::SetMipLevels(const uint32_t mipLevels)
+    {
+        m_mipLevels = std::clamp(mipLevels, 1u, Utils::Image::GetMipLevelCount(m_pageSize, m_pageSize));
+        return *this;
+    }
+
+    TextureAtlas& TextureAtlas::SetMaxTextureSize(const uint32_t size)
+    {
+        m_maxTextureSize = size;
+        return *this;
+    }
+
+    TextureAtlas& TextureAtlas::SetSrgb(const bool srgb)
+    {
+        m_srgb = srgb;
+        return *this;
+    }
+
+    void TextureAtlas::Cleanup()
+    {
+        m_entries.clear();
+        m_pages.clear();
+    }
+
+    bool TextureAtlas::Insert(const uint8_t* pixels, const uint32_t width, const uint32_t height, AtlasRegion& region)
+    {
+        if (!pixels || width == 0 || height == 0)
+        {
+            Logger::LogError("Can't pack an empty texture into the atlas");
+            return false;
+        }
+        if (width > m_maxTextureSize || height > m_maxTextureSize)
+        {
+            Logger::LogError("Texture of {}x{} is larger than the atlas allows, {}", width, height, m_maxTextureSize);
+            return false;
+        }
+
+        const uint32_t padding = GetPadding();
+        Page* page = nullptr;
+        uint32_t pageIndex = 0;
+        AtlasRect rect;
+        for (; pageIndex < m_pages.size(); ++pageIndex)
+        {
+            if (m_pages[pageIndex]->packer.Insert(width + padding * 2, height + padding * 2, rect))
+            {
+                page = m_pages[pageIndex].get();
+                break;
+            }
+        }
+        if (!page)
+        {
+            page = AddPage();
+            if (!page)
+            {
+                return false;
+            }
+            if (!page->packer.Insert(width + padding * 2, height + padding * 2, rect))
+            {
+                Logger::LogError("Texture of {}x{} doesn't fit in an atlas page of {}", width, height, m_pageSize);
+                return false;
+            }
+        }
+
+        // The whole rect is written, the texels around the texture repeat its edges
+        ImageArea area;
+        area.rect = {{static_cast<int32_t>(rect.x), static_cast<int32_t>(rect.y)}, {rect.width, rect.height}};
+        area.texels.resize(static_cast<size_t>(rect.width) * rect.height * 4);
+        for (uint32_t y = 0; y < rect.height; ++y)
+        {
+            const uint32_t srcY = std::min(y - std::min(y, padding), height - 1);
+            const uint8_t* srcRow = pixels + static_cast<size_t>(srcY) * width * 4;
+            uint8_t* dstRow = area.texels.data() + static_cast<size_t>(y) * rect.width * 4;
+            for (uint32_t x = 0; x < rect.width; ++x)
+            {
+                const uint32_t srcX = std::min(x - std::min(x, padding), width - 1);
+                std::copy_n(srcRow + static_cast<size_t>(srcX) * 4, 4, dstRow + static_cast<size_t>(x) * 4);
+            }
+        }
+
+        const uint32_t id = m_nextId++;
+        Entry& entry = m_entries[id];
+        entry.rect = rect;
+        entry.region.id = id;
+        entry.region.imageIndex = page->image->GetBindlessIndex();
+        entry.region.page = pageIndex;
+        entry.region.uvOffset = glm::vec2(static_cast<float>(rect.x + padding), static_cast<float>(rect.y + padding)) /
+                                static_cast<float>(m_pageSize);
+        entry.region.uvScale = glm::vec2(static_cast<float>(width), static_cast<float>(height)) /
+                               static_cast<float>(m_pageSize);
+        page->pending[id] = std::move(area);
+
+        region = entry.region;
+        return true;
+    }
+
+    bool TextureAtlas::Insert(const std::string& filePath, AtlasRegion& region)
+    {
+        Utils::Image::ImageData* imageData = Utils::Image::LoadImageData(filePath, 0, 0, m_srgb);
+        if (!imageData)
+        {
+            return false;
+        }
+        const bool inserted = Insert(static_cast<const uint8_t*>(imageData->data),
+                                     static_cast<uint32_t>(imageData->width),
+                                     static_cast<uint32_t>(imageData->height), region);
+        stbi_image_free(imageData->data);
+        delete imageData;
+        return inserted;
+    }
+
+    void TextureAtlas::Remove(const uint32_t id)
+    {
+        const auto it = m_entries.find(id);
+        if (it == m_entries.end())
+        {
+            return;
+        }
+        Page& page = *m_pages[it->second.region.page];
+        page.packer.Remove(it->second.rect);
+        page.pending.erase(id);
+        m_entries.erase(it);
+    }
+
+    bool TextureAtlas::Flush()
+    {
+        bool flushed = true;
+        for (const auto& page : m_pages)
+        {
+            if (page->pending.empty())
+            {
+                continue;
+            }
+            std::vector<ImageArea> areas;
+            areas.reserve(page->pending.size());
+            for (auto& [id, area] : page->pending)
+            {
+                areas.push_back(std::move(area));
+            }
+            page->pending.clear();
+            if (!page->image->UploadAreas(areas))
+            {
+                Logger::LogError("Failed to upload {} textures to an atlas page", areas.size());
+                flushed = false;
+            }
+        }
+        return flushed;
+    }
+
+    const AtlasRegion* TextureAtlas::GetRegion(const uint32_t id) const
+    {
+        const auto it = m_entries.find(id);
+        return it != m_entries.end() ? &it->second.region : nullptr;
+    }
+
+    TextureAtlas::Page* TextureAtlas::AddPage()
+    {
+        auto page = std::make_unique<Page>();
+        page->image = std::make_shared<Image>(m_device);
+        page->image->SetFormat(m_srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM)
+                .SetExtent({m_pageSize, m_pageSize, 1})
+                .SetMipLevels(m_mipLevels)
+                .SetUsage(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+                .SetAspectMask(VK_IMAGE_ASPECT_COLOR_BIT)
+                .SetImageType(VK_IMAGE_TYPE_2D)
+                .SetViewType(VK_IMAGE_VIEW_TYPE_2D)
+                .SetSamples(VK_SAMPLE_COUNT_1_BIT)
+                .SetTiling(VK_IMAGE_TILING_OPTIMAL)
+                .SetInitialLayout(VK_IMAGE_LAYOUT_UNDEFINED)
+                .SetCategory(Device::MemoryCategory::Textures)
+                .SetDebugName("Texture atlas page " + std::to_string(m_pages.size()));
+        if (!page->image->Init())
+        {
+            Logger::LogError("Failed to create a texture atlas page");
+            return nullptr;
+        }
+        page->image->RegisterBindless();
+        page->packer.SetAlignment(GetPadding()).SetSize(m_pageSize, m_pageSize);
+
+        m_pages.push_back(std::move(page));
+        return m_pages.back().get();
+    }
+}
@@ -0,0 +1,106 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+#include <glm/glm.hpp>
+
+#include "atlas_packer.h"
+#include "image.h"
+
+namespace GyroEngine::Resources
+{
+    /// @brief Where a texture landed in an atlas, shaders sample imageIndex at uv * uvScale + uvOffset
+    struct AtlasRegion
+    {
+        uint32_t id = UINT32_MAX;
+        /// @brief Bindless index of the page holding the texture
+        uint32_t imageIndex = Device::BindlessHeap::InvalidIndex;
+        uint32_t page = 0;
+        glm::vec2 uvOffset = glm::vec2(0.0f);
+        glm::vec2 uvScale = glm::vec2(1.0f);
+    };
+
+    /// @brief Packs small textures into shared RGBA8 pages, so they cost one image and one bindless slot per page
+    /// @note Every texture is surrounded by copies of its edge texels and aligned to 2^(levels - 1) texels, so
+    /// neither filtering nor any level of a page's mip chain mixes it with its neighbours. The settings are read as
+    /// pages are added, set them before the first insert
+    class TextureAtlas
+    {
+    public:
+        explicit TextureAtlas(Device::RenderingDevice& device): m_device(device) {}
+        ~TextureAtlas() { Cleanup(); }
+
+        /// @brief Width and height of every page
+        TextureAtlas& SetPageSize(uint32_t size);
+        /// @brief Levels of every page, more levels mean wider borders
+        TextureAtlas& SetMipLevels(uint32_t mipLevels);
+        /// @brief Largest width or height a texture may have to be packed
+        TextureAtlas& SetMaxTextureSize(uint32_t size);
+        TextureAtlas& SetSrgb(bool srgb);
+
+        void Cleanup();
+
+        /// @brief Packs tightly packed RGBA8 texels, adding a page when none has room
+        /// @note The texels reach the page on the next Flush
+        bool Insert(const uint8_t* pixels, uint32_t width, uint32_t height, AtlasRegion& region);
+        bool Insert(const std::string& filePath, AtlasRegion& region);
+
+        /// @brief Frees the texture's room, its region must not be sampled anymore
+        void Remove(uint32_t id);
+
+        /// @brief Copies every texture inserted since the last flush in one submission per page
+        bool Flush();
+
+        [[nodiscard]] const AtlasRegion* GetRegion(uint32_t id) const;
+
+        [[nodiscard]] size_t GetPageCount() const
+        {
+            return m_pages.size();
+        }
+
+        [[nodiscard]] float GetOccupancy(const size_t page) const
+        {
+            return page < m_pages.size() ? m_pages[page]->packer.GetOccupancy() : 0.0f;
+        }
+    private:
+        struct Page
+        {
+            ImageHandle image;
+            AtlasPacker packer;
+            /// @brief Areas waiting for Flush, by id
+            std::unordered_map<uint32_t, ImageArea> pending;
+        };
+
+        struct Entry
+        {
+            AtlasRect rect;
+            AtlasRegion region;
+        };
+
+        Device::RenderingDevice& m_device;
+
+        uint32_t m_pageSize = 2048;
+        uint32_t m_mipLevels = 4;
+        uint32_t m_maxTextureSize = 256;
+        bool m_srgb = true;
+
+        std::vector<std::unique_ptr<Page>> m_pages;
+        std::unordered_map<uint32_t, Entry> m_entries;
+        uint32_t m_nextId = 0;
+
+        [[nodiscard]] uint32_t GetPadding() const
+        {
+            return 1u << (m_mipLevels - 1);
+        }
+
+        Page* AddPage();
+    };
+}
@@ -0,0 +1,363 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "texture_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "texture.h"
+#include "../buffer/buffer.h"
+#include "context/rendering_device.h"
+#include "debug/logger.h"
+#include "tasks/thread_pool.h"
+
+namespace GyroEngine::Resources
+{
+    void TextureStreamer::Register(Texture* texture)
+    {
+        std::lock_guard lock(m_mutex);
+        m_textures.insert(texture);
+    }
+
+    void TextureStreamer::Unregister(Texture* texture)
+    {
+        std::lock_guard lock(m_mutex);
+        m_textures.erase(texture);
+        CancelLoads(texture);
+    }
+
+    void TextureStreamer::Retire(ImageHandle image)
+    {
+        std::lock_guard lock(m_mutex);
+        m_retiredImages.push_back({std::move(image), m_frame});
+    }
+
+    void TextureStreamer::Request(Texture& texture, const float screenSize) const
+    {
+        if (texture.m_requestFrame != m_frame)
+        {
+            texture.m_requestFrame = m_frame;
+            texture.m_requestedSize = 0.0f;
+        }
+        texture.m_requestedSize = std::max(texture.m_requestedSize, screenSize);
+    }
+
+    void TextureStreamer::Update(Device::RenderingDevice& device)
+    {
+        std::lock_guard lock(m_mutex);
+        m_device = &device;
+        const uint32_t framesInFlight = device.GetMaxFramesInFlight();
+        const uint64_t frame = m_frame++;
+        CompleteSubmissions(false);
+
+        // Replaced images go once no frame in flight can sample them anymore
+        m_retiredImages.erase(std::remove_if(m_retiredImages.begin(), m_retiredImages.end(),
+                                             [&](const RetiredImage& retired)
+                                             {
+                                                 return retired.frame + framesInFlight < frame;
+                                             }), m_retiredImages.end());
+
+        // Every texture aims for the detail it was asked for, sorted from the least to the most needed
+        struct Target
+        {
+            Texture* texture;
+            uint32_t mip;
+            float priority;
+        };
+        std::vector<Target> targets;
+        targets.reserve(m_textures.size());
+        VkDeviceSize wantedSize = 0;
+        for (Texture* texture : m_textures)
+        {
+            const uint32_t mip = GetWantedMip(*texture, frame, framesInFlight);
+            const float priority = texture->m_requestFrame + framesInFlight >= frame ? texture->m_requestedSize : 0.0f;
+            targets.push_back({texture, mip, priority});
+            wantedSize += texture->m_streamLayout.GetSize(mip);
+        }
+        std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b)
+        {
+            return a.priority < b.priority;
+        });
+
+        // Over the budget the least needed textures give their top levels up first, down to their base levels
+        if (m_budget != 0)
+        {
+            for (Target& target : targets)
+            {
+                while (wantedSize > m_budget && target.mip < target.texture->m_baseMip)
+                {
+                    wantedSize -= target.texture->m_streamLayout.levels[target.mip].length;
+                    ++target.mip;
+                }
+            }
+
+            // Warned once per overrun, it lasts as long as only base levels are resident
+            if (wantedSize > m_budget && !m_overBudget)
+            {
+                m_overBudget = true;
+                Logger::LogWarning("Streamed textures use {} bytes over their budget of {} bytes with only their base "
+                                   "levels resident", wantedSize - m_budget, m_budget);
+            }
+            else if (wantedSize <= m_budget)
+            {
+                m_overBudget = false;
+            }
+        }
+        for (const Target& target : targets)
+        {
+            target.texture->m_targetMip = target.mip;
+        }
+
+        // Finished loads swap in first, as far as their texture still wants them
+        Submission submission;
+        submission.frame = frame;
+        uint32_t changes = 0;
+        for (auto it = m_pendingLoads.begin(); it != m_pendingLoads.end() && changes < m_maxChangesPerFrame;)
+        {
+            if (it->task.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+
+            Texture* texture = it->texture;
+            it->task.get();
+            const uint32_t mip = std::max(it->mip, texture->m_targetMip);
+            if (!*it->loaded)
+            {
+                Logger::LogError("Failed to read the levels of texture {}", texture->GetTexturePath());
+            }
+            else if (mip < texture->m_residentMip &&
+                     Restream(submission, *texture, mip, std::move(it->staging), it->mip))
+            {
+                ++changes;
+            }
+            it = m_pendingLoads.erase(it);
+        }
+
+        // Evictions only copy what stays resident, no file has to be read
+        for (const Target& target : targets)
+        {
+            if (changes >= m_maxChangesPerFrame)
+            {
+                break;
+            }
+            if (target.mip <= target.texture->m_residentMip)
+            {
+                continue;
+            }
+            if (Restream(submission, *target.texture, target.mip, nullptr, target.mip))
+            {
+                ++changes;
+            }
+        }
+        Submit(submission);
+
+        // Loads start from the most needed texture
+        for (auto it = targets.rbegin(); it != targets.rend() && m_pendingLoads.size() < m_maxPendingLoads; ++it)
+        {
+            Texture* texture = it->texture;
+            const bool pending = std::any_of(m_pendingLoads.begin(), m_pendingLoads.end(),
+                                             [texture](const PendingLoad& load)
+                                             {
+                                                 return load.texture == texture;
+                                             });
+            if (it->mip < texture->m_residentMip && !pending && !StartLoad(*texture, it->mip))
+            {
+                Logger::LogError("Failed to start streaming level {} of texture {}", it->mip,
+                                 texture->GetTexturePath());
+            }
+        }
+    }
+
+    void TextureStreamer::Clear()
+    {
+        std::lock_guard lock(m_mutex);
+        for (PendingLoad& load : m_pendingLoads)
+        {
+            load.task.wait();
+        }
+        m_pendingLoads.clear();
+        if (m_device)
+        {
+            CompleteSubmissions(true);
+        }
+        m_retiredImages.clear();
+    }
+
+    VkDeviceSize TextureStreamer::GetResidentSize()
+    {
+        std::lock_guard lock(m_mutex);
+        VkDeviceSize residentSize = 0;
+        for (const Texture* texture : m_textures)
+        {
+            residentSize += texture->m_streamLayout.GetSize(texture->m_residentMip);
+        }
+        return residentSize;
+    }
+
+    uint32_t TextureStreamer::GetWantedMip(const Texture& texture, const uint64_t frame, const uint32_t framesInFlight)
+    {
+        // Requests fade after a few frames, textures nothing draws fall back to their base levels
+        if (texture.m_requestFrame + framesInFlight < frame || texture.m_requestedSize <= 0.0f)
+        {
+            return texture.m_baseMip;
+        }
+
+        // One texel per pixel, each level further halves the texels
+        const VkExtent3D extent = texture.m_streamLayout.extent;
+        const float texels = static_cast<float>(std::max(extent.width, extent.height));
+        const float ratio = texels / texture.m_requestedSize;
+        const auto mip = ratio <= 1.0f ? 0u : static_cast<uint32_t>(std::floor(std::log2(ratio)));
+        return std::min(mip, texture.m_baseMip);
+    }
+
+    bool TextureStreamer::Restream(Submission& submission, Texture& texture, const uint32_t mip,
+                                   std::unique_ptr<Buffer> staging, const uint32_t stagingMip)
+    {
+        VkDevice device = m_device->GetLogicalDevice();
+        if (submission.cmd == VK_NULL_HANDLE)
+        {
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = m_device->GetCommandPool();
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = 1;
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            if (vkAllocateCommandBuffers(device, &allocateInfo, &submission.cmd) != VK_SUCCESS ||
+                vkCreateFence(device, &fenceInfo, nullptr, &submission.fence) != VK_SUCCESS)
+            {
+                Logger::LogError("Failed to create the command buffer of the texture streaming copies");
+                if (submission.cmd != VK_NULL_HANDLE)
+                {
+                    vkFreeCommandBuffers(device, m_device->GetCommandPool(), 1, &submission.cmd);
+                    submission.cmd = VK_NULL_HANDLE;
+                }
+                return false;
+            }
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(submission.cmd, &beginInfo);
+        }
+
+        ImageHandle retired;
+        if (!texture.Restream(submission.cmd, mip, staging.get(), stagingMip, retired))
+        {
+            return false;
+        }
+        if (staging)
+        {
+            submission.staging.push_back(std::move(staging));
+        }
+        submission.images.push_back(texture.m_image);
+        if (retired)
+        {
+            submission.retired.push_back(std::move(retired));
+        }
+        return true;
+    }
+
+    void TextureStreamer::Submit(Submission& submission)
+    {
+        if (submission.cmd == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        vkEndCommandBuffer(submission.cmd);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &submission.cmd;
+        if (vkQueueSubmit(m_device->GetDeviceFamilies().GetGraphicsQueue().queue, 1, &submitInfo, submission.fence) !=
+            VK_SUCCESS)
+        {
+            // Nothing reads the replaced images, they only wait for the frames in flight
+            Logger::LogError("Failed to submit the texture streaming copies");
+            for (ImageHandle& image : submission.retired)
+            {
+                m_retiredImages.push_back({std::move(image), submission.frame});
+            }
+            vkDestroyFence(m_device->GetLogicalDevice(), submission.fence, nullptr);
+            vkFreeCommandBuffers(m_device->GetLogicalDevice(), m_device->GetCommandPool(), 1, &submission.cmd);
+            return;
+        }
+        m_submissions.push_back(std::move(submission));
+    }
+
+    void TextureStreamer::CompleteSubmissions(const bool wait)
+    {
+        VkDevice device = m_device->GetLogicalDevice();
+        while (!m_submissions.empty())
+        {
+            Submission& submission = m_submissions.front();
+            if (wait)
+            {
+                vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+            }
+            else if (vkGetFenceStatus(device, submission.fence) != VK_SUCCESS)
+            {
+                break;
+            }
+
+            // The copies read them, the frames in flight when they were replaced may still sample them
+            for (ImageHandle& image : submission.retired)
+            {
+                m_retiredImages.push_back({std::move(image), submission.frame});
+            }
+            vkDestroyFence(device, submission.fence, nullptr);
+            vkFreeCommandBuffers(device, m_device->GetCommandPool(), 1, &submission.cmd);
+            m_submissions.pop_front();
+        }
+    }
+
+    bool TextureStreamer::StartLoad(Texture& texture, const uint32_t mip)
+    {
+        auto staging = std::make_unique<Buffer>(texture.m_device);
+        staging->SetSize(texture.m_streamLayout.GetSize(mip))
+                .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+                .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+                .SetPersistentMapping(true)
+                .SetCategory(Device::MemoryCategory::Staging)
+                .SetDebugName(texture.GetTexturePath() + " streaming");
+        if (!staging->Init())
+        {
+            return false;
+        }
+
+        // The texture waits for its load in Unregister, so it outlives the task
+        PendingLoad load;
+        load.texture = &texture;
+        load.mip = mip;
+        load.loaded = std::make_shared<bool>(false);
+        load.task = ThreadPool::GetShared().Submit(
+            [target = &texture, buffer = staging.get(), mip, loaded = load.loaded]
+            {
+                *loaded = target->WriteStreamLevels(*buffer, mip);
+            });
+        load.staging = std::move(staging);
+        m_pendingLoads.push_back(std::move(load));
+        return true;
+    }
+
+    void TextureStreamer::CancelLoads(const Texture* texture)
+    {
+        for (auto it = m_pendingLoads.begin(); it != m_pendingLoads.end();)
+        {
+            if (it->texture != texture)
+            {
+                ++it;
+                continue;
+            }
+            it->task.wait();
+            it = m_pendingLoads.erase(it);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <volk.h>
+
+#include "image.h"
+#include "singleton.h"
+#include "../buffer/buffer.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Resources
+{
+    class Texture;
+
+    /// @brief Streams the mip levels of streamed textures in and out under a memory budget
+    /// @note Textures start with their low levels resident. Levels above them are read on the shared thread pool for
+    /// the textures covering the most pixels, and the least needed levels are evicted first once the budget is exceeded
+    /// The copies of an update are one submission with its own fence, nothing waits for the queue to go idle
+    class TextureStreamer : public Utils::ISingleton<TextureStreamer>
+    {
+        friend class ISingleton;
+    public:
+        /// @brief Levels this size and smaller are always resident
+        static constexpr uint32_t ResidentBaseSize = 128;
+
+        /// @brief Bytes of streamed texture levels allowed to stay resident, 0 for no limit
+        void SetBudget(const VkDeviceSize budget)
+        {
+            m_budget = budget;
+        }
+
+        /// @brief Textures whose levels change in one update, each change copies the texture's resident levels
+        void SetMaxChangesPerFrame(const uint32_t changes)
+        {
+            m_maxChangesPerFrame = changes;
+        }
+
+        /// @brief Level reads running on the thread pool at once
+        void SetMaxPendingLoads(const uint32_t loads)
+        {
+            m_maxPendingLoads = loads;
+        }
+
+        /// @brief Called by textures as they start and stop streaming
+        void Register(Texture* texture);
+        void Unregister(Texture* texture);
+
+        /// @brief Keeps a replaced image alive until no frame in flight can sample it anymore
+        void Retire(ImageHandle image);
+
+        /// @brief Asks for enough detail to cover screenSize pixels, the largest request of a frame wins
+        void Request(Texture& texture, float screenSize) const;
+
+        /// @brief Applies finished loads, evicts levels over the budget and starts loads for the most wanted textures
+        /// @note Replaced images stay alive for the device's frames in flight, those frames may still sample them
+        void Update(Device::RenderingDevice& device);
+
+        /// @brief Waits for pending loads and copies and destroys replaced images, call once the device is idle
+        void Clear();
+
+        [[nodiscard]] VkDeviceSize GetResidentSize();
+
+        [[nodiscard]] VkDeviceSize GetBudget() const
+        {
+            return m_budget;
+        }
+
+        [[nodiscard]] uint64_t GetFrame() const
+        {
+            return m_frame;
+        }
+    private:
+        struct PendingLoad
+        {
+            Texture* texture = nullptr;
+            uint32_t mip = 0;
+            std::unique_ptr<Buffer> staging;
+            /// @brief Set by the task, read once it's done
+            std::shared_ptr<bool> loaded;
+            std::future<void> task;
+        };
+
+        struct RetiredImage
+        {
+            ImageHandle image;
+            uint64_t frame = 0;
+        };
+
+        /// @brief Copies of one update, what they read and write stays alive until the fence signals
+        struct Submission
+        {
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            VkFence fence = VK_NULL_HANDLE;
+            uint64_t frame = 0;
+            std::vector<std::unique_ptr<Buffer>> staging;
+            std::vector<ImageHandle> images;
+            /// @brief Images the copies replaced, retired once the copies are done
+            std::vector<ImageHandle> retired;
+        };
+
+        TextureStreamer() = default;
+
+        std::mutex m_mutex;
+        std::unordered_set<Texture*> m_textures;
+        std::vector<PendingLoad> m_pendingLoads;
+        std::vector<RetiredImage> m_retiredImages;
+        std::deque<Submission> m_submissions;
+        Device::RenderingDevice* m_device = nullptr;
+        VkDeviceSize m_budget = 512ull * 1024ull * 1024ull;
+        uint32_t m_maxChangesPerFrame = 4;
+        uint32_t m_maxPendingLoads = 8;
+        uint64_t m_frame = 0;
+        bool m_overBudget = false;
+
+        /// @brief Level the texture should start at, from its latest request
+        [[nodiscard]] static uint32_t GetWantedMip(const Texture& texture, uint64_t frame, uint32_t framesInFlight);
+
+        /// @brief Records the texture's new levels into the submission, starting it on the first change
+        bool Restream(Submission& submission, Texture& texture, uint32_t mip, std::unique_ptr<Buffer> staging,
+                      uint32_t stagingMip);
+        void Submit(Submission& submission);
+        /// @brief Frees what completed submissions used and retires the images they replaced
+        void CompleteSubmissions(bool wait);
+
+        bool StartLoad(Texture& texture, uint32_t mip);
+        void CancelLoads(const Texture* texture);
+    };
+}
@@ -0,0 +1,363 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#include "texture_uploader.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "texture.h"
+#include "context/rendering_device.h"
+#include "debug/logger.h"
+#include "tasks/thread_pool.h"
+
+namespace GyroEngine::Resources
+{
+    // Copy offsets have to be multiples of the texel block size, 16 covers every format
+    static constexpr VkDeviceSize StagingAlignment = 16;
+
+    TextureUploader& TextureUploader::SetStagingSize(const VkDeviceSize size)
+    {
+        m_stagingSize = size;
+        return *this;
+    }
+
+    TextureUploader& TextureUploader::SetBatchSize(const uint32_t textures)
+    {
+        m_batchSize = std::max(textures, 1u);
+        return *this;
+    }
+
+    bool TextureUploader::Init()
+    {
+        m_staging = std::make_unique<Buffer>(m_device);
+        m_staging->SetSize(m_stagingSize)
+                .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+                .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+                .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+                .SetPersistentMapping(true)
+                .SetCategory(Device::MemoryCategory::Staging)
+                .SetDebugName("Texture upload ring");
+        if (!m_staging->Init())
+        {
+            Logger::LogError("Failed to create the texture upload ring");
+            m_staging.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void TextureUploader::Cleanup()
+    {
+        if (!m_staging)
+        {
+            return;
+        }
+        std::lock_guard lock(m_mutex);
+        for (const auto& job : m_jobs)
+        {
+            job->decode.wait();
+            job->promise.set_value(false);
+        }
+        m_jobs.clear();
+        CompleteBatches(true);
+        m_staging.reset();
+        m_stagingHead = 0;
+        m_stagingTail = 0;
+        m_stagingUsed = 0;
+    }
+
+    std::shared_future<bool> TextureUploader::Upload(Texture& texture)
+    {
+        Cancel(&texture);
+
+        std::lock_guard lock(m_mutex);
+        auto job = std::make_unique<Job>();
+        job->texture = &texture;
+        job->result = job->promise.get_future().share();
+        job->payload = std::make_shared<std::unique_ptr<TexturePayload>>();
+
+        // The texture cancels its job before it's destroyed, so it outlives the task
+        job->decode = ThreadPool::GetShared().Submit([target = &texture, payload = job->payload]
+        {
+            *payload = target->Decode();
+        });
+        std::shared_future<bool> result = job->result;
+        m_jobs.push_back(std::move(job));
+        return result;
+    }
+
+    void TextureUploader::Cancel(const Texture* texture)
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto it = m_jobs.begin(); it != m_jobs.end();)
+        {
+            if ((*it)->texture != texture)
+            {
+                ++it;
+                continue;
+            }
+            (*it)->decode.wait();
+            (*it)->promise.set_value(false);
+            it = m_jobs.erase(it);
+        }
+
+        // Submitted copies write the texture's image, they have to finish before it goes
+        for (Batch& batch : m_batches)
+        {
+            for (const auto& job : batch.jobs)
+            {
+                if (job->texture == texture)
+                {
+                    vkWaitForFences(m_device.GetLogicalDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+                    job->texture = nullptr;
+                }
+            }
+        }
+    }
+
+    void TextureUploader::Update()
+    {
+        std::lock_guard lock(m_mutex);
+        CompleteBatches(false);
+        SubmitBatch();
+    }
+
+    void TextureUploader::Flush()
+    {
+        while (!IsIdle())
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                for (const auto& job : m_jobs)
+                {
+                    job->decode.wait();
+                }
+                SubmitBatch();
+                CompleteBatches(true);
+            }
+        }
+    }
+
+    bool TextureUploader::IsIdle()
+    {
+        std::lock_guard lock(m_mutex);
+        return m_jobs.empty() && m_batches.empty();
+    }
+
+    bool TextureUploader::AllocateStaging(VkDeviceSize size, VkDeviceSize& offset, VkDeviceSize& used)
+    {
+        size = (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+        if (m_stagingUsed == 0)
+        {
+            m_stagingHead = 0;
+            m_stagingTail = 0;
+        }
+
+        // Free space is either [head, end) and [0, tail), or [head, tail) once the ring wrapped
+        if (m_stagingHead >= m_stagingTail && !(m_stagingHead == m_stagingTail && m_stagingUsed != 0))
+        {
+            if (m_stagingHead + size <= m_stagingSize)
+            {
+                offset = m_stagingHead;
+                used = size;
+            }
+            else if (size <= m_stagingTail)
+            {
+                offset = 0;
+                used = m_stagingSize - m_stagingHead + size;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (m_stagingHead + size <= m_stagingTail)
+        {
+            offset = m_stagingHead;
+            used = size;
+        }
+        else
+        {
+            return false;
+        }
+
+        m_stagingHead = offset + size;
+        m_stagingUsed += used;
+        return true;
+    }
+
+    void TextureUploader::CompleteBatches(const bool wait)
+    {
+        VkDevice device = m_device.GetLogicalDevice();
+        while (!m_batches.empty())
+        {
+            Batch& batch = m_batches.front();
+            if (wait)
+            {
+                vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            }
+            else if (vkGetFenceStatus(device, batch.fence) != VK_SUCCESS)
+            {
+                break;
+            }
+
+            for (const auto& job : batch.jobs)
+            {
+                job->promise.set_value(job->texture != nullptr);
+            }
+            m_stagingUsed -= batch.stagingUsed;
+            m_stagingTail = batch.stagingEnd;
+            vkDestroyFence(device, batch.fence, nullptr);
+            vkFreeCommandBuffers(device, m_device.GetCommandPool(), 1, &batch.cmd);
+            m_batches.pop_front();
+        }
+    }
+
+    void TextureUploader::SubmitBatch()
+    {
+        // Decoded textures are taken in the order they were queued, up to the batch size
+        Batch batch;
+        std::vector<std::unique_ptr<TexturePayload>> payloads;
+        for (auto it = m_jobs.begin(); it != m_jobs.end() && batch.jobs.size() < m_batchSize;)
+        {
+            if ((*it)->decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                break;
+            }
+            (*it)->decode.get();
+            std::unique_ptr<TexturePayload> payload = std::move(*(*it)->payload);
+            if (!payload || !(*it)->texture->PrepareUpload(*payload))
+            {
+                Logger::LogError("Failed to load texture {}", (*it)->texture->GetTexturePath());
+                (*it)->promise.set_value(false);
+                it = m_jobs.erase(it);
+                continue;
+            }
+            payloads.push_back(std::move(payload));
+            batch.jobs.push_back(std::move(*it));
+            it = m_jobs.erase(it);
+        }
+        if (batch.jobs.empty())
+        {
+            return;
+        }
+
+        VkDevice device = m_device.GetLogicalDevice();
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = m_device.GetCommandPool();
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkAllocateCommandBuffers(device, &allocateInfo, &batch.cmd) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+        {
+            Logger::LogError("Failed to create the command buffer of a texture upload batch");
+            if (batch.cmd != VK_NULL_HANDLE)
+            {
+                vkFreeCommandBuffers(device, m_device.GetCommandPool(), 1, &batch.cmd);
+            }
+            for (const auto& job : batch.jobs)
+            {
+                job->promise.set_value(false);
+            }
+            return;
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(batch.cmd, &beginInfo);
+
+        for (size_t i = 0; i < batch.jobs.size(); ++i)
+        {
+            const TexturePayload& payload = *payloads[i];
+            Image& image = *batch.jobs[i]->texture->GetImage();
+
+            // Staged in the ring, or in a buffer of its own when the ring is too small or still full
+            VkBuffer source = m_staging->GetBuffer();
+            VkDeviceSize offset = 0;
+            VkDeviceSize used = 0;
+            if (AllocateStaging(payload.size, offset, used))
+            {
+                m_staging->Write(offset, payload.data, payload.size);
+                m_staging->Flush(offset, payload.size);
+                batch.stagingUsed += used;
+                batch.stagingEnd = m_stagingHead;
+            }
+            else
+            {
+                auto buffer = std::make_unique<Buffer>(m_device);
+                buffer->SetSize(payload.size)
+                      .SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+                      .SetMemoryUsage(VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
+                      .SetSharingMode(VK_SHARING_MODE_EXCLUSIVE)
+                      .SetPersistentMapping(true)
+                      .SetCategory(Device::MemoryCategory::Staging)
+                      .SetDebugName(batch.jobs[i]->texture->GetTexturePath() + " staging");
+                if (!buffer->Init())
+                {
+                    Logger::LogError("Failed to stage texture {}", batch.jobs[i]->texture->GetTexturePath());
+                    batch.jobs[i]->texture = nullptr;
+                    continue;
+                }
+                buffer->Map(payload.data);
+                source = buffer->GetBuffer();
+                batch.buffers.push_back(std::move(buffer));
+            }
+
+            std::vector<VkBufferImageCopy> regions = payload.regions;
+            for (VkBufferImageCopy& region : regions)
+            {
+                region.bufferOffset += offset;
+            }
+            image.RecordLayout(batch.cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            vkCmdCopyBufferToImage(batch.cmd, source, image.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(regions.size()), regions.data());
+
+            // Chains are blitted inside the batch, the compute generator has one descriptor set and isn't batched
+            if (payload.generateMips && image.CanBlitMipmaps())
+            {
+                image.RecordMipmaps(batch.cmd);
+            }
+            else
+            {
+                if (payload.generateMips)
+                {
+                    Logger::LogError("Failed to generate the mip chain of texture {}",
+                                     batch.jobs[i]->texture->GetTexturePath());
+                }
+                image.RecordLayout(batch.cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+        }
+        vkEndCommandBuffer(batch.cmd);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.cmd;
+        if (vkQueueSubmit(m_device.GetDeviceFamilies().GetGraphicsQueue().queue, 1, &submitInfo, batch.fence) !=
+            VK_SUCCESS)
+        {
+            Logger::LogError("Failed to submit a texture upload batch");
+            vkDestroyFence(device, batch.fence, nullptr);
+            vkFreeCommandBuffers(device, m_device.GetCommandPool(), 1, &batch.cmd);
+            // Hands the batch's ring space back, the head returns to where the previous batch ends
+            m_stagingUsed -= batch.stagingUsed;
+            m_stagingHead = m_batches.empty() ? m_stagingTail : m_batches.back().stagingEnd;
+            for (const auto& job : batch.jobs)
+            {
+                job->promise.set_value(false);
+            }
+            return;
+        }
+        if (batch.stagingUsed == 0)
+        {
+            batch.stagingEnd = m_batches.empty() ? m_stagingTail : m_batches.back().stagingEnd;
+        }
+        m_batches.push_back(std::move(batch));
+    }
+}
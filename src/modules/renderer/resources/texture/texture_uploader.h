@@ -0,0 +1,141 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <volk.h>
+
+#include "../buffer/buffer.h"
+#include "utilities/image.h"
+#include "utilities/ktx.h"
+
+namespace GyroEngine::Device
+{
+    class RenderingDevice;
+}
+
+namespace GyroEngine::Resources
+{
+    class Texture;
+
+    /// @brief Texels of a texture file decoded on a worker thread, ready to be copied into an image
+    struct TexturePayload
+    {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent3D extent = {};
+        /// @brief Levels of the image, the ones the regions don't cover are generated
+        uint32_t mipLevels = 1;
+        bool generateMips = false;
+        const void* data = nullptr;
+        VkDeviceSize size = 0;
+        /// @brief Offsets relative to data
+        std::vector<VkBufferImageCopy> regions;
+
+        std::unique_ptr<Utils::Ktx::KtxData> ktxData;
+        Utils::Image::ImageData* imageData = nullptr;
+
+        TexturePayload() = default;
+        TexturePayload(const TexturePayload&) = delete;
+        TexturePayload& operator=(const TexturePayload&) = delete;
+
+        ~TexturePayload()
+        {
+            if (imageData)
+            {
+                stbi_image_free(imageData->data);
+                delete imageData;
+            }
+        }
+    };
+
+    /// @brief Decodes texture files on the shared thread pool and copies them to the GPU in batches
+    /// @note Staging memory comes from one persistently mapped ring, a batch of textures is a single submission with
+    /// its own fence, so nothing waits for the queue to go idle. Textures larger than the ring get their own buffer
+    class TextureUploader
+    {
+    public:
+        explicit TextureUploader(Device::RenderingDevice& device): m_device(device) {}
+        ~TextureUploader() { Cleanup(); }
+
+        /// @brief Bytes of the staging ring shared by every upload
+        TextureUploader& SetStagingSize(VkDeviceSize size);
+        /// @brief Most textures recorded into one submission
+        TextureUploader& SetBatchSize(uint32_t textures);
+
+        bool Init();
+        void Cleanup();
+
+        /// @brief Queues the texture's file for decoding, replacing an upload it already has queued
+        /// @return Ready once the texture's image holds the file's texels, false when it couldn't be loaded
+        std::shared_future<bool> Upload(Texture& texture);
+
+        /// @brief Drops the texture's queued upload, waiting for the work that already uses it
+        void Cancel(const Texture* texture);
+
+        /// @brief Completes batches the GPU finished and submits the textures decoded since, call once per frame
+        void Update();
+
+        /// @brief Blocks until every queued texture is uploaded
+        void Flush();
+
+        [[nodiscard]] bool IsIdle();
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return m_staging != nullptr;
+        }
+    private:
+        struct Job
+        {
+            Texture* texture = nullptr;
+            std::promise<bool> promise;
+            std::shared_future<bool> result;
+            /// @brief Set by the decode task, read once it's done
+            std::shared_ptr<std::unique_ptr<TexturePayload>> payload;
+            std::future<void> decode;
+        };
+
+        struct Batch
+        {
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            VkFence fence = VK_NULL_HANDLE;
+            /// @brief Ring bytes the batch holds, wrap-around padding included, and where they end
+            VkDeviceSize stagingUsed = 0;
+            VkDeviceSize stagingEnd = 0;
+            std::vector<std::unique_ptr<Job>> jobs;
+            /// @brief Staging of textures too large for the ring
+            std::vector<std::unique_ptr<Buffer>> buffers;
+        };
+
+        Device::RenderingDevice& m_device;
+
+        std::mutex m_mutex;
+        std::unique_ptr<Buffer> m_staging;
+        VkDeviceSize m_stagingSize = 64ull * 1024ull * 1024ull;
+        VkDeviceSize m_stagingHead = 0;
+        VkDeviceSize m_stagingTail = 0;
+        VkDeviceSize m_stagingUsed = 0;
+        uint32_t m_batchSize = 32;
+
+        /// @brief Decoding or decoded, in the order they were queued
+        std::list<std::unique_ptr<Job>> m_jobs;
+        /// @brief Submitted, completed in order since the ring frees in order
+        std::deque<Batch> m_batches;
+
+        /// @brief Carves size bytes out of the ring
+        /// @param used Receives the bytes taken, including the skipped end of the ring when it wraps
+        bool AllocateStaging(VkDeviceSize size, VkDeviceSize& offset, VkDeviceSize& used);
+
+        void CompleteBatches(bool wait);
+        void SubmitBatch();
+    };
+
+    using TextureUploaderHandle = std::shared_ptr<TextureUploader>;
+}
@@ -0,0 +1,510 @@
+//
+// Created by lepag on 7/23/2025.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "io/mapped_file.h"
+#include "mesh.h"
+
+namespace GyroEngine::Utils::Gltf
+{
+    static constexpr uint32_t GlbMagic = 0x46546C67; // "glTF"
+    static constexpr uint32_t JsonChunk = 0x4E4F534A; // "JSON"
+    static constexpr uint32_t BinaryChunk = 0x004E4942; // "BIN\0"
+
+    static constexpr uint32_t ComponentByte = 5120;
+    static constexpr uint32_t ComponentUnsignedByte = 5121;
+    static constexpr uint32_t ComponentShort = 5122;
+    static constexpr uint32_t ComponentUnsignedShort = 5123;
+    static constexpr uint32_t ComponentUnsignedInt = 5125;
+    static constexpr uint32_t ComponentFloat = 5126;
+
+    /// @brief Validated view of an accessor's elements inside the mapped binary chunk
+    struct Accessor
+    {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        /// @brief Bytes between consecutive elements, the element size when tightly packed
+        size_t stride = 0;
+        uint32_t componentType = 0;
+        uint32_t components = 0;
+        bool normalized = false;
+    };
+
+    /// @brief Array member of a JSON object without copying it, an empty array when it's missing
+    static const nlohmann::json& GetArray(const nlohmann::json& object, const char* name)
+    {
+        static const nlohmann::json empty = nlohmann::json::array();
+        const auto it = object.find(name);
+        return it != object.end() && it->is_array() ? *it : empty;
+    }
+
+    static size_t GetComponentSize(const uint32_t componentType)
+    {
+        switch (componentType)
+        {
+        case ComponentByte:
+        case ComponentUnsignedByte:
+            return 1;
+        case ComponentShort:
+        case ComponentUnsignedShort:
+            return 2;
+        case ComponentUnsignedInt:
+        case ComponentFloat:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    static uint32_t GetComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    /// @brief Resolves an accessor and checks that every element it addresses lies inside the binary chunk
+    /// @note Sparse accessors and accessors without a buffer view aren't supported
+    static std::optional<Accessor> GetAccessor(const nlohmann::json& document, const size_t index,
+                                               const uint8_t* binary, const size_t binarySize)
+    {
+        const auto& accessors = GetArray(document, "accessors");
+        if (index >= accessors.size())
+        {
+            return std::nullopt;
+        }
+
+        const auto& accessor = accessors[index];
+        if (accessor.contains("sparse") || !accessor.contains("bufferView"))
+        {
+            return std::nullopt;
+        }
+
+        const auto& bufferViews = GetArray(document, "bufferViews");
+        const auto viewIndex = accessor.value("bufferView", size_t{0});
+        if (viewIndex >= bufferViews.size())
+        {
+            return std::nullopt;
+        }
+        const auto& bufferView = bufferViews[viewIndex];
+
+        Accessor result;
+        result.componentType = accessor.value("componentType", 0u);
+        result.components = GetComponentCount(accessor.value("type", std::string()));
+        result.count = accessor.value("count", size_t{0});
+        result.normalized = accessor.value("normalized", false);
+
+        const size_t componentSize = GetComponentSize(result.componentType);
+        const size_t elementSize = componentSize * result.components;
+        if (elementSize == 0 || result.count == 0)
+        {
+            return std::nullopt;
+        }
+
+        // Only the GLB's own binary chunk is addressable, external buffers would need another file
+        const auto viewOffset = bufferView.value("byteOffset", size_t{0});
+        const auto viewLength = bufferView.value("byteLength", size_t{0});
+        result.stride = bufferView.value("byteStride", elementSize);
+        if (bufferView.value("buffer", size_t{0}) != 0 || viewOffset > binarySize ||
+            viewLength > binarySize - viewOffset || result.stride < elementSize)
+        {
+            return std::nullopt;
+        }
+
+        const auto accessorOffset = accessor.value("byteOffset", size_t{0});
+        if (accessorOffset > viewLength || elementSize > viewLength - accessorOffset ||
+            result.count - 1 > (viewLength - accessorOffset - elementSize) / result.stride)
+        {
+            return std::nullopt;
+        }
+
+        result.data = binary + viewOffset + accessorOffset;
+        return result;
+    }
+
+    static float ReadComponent(const uint8_t* data, const uint32_t componentType, const bool normalized)
+    {
+        switch (componentType)
+        {
+        case ComponentFloat:
+            {
+                float value;
+                std::memcpy(&value, data, sizeof(float));
+                return value;
+            }
+        case ComponentUnsignedByte:
+            return normalized ? static_cast<float>(*data) / 255.0f : static_cast<float>(*data);
+        case ComponentByte:
+            {
+                const auto value = static_cast<float>(static_cast<int8_t>(*data));
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+        case ComponentUnsignedShort:
+            {
+                uint16_t value;
+                std::memcpy(&value, data, sizeof(uint16_t));
+                return normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+            }
+        case ComponentShort:
+            {
+                int16_t value;
+                std::memcpy(&value, data, sizeof(int16_t));
+                return normalized ? std::max(static_cast<float>(value) / 32767.0f, -1.0f) : static_cast<float>(value);
+            }
+        default:
+            return 0.0f;
+        }
+    }
+
+    /// @brief Writes the first components of every element as floats, output advancing by outputStride bytes
+    /// @note Float data is copied element by element straight out of the mapping, everything else converted on the way
+    static void ConvertAttribute(const Accessor& accessor, uint8_t* output, const size_t outputStride,
+                                 const uint32_t components)
+    {
+        const uint32_t count = std::min(components, accessor.components);
+        if (accessor.componentType == ComponentFloat)
+        {
+            const size_t size = sizeof(float) * count;
+            for (size_t i = 0; i < accessor.count; ++i)
+            {
+                std::memcpy(output + i * outputStride, accessor.data + i * accessor.stride, size);
+            }
+            return;
+        }
+
+        const size_t componentSize = GetComponentSize(accessor.componentType);
+        for (size_t i = 0; i < accessor.count; ++i)
+        {
+            float values[4];
+            for (uint32_t c = 0; c < count; ++c)
+            {
+                values[c] = ReadComponent(accessor.data + i * accessor.stride + c * componentSize,
+                                          accessor.componentType, accessor.normalized);
+            }
+            std::memcpy(output + i * outputStride, values, sizeof(float) * count);
+        }
+    }
+
+    /// @brief Writes the accessor's indices offset by baseVertex, false when one is out of the vertex range
+    static bool ConvertIndices(const Accessor& accessor, uint32_t* output, const uint32_t baseVertex,
+                               const uint32_t vertexCount)
+    {
+        // Tightly packed 32-bit indices are already in the index buffer's layout
+        if (accessor.componentType == ComponentUnsignedInt && accessor.stride == sizeof(uint32_t))
+        {
+            std::memcpy(output, accessor.data, sizeof(uint32_t) * accessor.count);
+            for (size_t i = 0; i < accessor.count; ++i)
+            {
+                if (output[i] >= vertexCount)
+                {
+                    return false;
+                }
+                output[i] += baseVertex;
+            }
+            return true;
+        }
+
+        for (size_t i = 0; i < accessor.count; ++i)
+        {
+            const uint8_t* element = accessor.data + i * accessor.stride;
+            uint32_t index;
+            switch (accessor.componentType)
+            {
+            case ComponentUnsignedByte:
+                index = *element;
+                break;
+            case ComponentUnsignedShort:
+                {
+                    uint16_t value;
+                    std::memcpy(&value, element, sizeof(uint16_t));
+                    index = value;
+                    break;
+                }
+            case ComponentUnsignedInt:
+                std::memcpy(&index, element, sizeof(uint32_t));
+                break;
+            default:
+                return false;
+            }
+
+            if (index >= vertexCount)
+            {
+                return false;
+            }
+            output[i] = baseVertex + index;
+        }
+        return true;
+    }
+
+    /// @brief Accessors of one triangle primitive, resolved before anything gets allocated
+    struct Primitive
+    {
+        Accessor position;
+        std::optional<Accessor> normal;
+        std::optional<Accessor> texCoords;
+        std::optional<Accessor> tangent;
+        std::optional<Accessor> color;
+        std::optional<Accessor> indices;
+    };
+
+    /// @return False when an index points outside of the primitive's vertices
+    static bool ConvertPrimitive(const Primitive& primitive, Types::Vertex* vertices, uint32_t* indices,
+                                 const Types::Submesh& submesh)
+    {
+        auto* output = reinterpret_cast<uint8_t*>(vertices);
+        constexpr size_t stride = sizeof(Types::Vertex);
+        for (uint32_t i = 0; i < submesh.vertexCount; ++i)
+        {
+            vertices[i].normal = glm::vec3(0.0f);
+            vertices[i].texCoords = glm::vec2(0.0f);
+            vertices[i].tangent = glm::vec3(0.0f);
+            vertices[i].color = glm::vec4(1.0f);
+        }
+
+        ConvertAttribute(primitive.position, output + offsetof(Types::Vertex, position), stride, 3);
+        if (primitive.normal)
+        {
+            ConvertAttribute(*primitive.normal, output + offsetof(Types::Vertex, normal), stride, 3);
+        }
+        if (primitive.texCoords)
+        {
+            ConvertAttribute(*primitive.texCoords, output + offsetof(Types::Vertex, texCoords), stride, 2);
+            // Flipped like Assimp's glTF importer does, so models look the same whichever loader read them
+            for (uint32_t i = 0; i < submesh.vertexCount; ++i)
+            {
+                vertices[i].texCoords.y = 1.0f - vertices[i].texCoords.y;
+            }
+        }
+        if (primitive.tangent)
+        {
+            // The handedness in w is dropped, Vertex only keeps the direction
+            ConvertAttribute(*primitive.tangent, output + offsetof(Types::Vertex, tangent), stride, 3);
+        }
+        if (primitive.color)
+        {
+            ConvertAttribute(*primitive.color, output + offsetof(Types::Vertex, color), stride, 4);
+        }
+
+        if (primitive.indices)
+        {
+            if (!ConvertIndices(*primitive.indices, indices, submesh.firstVertex, submesh.vertexCount))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < submesh.indexCount; ++i)
+            {
+                indices[i] = submesh.firstVertex + i;
+            }
+        }
+
+        if (!primitive.normal)
+        {
+            Mesh::GenerateNormals(vertices, submesh.vertexCount, indices, submesh.indexCount, submesh.firstVertex);
+        }
+        if (!primitive.tangent)
+        {
+            Mesh::GenerateTangents(vertices, submesh.vertexCount, indices, submesh.indexCount, submesh.firstVertex);
+        }
+        return true;
+    }
+
+    /// @brief Reads the triangle meshes of a binary glTF straight out of the memory mapped file
+    /// @note Accessors are validated and decoded in a single pass into the merged vertex and index lists, one submesh
+    /// per primitive on the shared thread pool. Returns nullopt for files using features this loader doesn't cover
+    /// (external buffers, sparse accessors, strips and fans, required extensions), Assimp can still import those
+    static std::optional<Mesh::MeshFile> LoadGlb(const std::string& filePath)
+    {
+        MappedFile file;
+        if (!file.Open(filePath) || file.GetSize() < 20)
+        {
+            return std::nullopt;
+        }
+
+        const uint8_t* data = file.GetData();
+        uint32_t header[3];
+        std::memcpy(header, data, sizeof(header));
+        if (header[0] != GlbMagic || header[1] != 2 || header[2] > file.GetSize())
+        {
+            Logger::LogWarning("{} isn't a glTF 2.0 binary", filePath);
+            return std::nullopt;
+        }
+
+        // Chunks follow the header, JSON first and the binary buffer second
+        const uint8_t* json = nullptr;
+        size_t jsonSize = 0;
+        const uint8_t* binary = nullptr;
+        size_t binarySize = 0;
+        for (size_t offset = 12; offset + 8 <= header[2];)
+        {
+            uint32_t chunk[2];
+            std::memcpy(chunk, data + offset, sizeof(chunk));
+            if (chunk[0] > header[2] - offset - 8)
+            {
+                return std::nullopt;
+            }
+            if (chunk[1] == JsonChunk && !json)
+            {
+                json = data + offset + 8;
+                jsonSize = chunk[0];
+            }
+            else if (chunk[1] == BinaryChunk && !binary)
+            {
+                binary = data + offset + 8;
+                binarySize = chunk[0];
+            }
+            offset += 8 + (static_cast<size_t>(chunk[0]) + 3) / 4 * 4;
+        }
+        if (!json)
+        {
+            return std::nullopt;
+        }
+
+        const auto document = nlohmann::json::parse(json, json + jsonSize, nullptr, false);
+        if (document.is_discarded() || !document.is_object())
+        {
+            Logger::LogWarning("{} has a malformed glTF document", filePath);
+            return std::nullopt;
+        }
+        if (!GetArray(document, "extensionsRequired").empty())
+        {
+            return std::nullopt;
+        }
+
+        Mesh::MeshFile meshFile;
+        for (const auto& material : GetArray(document, "materials"))
+        {
+            meshFile.materialSlots.push_back(material.value("name", std::string()));
+        }
+
+        // Resolve and validate every primitive first, so the merged arrays are allocated exactly once
+        std::vector<Primitive> primitives;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for (const auto& mesh : GetArray(document, "meshes"))
+        {
+            for (const auto& primitive : GetArray(mesh, "primitives"))
+            {
+                const auto mode = primitive.value("mode", 4u);
+                if (mode < 4)
+                {
+                    // Points and lines, skipped like the Assimp import does
+                    continue;
+                }
+                if (mode != 4)
+                {
+                    return std::nullopt;
+                }
+
+                const auto attributes = primitive.value("attributes", nlohmann::json::object());
+                const auto getAccessor = [&](const char* name) -> std::optional<Accessor>
+                {
+                    if (!attributes.contains(name))
+                    {
+                        return std::nullopt;
+                    }
+                    return GetAccessor(document, attributes[name].get<size_t>(), binary, binarySize);
+                };
+
+                Primitive resolved;
+                const auto position = getAccessor("POSITION");
+                if (!position || position->components != 3 || position->componentType != ComponentFloat)
+                {
+                    Logger::LogWarning("{} has a primitive without valid positions", filePath);
+                    return std::nullopt;
+                }
+                resolved.position = *position;
+                resolved.normal = getAccessor("NORMAL");
+                resolved.texCoords = getAccessor("TEXCOORD_0");
+                resolved.tangent = getAccessor("TANGENT");
+                resolved.color = getAccessor("COLOR_0");
+
+                // Attributes present in the document but failing validation would otherwise be silently dropped
+                const auto isValid = [&](const char* name, const std::optional<Accessor>& accessor)
+                {
+                    return !attributes.contains(name) || (accessor && accessor->count == position->count);
+                };
+                if (!isValid("NORMAL", resolved.normal) || !isValid("TEXCOORD_0", resolved.texCoords) ||
+                    !isValid("TANGENT", resolved.tangent) || !isValid("COLOR_0", resolved.color))
+                {
+                    Logger::LogWarning("{} has an invalid vertex attribute accessor", filePath);
+                    return std::nullopt;
+                }
+
+                Types::Submesh submesh;
+                submesh.firstVertex = static_cast<uint32_t>(vertexCount);
+                submesh.vertexCount = static_cast<uint32_t>(position->count);
+                submesh.firstIndex = static_cast<uint32_t>(indexCount);
+                submesh.materialSlot = primitive.value("material", 0u);
+                if (primitive.contains("indices"))
+                {
+                    resolved.indices = GetAccessor(document, primitive["indices"].get<size_t>(), binary, binarySize);
+                    if (!resolved.indices || resolved.indices->components != 1)
+                    {
+                        Logger::LogWarning("{} has an invalid index accessor", filePath);
+                        return std::nullopt;
+                    }
+                    submesh.indexCount = static_cast<uint32_t>(resolved.indices->count);
+                }
+                else
+                {
+                    submesh.indexCount = submesh.vertexCount;
+                }
+                if (submesh.indexCount % 3 != 0)
+                {
+                    return std::nullopt;
+                }
+
+                vertexCount += submesh.vertexCount;
+                indexCount += submesh.indexCount;
+                if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+                {
+                    return std::nullopt;
+                }
+                meshFile.submeshes.push_back(submesh);
+                primitives.push_back(resolved);
+            }
+        }
+
+        meshFile.vertices.resize(vertexCount);
+        meshFile.indices.resize(indexCount);
+        std::vector<uint8_t> valid(primitives.size(), 1);
+        ThreadPool::GetShared().ParallelFor(primitives.size(), [&](const size_t i)
+        {
+            const Types::Submesh& submesh = meshFile.submeshes[i];
+            valid[i] = ConvertPrimitive(primitives[i], &meshFile.vertices[submesh.firstVertex],
+                                        &meshFile.indices[submesh.firstIndex], submesh);
+        });
+
+        if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+        {
+            Logger::LogWarning("{} has indices outside of their primitive's vertices", filePath);
+            return std::nullopt;
+        }
+        return meshFile;
+    }
+
+    static bool IsGlb(const std::string& filePath)
+    {
+        std::string extension = std::filesystem::path(filePath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".glb";
+    }
+}
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <volk.h>
 
+#include "image_kernels.h"
 #include "implementation/stb_implementation.h"
 
 namespace GyroEngine::Utils::Image
@@ -18,13 +20,16 @@ namespace GyroEngine::Utils::Image
         void* data;
     };
 
-    static ImageData* LoadImageData(const std::string& filePath, const int width, const int height)
+    /// @brief Loads an image as RGBA8, resized to width x height when both are set
+    /// @note srgb picks how a resize filters the pixels, it must match the format the image is uploaded as
+    static ImageData* LoadImageData(const std::string& filePath, const int width, const int height, const bool srgb)
 {
     stbi_set_flip_vertically_on_load(true);
     const int outputChannels = 4; // Always force RGBA
 
+    // Loaded with the file's own channels, RGB is expanded here rather than by stb's per-pixel conversion
     auto imageData = new ImageData();
-    imageData->data = stbi_load(filePath.c_str(), &imageData->width, &imageData->height, &imageData->channels, outputChannels);
+    imageData->data = stbi_load(filePath.c_str(), &imageData->width, &imageData->height, &imageData->channels, 0);
 
     if (!imageData->data)
     {
@@ -41,13 +46,29 @@ namespace GyroEngine::Utils::Image
         return nullptr; // Unsupported number of channels
     }
 
-    // Always use outputChannels for buffer size and stbir_resize!
+    const size_t pixelCount = static_cast<size_t>(imageData->width) * imageData->height;
+    if (imageData->channels == 3)
+    {
+        auto expandedData = static_cast<uint8_t*>(malloc(pixelCount * outputChannels));
+        if (!expandedData)
+        {
+            stbi_image_free(imageData->data);
+            delete imageData;
+            Logger::LogError("Failed to allocate memory for expanded image at path: {}", filePath);
+            return nullptr;
+        }
+        ExpandRgbToRgba(static_cast<const uint8_t*>(imageData->data), expandedData, pixelCount);
+        stbi_image_free(imageData->data);
+        imageData->data = expandedData;
+    }
+
+    // Always use outputChannels for buffer size
     const bool shouldResize = (width > 0 && height > 0) &&
                 (imageData->width != width || imageData->height != height);
     if (shouldResize)
     {
         // Allocate buffer for resized image
-        auto resizedData = static_cast<unsigned char *>(malloc(width * height * outputChannels));
+        auto resizedData = static_cast<unsigned char *>(malloc(static_cast<size_t>(width) * height * outputChannels));
         if (!resizedData)
         {
             stbi_image_free(const_cast<void*>(imageData->data));
@@ -56,21 +77,8 @@ namespace GyroEngine::Utils::Image
             return nullptr;
         }
 
-        int inputStride = imageData->width * outputChannels;
-        int outputStride = width * outputChannels;
-        stbir_pixel_layout layout = STBIR_RGBA;
-
-        unsigned char* result = stbir_resize_uint8_srgb(
-            static_cast<const unsigned char*>(imageData->data),
-            imageData->width,
-            imageData->height,
-            inputStride,
-            resizedData,
-            width,
-            height,
-            outputStride,
-            layout
-        );
+        const bool result = ResizeRgba8(static_cast<const uint8_t*>(imageData->data), imageData->width,
+                                        imageData->height, resizedData, width, height, srgb);
 
         stbi_image_free(imageData->data);
 
@@ -110,6 +118,47 @@ namespace GyroEngine::Utils::Image
         }
     }
 
+    /// @brief Levels of a full mip chain, down to 1x1
+    static uint32_t GetMipLevelCount(const uint32_t width, const uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+        {
+            ++levels;
+        }
+        return levels;
+    }
+
+    static bool IsSrgbFormat(const VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_R8_SRGB:
+            case VK_FORMAT_R8G8_SRGB:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /// @brief Same texel layout without the sRGB encoding, e.g. for storage views which can't be sRGB
+    static VkFormat GetUnormFormat(const VkFormat format)
+    {
+        switch (format) {
+            case VK_FORMAT_R8_SRGB:
+                return VK_FORMAT_R8_UNORM;
+            case VK_FORMAT_R8G8_SRGB:
+                return VK_FORMAT_R8G8_UNORM;
+            case VK_FORMAT_R8G8B8A8_SRGB:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return VK_FORMAT_B8G8R8A8_UNORM;
+            default:
+                return format;
+        }
+    }
+
     static uint32_t GetSourceAccessMask(VkImageLayout src)
     {
         switch (src) {
@@ -0,0 +1,707 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GYRO_IMAGE_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define GYRO_IMAGE_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// AVX2 paths are compiled for every x86 build and only taken when the CPU has AVX2, the rest of the build keeps its
+// baseline instruction set
+#if defined(GYRO_IMAGE_KERNELS_X86) && (!defined(_MSC_VER) || defined(__clang__))
+#define GYRO_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define GYRO_TARGET_AVX2
+#endif
+
+namespace GyroEngine::Utils::Image
+{
+    /// @brief Filter used by ResizeRgba8
+    enum class ResizeFilter
+    {
+        /// @brief Averages the texels each output texel covers, fast and soft
+        Box,
+        /// @brief Sharper, rings slightly around hard edges
+        Lanczos3
+    };
+
+    /// @brief Whether the AVX2 paths of the kernels are taken on this CPU
+    static bool HasAvx2()
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86) && defined(_MSC_VER)
+        static const bool avx2 = []
+        {
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+            __cpuid(info, 1);
+            const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            __cpuidex(info, 7, 0);
+            return osSavesAvx && fma && (info[1] & (1 << 5)) != 0;
+        }();
+        return avx2;
+#elif defined(GYRO_IMAGE_KERNELS_X86)
+        static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return avx2;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief Lookup tables shared by the sRGB conversions
+    struct SrgbTables
+    {
+        /// @brief Smallest value the linear to sRGB table covers, anything below encodes to 0
+        static constexpr float MinLinear = 1.0f / 8192.0f;
+        /// @brief Float bits of MinLinear shifted down to the table index
+        static constexpr uint32_t IndexBias = (127 - 13) << 8;
+
+        /// @brief sRGB bytes to linear values, followed by plain bytes to [0, 1] for alpha
+        float toLinear[512];
+        /// @brief Indexed by the exponent and the top 8 mantissa bits of a linear value in [MinLinear, 1)
+        uint32_t toSrgb[13 * 256];
+    };
+
+    static uint8_t EncodeSrgbExact(const float linear)
+    {
+        const float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+
+    static const SrgbTables& GetSrgbTables()
+    {
+        static const SrgbTables tables = []
+        {
+            SrgbTables result{};
+            for (int i = 0; i < 256; ++i)
+            {
+                const float value = static_cast<float>(i) / 255.0f;
+                result.toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+                result.toLinear[256 + i] = value;
+            }
+
+            // Each bucket spans 1/256 of an octave, the middle of it is off by at most one step at either end
+            for (int i = 0; i < 13 * 256; ++i)
+            {
+                const int exponent = i / 256 - 13;
+                const float low = std::ldexp(1.0f + static_cast<float>(i % 256) / 256.0f, exponent);
+                const float high = std::ldexp(1.0f + static_cast<float>(i % 256 + 1) / 256.0f, exponent);
+                result.toSrgb[i] = EncodeSrgbExact(0.5f * (low + high));
+            }
+            return result;
+        }();
+        return tables;
+    }
+
+    static uint8_t EncodeSrgb(const SrgbTables& tables, const float linear)
+    {
+        // Written so NaN falls to the lower bound
+        const float clamped = std::min(linear > SrgbTables::MinLinear ? linear : SrgbTables::MinLinear, 0.99999994f);
+        uint32_t bits;
+        std::memcpy(&bits, &clamped, sizeof(bits));
+        return static_cast<uint8_t>(tables.toSrgb[(bits >> 15) - SrgbTables::IndexBias]);
+    }
+
+    static uint8_t EncodeUnorm(const float value)
+    {
+        return static_cast<uint8_t>(std::min(value > 0.0f ? value : 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    // RGB to RGBA
+
+    static void ExpandRgbToRgbaScalar(const uint8_t* src, uint8_t* dst, const size_t pixels)
+    {
+        for (size_t i = 0; i < pixels; ++i)
+        {
+            dst[i * 4 + 0] = src[i * 3 + 0];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 2];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+#if defined(GYRO_IMAGE_KERNELS_X86)
+    GYRO_TARGET_AVX2 static void ExpandRgbToRgbaAvx2(const uint8_t* src, uint8_t* dst, const size_t pixels)
+    {
+        // 16 pixels are 48 source bytes, each quarter of them is spread into 4 RGBA pixels
+        const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 32));
+            __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+            _mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(a, spread), alpha));
+            _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), spread), alpha));
+            _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), spread), alpha));
+            _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), spread), alpha));
+        }
+        ExpandRgbToRgbaScalar(src + i * 3, dst + i * 4, pixels - i);
+    }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+    static void ExpandRgbToRgbaNeon(const uint8_t* src, uint8_t* dst, const size_t pixels)
+    {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+            uint8x16x4_t rgba;
+            rgba.val[0] = rgb.val[0];
+            rgba.val[1] = rgb.val[1];
+            rgba.val[2] = rgb.val[2];
+            rgba.val[3] = vdupq_n_u8(255);
+            vst4q_u8(dst + i * 4, rgba);
+        }
+        ExpandRgbToRgbaScalar(src + i * 3, dst + i * 4, pixels - i);
+    }
+#endif
+
+    /// @brief Adds an opaque alpha channel to tightly packed RGB8 pixels
+    static void ExpandRgbToRgba(const uint8_t* src, uint8_t* dst, const size_t pixels)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            ExpandRgbToRgbaAvx2(src, dst, pixels);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        ExpandRgbToRgbaNeon(src, dst, pixels);
+        return;
+#endif
+        ExpandRgbToRgbaScalar(src, dst, pixels);
+    }
+
+    // sRGB to linear
+
+    static void SrgbToLinearScalar(const uint8_t* src, float* dst, const size_t pixels)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+        for (size_t i = 0; i < pixels * 4; i += 4)
+        {
+            dst[i + 0] = tables.toLinear[src[i + 0]];
+            dst[i + 1] = tables.toLinear[src[i + 1]];
+            dst[i + 2] = tables.toLinear[src[i + 2]];
+            dst[i + 3] = tables.toLinear[256 + src[i + 3]];
+        }
+    }
+
+#if defined(GYRO_IMAGE_KERNELS_X86)
+    GYRO_TARGET_AVX2 static void SrgbToLinearAvx2(const uint8_t* src, float* dst, const size_t pixels)
+    {
+        const float* table = GetSrgbTables().toLinear;
+        const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+        size_t i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            const __m256i low = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), alphaOffset);
+            const __m256i high = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), alphaOffset);
+            _mm256_storeu_ps(dst + i * 4, _mm256_i32gather_ps(table, low, 4));
+            _mm256_storeu_ps(dst + i * 4 + 8, _mm256_i32gather_ps(table, high, 4));
+        }
+        SrgbToLinearScalar(src + i * 4, dst + i * 4, pixels - i);
+    }
+#endif
+
+    /// @brief Decodes sRGB encoded RGBA8 pixels to linear floats, alpha is only scaled to [0, 1]
+    /// @note NEON has no gather, the scalar table lookup is already the fast path there
+    static void SrgbToLinear(const uint8_t* src, float* dst, const size_t pixels)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            SrgbToLinearAvx2(src, dst, pixels);
+            return;
+        }
+#endif
+        SrgbToLinearScalar(src, dst, pixels);
+    }
+
+    // Linear to sRGB
+
+    static void LinearToSrgbScalar(const float* src, uint8_t* dst, const size_t pixels)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+        for (size_t i = 0; i < pixels * 4; i += 4)
+        {
+            dst[i + 0] = EncodeSrgb(tables, src[i + 0]);
+            dst[i + 1] = EncodeSrgb(tables, src[i + 1]);
+            dst[i + 2] = EncodeSrgb(tables, src[i + 2]);
+            dst[i + 3] = EncodeUnorm(src[i + 3]);
+        }
+    }
+
+#if defined(GYRO_IMAGE_KERNELS_X86)
+    GYRO_TARGET_AVX2 static void LinearToSrgbAvx2(const float* src, uint8_t* dst, const size_t pixels)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+        const __m256 minLinear = _mm256_set1_ps(SrgbTables::MinLinear);
+        const __m256 maxLinear = _mm256_set1_ps(0.99999994f);
+        const __m256i bias = _mm256_set1_epi32(static_cast<int>(SrgbTables::IndexBias));
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        size_t i = 0;
+        for (; i + 2 <= pixels; i += 2)
+        {
+            const __m256 value = _mm256_loadu_ps(src + i * 4);
+
+            // Color goes through the table, max takes its second operand for NaN
+            const __m256 clamped = _mm256_min_ps(_mm256_max_ps(value, minLinear), maxLinear);
+            const __m256i index = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(clamped), 15), bias);
+            const __m256i color = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.toSrgb), index, 4);
+
+            const __m256 alpha = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(value, zero), one), scale);
+            const __m256i texels = _mm256_blend_epi32(color, _mm256_cvtps_epi32(alpha), 0x88);
+
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(texels), _mm256_extracti128_si256(texels, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(words, words));
+        }
+        LinearToSrgbScalar(src + i * 4, dst + i * 4, pixels - i);
+    }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+    static void LinearToSrgbNeon(const float* src, uint8_t* dst, const size_t pixels)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+        const float32x4_t minLinear = vdupq_n_f32(SrgbTables::MinLinear);
+        const float32x4_t maxLinear = vdupq_n_f32(0.99999994f);
+        const uint32x4_t bias = vdupq_n_u32(SrgbTables::IndexBias);
+        for (size_t i = 0; i < pixels; ++i)
+        {
+            // Indices are computed four at a time, the lookups stay scalar
+            const float32x4_t value = vld1q_f32(src + i * 4);
+            const float32x4_t clamped = vminq_f32(vmaxq_f32(value, minLinear), maxLinear);
+            uint32_t index[4];
+            vst1q_u32(index, vsubq_u32(vshrq_n_u32(vreinterpretq_u32_f32(clamped), 15), bias));
+            dst[i * 4 + 0] = static_cast<uint8_t>(tables.toSrgb[index[0]]);
+            dst[i * 4 + 1] = static_cast<uint8_t>(tables.toSrgb[index[1]]);
+            dst[i * 4 + 2] = static_cast<uint8_t>(tables.toSrgb[index[2]]);
+            dst[i * 4 + 3] = EncodeUnorm(vgetq_lane_f32(value, 3));
+        }
+    }
+#endif
+
+    /// @brief Encodes linear float RGBA pixels to sRGB RGBA8, alpha is only scaled to [0, 255]
+    /// @note Values are clamped to [0, 1], the table is within one step of the exact encoding
+    static void LinearToSrgb(const float* src, uint8_t* dst, const size_t pixels)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            LinearToSrgbAvx2(src, dst, pixels);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        LinearToSrgbNeon(src, dst, pixels);
+        return;
+#endif
+        LinearToSrgbScalar(src, dst, pixels);
+    }
+
+    // UNORM
+
+    /// @brief Scales UNORM RGBA8 pixels to [0, 1] floats, for data that isn't sRGB encoded
+    static void UnormToFloat(const uint8_t* src, float* dst, const size_t pixels)
+    {
+        for (size_t i = 0; i < pixels * 4; ++i)
+        {
+            dst[i] = static_cast<float>(src[i]) * (1.0f / 255.0f);
+        }
+    }
+
+    /// @brief Encodes [0, 1] float RGBA pixels to UNORM RGBA8, values outside are clamped
+    static void FloatToUnorm(const float* src, uint8_t* dst, const size_t pixels)
+    {
+        for (size_t i = 0; i < pixels * 4; ++i)
+        {
+            dst[i] = EncodeUnorm(src[i]);
+        }
+    }
+
+    // Premultiplied alpha
+
+    static void PremultiplyAlphaScalar(float* pixels, const size_t count)
+    {
+        for (size_t i = 0; i < count * 4; i += 4)
+        {
+            pixels[i + 0] *= pixels[i + 3];
+            pixels[i + 1] *= pixels[i + 3];
+            pixels[i + 2] *= pixels[i + 3];
+        }
+    }
+
+    static void UnpremultiplyAlphaScalar(float* pixels, const size_t count)
+    {
+        for (size_t i = 0; i < count * 4; i += 4)
+        {
+            if (pixels[i + 3] > 0.0f)
+            {
+                const float inverse = 1.0f / pixels[i + 3];
+                pixels[i + 0] *= inverse;
+                pixels[i + 1] *= inverse;
+                pixels[i + 2] *= inverse;
+            }
+        }
+    }
+
+#if defined(GYRO_IMAGE_KERNELS_X86)
+    GYRO_TARGET_AVX2 static void PremultiplyAlphaAvx2(float* pixels, const size_t count)
+    {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m256 value = _mm256_loadu_ps(pixels + i * 4);
+            const __m256 alpha = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+            _mm256_storeu_ps(pixels + i * 4, _mm256_blend_ps(_mm256_mul_ps(value, alpha), value, 0x88));
+        }
+        PremultiplyAlphaScalar(pixels + i * 4, count - i);
+    }
+
+    GYRO_TARGET_AVX2 static void UnpremultiplyAlphaAvx2(float* pixels, const size_t count)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m256 value = _mm256_loadu_ps(pixels + i * 4);
+            const __m256 alpha = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256 divided = _mm256_blendv_ps(value, _mm256_div_ps(value, alpha),
+                                                    _mm256_cmp_ps(alpha, zero, _CMP_GT_OQ));
+            _mm256_storeu_ps(pixels + i * 4, _mm256_blend_ps(divided, value, 0x88));
+        }
+        UnpremultiplyAlphaScalar(pixels + i * 4, count - i);
+    }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+    static void PremultiplyAlphaNeon(float* pixels, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float32x4_t value = vld1q_f32(pixels + i * 4);
+            const float alpha = vgetq_lane_f32(value, 3);
+            vst1q_f32(pixels + i * 4, vsetq_lane_f32(alpha, vmulq_n_f32(value, alpha), 3));
+        }
+    }
+
+    static void UnpremultiplyAlphaNeon(float* pixels, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float32x4_t value = vld1q_f32(pixels + i * 4);
+            const float alpha = vgetq_lane_f32(value, 3);
+            if (alpha > 0.0f)
+            {
+                vst1q_f32(pixels + i * 4, vsetq_lane_f32(alpha, vmulq_n_f32(value, 1.0f / alpha), 3));
+            }
+        }
+    }
+#endif
+
+    /// @brief Multiplies the color of float RGBA pixels by their alpha, so filtering doesn't bleed hidden colors
+    static void PremultiplyAlpha(float* pixels, const size_t count)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            PremultiplyAlphaAvx2(pixels, count);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        PremultiplyAlphaNeon(pixels, count);
+        return;
+#endif
+        PremultiplyAlphaScalar(pixels, count);
+    }
+
+    /// @brief Divides the color of float RGBA pixels by their alpha, fully transparent pixels are left as they are
+    static void UnpremultiplyAlpha(float* pixels, const size_t count)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            UnpremultiplyAlphaAvx2(pixels, count);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        UnpremultiplyAlphaNeon(pixels, count);
+        return;
+#endif
+        UnpremultiplyAlphaScalar(pixels, count);
+    }
+
+    // Resizing
+
+    /// @brief Source texels and weights of every output texel along one axis
+    struct ResizeWeights
+    {
+        /// @brief Most source texels an output texel reads, the stride of weights
+        int taps = 0;
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<float> weights;
+    };
+
+    static float EvaluateLanczos3(const float x)
+    {
+        constexpr float pi = 3.14159265358979f;
+        if (std::abs(x) < 1e-6f)
+        {
+            return 1.0f;
+        }
+        if (std::abs(x) >= 3.0f)
+        {
+            return 0.0f;
+        }
+        return 3.0f * std::sin(pi * x) * std::sin(pi * x / 3.0f) / (pi * pi * x * x);
+    }
+
+    static ResizeWeights BuildResizeWeights(const int srcSize, const int dstSize, const ResizeFilter filter)
+    {
+        // Downscaling widens the filter so every source texel contributes
+        const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+        const float filterScale = std::max(scale, 1.0f);
+        const float support = (filter == ResizeFilter::Box ? 0.5f : 3.0f) * filterScale;
+
+        ResizeWeights result;
+        result.taps = static_cast<int>(std::ceil(support * 2.0f)) + 2;
+        result.first.resize(dstSize);
+        result.count.resize(dstSize);
+        result.weights.assign(static_cast<size_t>(dstSize) * result.taps, 0.0f);
+        for (int i = 0; i < dstSize; ++i)
+        {
+            const float center = (static_cast<float>(i) + 0.5f) * scale;
+            const int low = static_cast<int>(std::floor(center - support));
+            const int high = static_cast<int>(std::ceil(center + support));
+            const int first = std::clamp(low, 0, srcSize - 1);
+            float* weights = result.weights.data() + static_cast<size_t>(i) * result.taps;
+
+            // Texels past the edges repeat the edge texel
+            float sum = 0.0f;
+            int last = first;
+            for (int j = low; j < high; ++j)
+            {
+                float weight;
+                if (filter == ResizeFilter::Box)
+                {
+                    const float start = std::max(static_cast<float>(j), center - support);
+                    const float end = std::min(static_cast<float>(j + 1), center + support);
+                    weight = std::max(end - start, 0.0f);
+                }
+                else
+                {
+                    weight = EvaluateLanczos3((static_cast<float>(j) + 0.5f - center) / filterScale);
+                }
+                const int source = std::clamp(j, 0, srcSize - 1);
+                weights[source - first] += weight;
+                last = std::max(last, source);
+                sum += weight;
+            }
+
+            result.first[i] = first;
+            result.count[i] = last - first + 1;
+            if (sum != 0.0f)
+            {
+                for (int k = 0; k < result.count[i]; ++k)
+                {
+                    weights[k] /= sum;
+                }
+            }
+        }
+        return result;
+    }
+
+    static void ResampleRowScalar(const float* src, const ResizeWeights& weights, float* dst, const int width)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float* texel = src + static_cast<size_t>(weights.first[x]) * 4;
+            const float* weight = weights.weights.data() + static_cast<size_t>(x) * weights.taps;
+            float sum[4] = {};
+            for (int k = 0; k < weights.count[x]; ++k)
+            {
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    sum[channel] += texel[k * 4 + channel] * weight[k];
+                }
+            }
+            std::memcpy(dst + static_cast<size_t>(x) * 4, sum, sizeof(sum));
+        }
+    }
+
+    static void AccumulateRowScalar(const float* src, const float weight, float* dst, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] += src[i] * weight;
+        }
+    }
+
+#if defined(GYRO_IMAGE_KERNELS_X86)
+    GYRO_TARGET_AVX2 static void ResampleRowAvx2(const float* src, const ResizeWeights& weights, float* dst,
+                                                 const int width)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float* texel = src + static_cast<size_t>(weights.first[x]) * 4;
+            const float* weight = weights.weights.data() + static_cast<size_t>(x) * weights.taps;
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < weights.count[x]; ++k)
+            {
+                sum = _mm_fmadd_ps(_mm_loadu_ps(texel + k * 4), _mm_set1_ps(weight[k]), sum);
+            }
+            _mm_storeu_ps(dst + static_cast<size_t>(x) * 4, sum);
+        }
+    }
+
+    GYRO_TARGET_AVX2 static void AccumulateRowAvx2(const float* src, const float weight, float* dst,
+                                                   const size_t count)
+    {
+        const __m256 scale = _mm256_set1_ps(weight);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(src + i), scale, _mm256_loadu_ps(dst + i)));
+        }
+        AccumulateRowScalar(src + i, weight, dst + i, count - i);
+    }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+    static void ResampleRowNeon(const float* src, const ResizeWeights& weights, float* dst, const int width)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float* texel = src + static_cast<size_t>(weights.first[x]) * 4;
+            const float* weight = weights.weights.data() + static_cast<size_t>(x) * weights.taps;
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (int k = 0; k < weights.count[x]; ++k)
+            {
+                sum = vmlaq_n_f32(sum, vld1q_f32(texel + k * 4), weight[k]);
+            }
+            vst1q_f32(dst + static_cast<size_t>(x) * 4, sum);
+        }
+    }
+
+    static void AccumulateRowNeon(const float* src, const float weight, float* dst, const size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), weight));
+        }
+        AccumulateRowScalar(src + i, weight, dst + i, count - i);
+    }
+#endif
+
+    /// @brief Filters a row of float RGBA pixels horizontally into width pixels
+    static void ResampleRow(const float* src, const ResizeWeights& weights, float* dst, const int width)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            ResampleRowAvx2(src, weights, dst, width);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        ResampleRowNeon(src, weights, dst, width);
+        return;
+#endif
+        ResampleRowScalar(src, weights, dst, width);
+    }
+
+    /// @brief Adds count floats of src scaled by weight to dst
+    static void AccumulateRow(const float* src, const float weight, float* dst, const size_t count)
+    {
+#if defined(GYRO_IMAGE_KERNELS_X86)
+        if (HasAvx2())
+        {
+            AccumulateRowAvx2(src, weight, dst, count);
+            return;
+        }
+#elif defined(GYRO_IMAGE_KERNELS_NEON)
+        AccumulateRowNeon(src, weight, dst, count);
+        return;
+#endif
+        AccumulateRowScalar(src, weight, dst, count);
+    }
+
+    /// @brief Resizes RGBA8 pixels. sRGB pixels are filtered in linear space with premultiplied alpha, UNORM pixels
+    /// such as normal or mask maps are filtered as they are, every channel on its own
+    /// @note Source rows are decoded and filtered horizontally once, only the rows the current output row reads are
+    /// kept, so memory stays a few rows of the output wide
+    static bool ResizeRgba8(const uint8_t* src, const int srcWidth, const int srcHeight, uint8_t* dst,
+                            const int dstWidth, const int dstHeight, const bool srgb,
+                            const ResizeFilter filter = ResizeFilter::Lanczos3)
+    {
+        if (!src || !dst || srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        {
+            return false;
+        }
+
+        const ResizeWeights horizontal = BuildResizeWeights(srcWidth, dstWidth, filter);
+        const ResizeWeights vertical = BuildResizeWeights(srcHeight, dstHeight, filter);
+        const size_t rowFloats = static_cast<size_t>(dstWidth) * 4;
+        std::vector<float> decoded(static_cast<size_t>(srcWidth) * 4);
+        std::vector<float> rows(rowFloats * vertical.taps);
+        std::vector<int> rowSources(vertical.taps, -1);
+        std::vector<float> output(rowFloats);
+
+        for (int y = 0; y < dstHeight; ++y)
+        {
+            std::fill(output.begin(), output.end(), 0.0f);
+            const float* weights = vertical.weights.data() + static_cast<size_t>(y) * vertical.taps;
+            for (int k = 0; k < vertical.count[y]; ++k)
+            {
+                // The rows an output row reads are contiguous and move down, so their slots never collide
+                const int source = vertical.first[y] + k;
+                float* row = rows.data() + static_cast<size_t>(source % vertical.taps) * rowFloats;
+                if (rowSources[source % vertical.taps] != source)
+                {
+                    const uint8_t* sourceRow = src + static_cast<size_t>(source) * srcWidth * 4;
+                    if (srgb)
+                    {
+                        SrgbToLinear(sourceRow, decoded.data(), srcWidth);
+                        PremultiplyAlpha(decoded.data(), srcWidth);
+                    }
+                    else
+                    {
+                        UnormToFloat(sourceRow, decoded.data(), srcWidth);
+                    }
+                    ResampleRow(decoded.data(), horizontal, row, dstWidth);
+                    rowSources[source % vertical.taps] = source;
+                }
+                AccumulateRow(row, weights[k], output.data(), rowFloats);
+            }
+            uint8_t* destinationRow = dst + static_cast<size_t>(y) * dstWidth * 4;
+            if (srgb)
+            {
+                UnpremultiplyAlpha(output.data(), dstWidth);
+                LinearToSrgb(output.data(), destinationRow, dstWidth);
+            }
+            else
+            {
+                FloatToUnorm(output.data(), destinationRow, dstWidth);
+            }
+        }
+        return true;
+    }
+}
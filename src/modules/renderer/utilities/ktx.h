@@ -0,0 +1,257 @@
+//
+// Created by lepag on 7/25/2025.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ktx.h>
+#include <volk.h>
+
+#include "debug/logger.h"
+
+namespace GyroEngine::Utils::Ktx
+{
+    static constexpr uint8_t Ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    /// @brief A loaded KTX2 texture, its payload holds every level in the format the image is created with
+    struct KtxData
+    {
+        ktxTexture2* texture = nullptr;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent3D extent = {};
+        uint32_t mipLevels = 1;
+        const uint8_t* data = nullptr;
+        size_t dataSize = 0;
+        /// @brief One copy per level, offsets into data
+        std::vector<VkBufferImageCopy> regions;
+
+        KtxData() = default;
+        KtxData(const KtxData&) = delete;
+        KtxData& operator=(const KtxData&) = delete;
+
+        ~KtxData()
+        {
+            if (texture)
+            {
+                ktxTexture_Destroy(ktxTexture(texture));
+            }
+        }
+    };
+
+    /// @brief Where a level's texels lie in the file
+    struct Ktx2Level
+    {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+    };
+
+    /// @brief Header and level index of a KTX2 file whose levels are stored exactly as they're uploaded
+    struct Ktx2Layout
+    {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent3D extent = {};
+        uint32_t mipLevels = 0;
+        /// @brief Indexed by level, level 0 is the largest
+        std::vector<Ktx2Level> levels;
+
+        [[nodiscard]] VkExtent3D GetLevelExtent(const uint32_t level) const
+        {
+            return {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+        }
+
+        /// @brief Bytes of every level from firstLevel down to the smallest
+        [[nodiscard]] VkDeviceSize GetSize(const uint32_t firstLevel) const
+        {
+            VkDeviceSize size = 0;
+            for (uint32_t level = firstLevel; level < mipLevels; ++level)
+            {
+                size += levels[level].length;
+            }
+            return size;
+        }
+    };
+
+    /// @brief Whether the file starts with the KTX2 identifier, the extension isn't trusted
+    static bool IsKtx2File(const std::string& filePath)
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        uint8_t identifier[sizeof(Ktx2Identifier)] = {};
+        if (!file.read(reinterpret_cast<char*>(identifier), sizeof(identifier)))
+        {
+            return false;
+        }
+        return std::memcmp(identifier, Ktx2Identifier, sizeof(Ktx2Identifier)) == 0;
+    }
+
+    static bool IsBlockCompressedFormat(const VkFormat format)
+    {
+        return (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) ||
+               (format >= VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK && format <= VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK);
+    }
+
+    /// @brief Whether images of the format can be sampled with linear filtering
+    static bool IsSampledFormatSupported(VkPhysicalDevice physicalDevice, const VkFormat format)
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+        constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (properties.optimalTilingFeatures & required) == required;
+    }
+
+    /// @brief Best format a Basis Universal payload transcodes to on this device
+    /// @note BC7 and ASTC keep UASTC's quality, BC3/BC1 and ETC2/ETC1 are the older fallbacks, uncompressed RGBA is the
+    /// last resort
+    static ktx_transcode_fmt_e ChooseTranscodeFormat(VkPhysicalDevice physicalDevice, const bool hasAlpha)
+    {
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+        if (features.textureCompressionBC && IsSampledFormatSupported(physicalDevice, VK_FORMAT_BC7_UNORM_BLOCK))
+        {
+            return KTX_TTF_BC7_RGBA;
+        }
+        if (features.textureCompressionASTC_LDR &&
+            IsSampledFormatSupported(physicalDevice, VK_FORMAT_ASTC_4x4_UNORM_BLOCK))
+        {
+            return KTX_TTF_ASTC_4x4_RGBA;
+        }
+        if (features.textureCompressionBC)
+        {
+            if (hasAlpha && IsSampledFormatSupported(physicalDevice, VK_FORMAT_BC3_UNORM_BLOCK))
+            {
+                return KTX_TTF_BC3_RGBA;
+            }
+            if (!hasAlpha && IsSampledFormatSupported(physicalDevice, VK_FORMAT_BC1_RGB_UNORM_BLOCK))
+            {
+                return KTX_TTF_BC1_RGB;
+            }
+        }
+        if (features.textureCompressionETC2)
+        {
+            if (hasAlpha && IsSampledFormatSupported(physicalDevice, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK))
+            {
+                return KTX_TTF_ETC2_RGBA;
+            }
+            if (!hasAlpha && IsSampledFormatSupported(physicalDevice, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK))
+            {
+                return KTX_TTF_ETC1_RGB;
+            }
+        }
+        return KTX_TTF_RGBA32;
+    }
+
+    /// @brief Reads the level index of a 2D KTX2 file, so single levels can be copied straight out of the mapped file
+    /// @note Fails for supercompressed and Basis Universal files, their levels only exist once libktx decoded them
+    static bool ReadKtx2Layout(const uint8_t* data, const size_t size, Ktx2Layout& layout)
+    {
+        constexpr size_t headerSize = 80;
+        constexpr size_t levelIndexEntrySize = 24;
+        if (size < headerSize || std::memcmp(data, Ktx2Identifier, sizeof(Ktx2Identifier)) != 0)
+        {
+            return false;
+        }
+
+        // vkFormat, typeSize, width, height, depth, layers, faces, levels, supercompression
+        uint32_t header[9];
+        std::memcpy(header, data + sizeof(Ktx2Identifier), sizeof(header));
+        const uint32_t mipLevels = std::max(header[7], 1u);
+        if (header[0] == VK_FORMAT_UNDEFINED || header[8] != 0 || header[3] == 0 || header[4] > 1 || header[5] > 1 ||
+            header[6] != 1 || size < headerSize + mipLevels * levelIndexEntrySize)
+        {
+            return false;
+        }
+
+        layout.format = static_cast<VkFormat>(header[0]);
+        layout.extent = {header[2], header[3], 1};
+        layout.mipLevels = mipLevels;
+        layout.levels.resize(mipLevels);
+        for (uint32_t level = 0; level < mipLevels; ++level)
+        {
+            uint64_t entry[3];
+            std::memcpy(entry, data + headerSize + level * levelIndexEntrySize, sizeof(entry));
+            if (entry[0] + entry[1] > size)
+            {
+                return false;
+            }
+            layout.levels[level] = {entry[0], entry[1]};
+        }
+        return true;
+    }
+
+    /// @brief Loads a 2D KTX2 texture, Basis Universal payloads are transcoded to the best format the device samples
+    /// @note Pre-compressed payloads are kept as they are, they fail to load when the device can't sample their format
+    static std::unique_ptr<KtxData> LoadKtx2(const std::string& filePath, VkPhysicalDevice physicalDevice)
+    {
+        auto ktxData = std::make_unique<KtxData>();
+        ktx_error_code_e result = ktxTexture2_CreateFromNamedFile(filePath.c_str(),
+                                                                  KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                                                                  &ktxData->texture);
+        if (result != KTX_SUCCESS)
+        {
+            Logger::LogError("Failed to load KTX2 file {} because: {}", filePath, ktxErrorString(result));
+            return nullptr;
+        }
+
+        ktxTexture2* texture = ktxData->texture;
+        if (texture->numDimensions != 2 || texture->numFaces != 1 || texture->isArray || texture->baseDepth != 1)
+        {
+            Logger::LogError("KTX2 file {} isn't a 2D texture, cube maps, arrays and volumes aren't supported",
+                             filePath);
+            return nullptr;
+        }
+
+        if (ktxTexture2_NeedsTranscoding(texture))
+        {
+            const bool hasAlpha = ktxTexture2_GetNumComponents(texture) == 2 ||
+                                  ktxTexture2_GetNumComponents(texture) == 4;
+            const ktx_transcode_fmt_e transcodeFormat = ChooseTranscodeFormat(physicalDevice, hasAlpha);
+            result = ktxTexture2_TranscodeBasis(texture, transcodeFormat, 0);
+            if (result != KTX_SUCCESS)
+            {
+                Logger::LogError("Failed to transcode KTX2 file {} because: {}", filePath, ktxErrorString(result));
+                return nullptr;
+            }
+        }
+
+        ktxData->format = static_cast<VkFormat>(texture->vkFormat);
+        if (ktxData->format == VK_FORMAT_UNDEFINED || !IsSampledFormatSupported(physicalDevice, ktxData->format))
+        {
+            Logger::LogError("KTX2 file {} uses format {}, which the device can't sample", filePath,
+                             static_cast<uint32_t>(ktxData->format));
+            return nullptr;
+        }
+
+        ktxData->extent = {texture->baseWidth, texture->baseHeight, 1};
+        ktxData->mipLevels = texture->numLevels;
+        ktxData->data = ktxTexture_GetData(ktxTexture(texture));
+        ktxData->dataSize = ktxTexture_GetDataSize(ktxTexture(texture));
+
+        ktxData->regions.reserve(ktxData->mipLevels);
+        for (uint32_t level = 0; level < ktxData->mipLevels; ++level)
+        {
+            ktx_size_t offset = 0;
+            result = ktxTexture_GetImageOffset(ktxTexture(texture), level, 0, 0, &offset);
+            if (result != KTX_SUCCESS)
+            {
+                Logger::LogError("KTX2 file {} has no image for level {}", filePath, level);
+                return nullptr;
+            }
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            region.imageExtent = {std::max(ktxData->extent.width >> level, 1u),
+                                  std::max(ktxData->extent.height >> level, 1u), 1};
+            ktxData->regions.push_back(region);
+        }
+        return ktxData;
+    }
+}
@@ -0,0 +1,437 @@
+//
+// Created by lepag on 7/20/2025.
+//
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "io/mapped_file.h"
+#include "utils.h"
+#include "gltf.h"
+#include "mesh.h"
+
+namespace GyroEngine::Utils::MeshCache
+{
+    /// @brief Bump whenever the layout of the file or of anything stored in it changes
+    static constexpr uint32_t Version = 2;
+    static constexpr char Magic[4] = {'G', 'M', 'S', 'H'};
+    /// @brief Every blob starts on a cache line, so it can be read straight out of the mapping
+    static constexpr uint64_t BlobAlignment = 64;
+
+    /// @brief Processing applied on import, part of the cache key so changing it re-imports
+    struct ImportOptions
+    {
+        bool optimize = true;
+        bool meshlets = true;
+        bool lods = true;
+
+        [[nodiscard]] uint32_t ToFlags() const
+        {
+            return (optimize ? 1u : 0u) | (meshlets ? 2u : 0u) | (lods ? 4u : 0u);
+        }
+    };
+
+    enum class SectionType : uint32_t
+    {
+        Vertices,
+        Indices,
+        Lods,
+        Meshlets,
+        Submeshes,
+        /// @brief Material slot names, each followed by a null terminator
+        MaterialSlots
+    };
+
+    struct Section
+    {
+        SectionType type = SectionType::Vertices;
+        /// @brief Size of one element, checked against the running build to catch layout changes
+        uint32_t elementSize = 0;
+        uint64_t offset = 0;
+        uint64_t count = 0;
+    };
+
+    /// @brief Start of a .gmesh file, followed by the section table and the aligned blobs
+    struct Header
+    {
+        char magic[4] = {};
+        uint32_t version = 0;
+        uint64_t sourceHash = 0;
+        uint32_t importFlags = 0;
+        uint32_t sectionCount = 0;
+        float boundsMin[3] = {};
+        float boundsMax[3] = {};
+    };
+
+    /// @brief FNV-1a, stable across runs and platforms
+    static uint64_t Hash(const void* data, const size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /// @brief Hash of the file's contents, only read again once its size or modification time changed
+    /// @note Residency streams evicted meshes back in through LoadOrImport, rehashing the source every time adds up
+    static std::optional<uint64_t> HashFile(const std::string& filePath)
+    {
+        struct CachedHash
+        {
+            std::uintmax_t size = 0;
+            std::filesystem::file_time_type writeTime;
+            uint64_t hash = 0;
+        };
+        static std::mutex mutex;
+        static std::unordered_map<std::string, CachedHash> hashes;
+
+        std::error_code sizeError;
+        std::error_code timeError;
+        const std::uintmax_t size = std::filesystem::file_size(filePath, sizeError);
+        const auto writeTime = std::filesystem::last_write_time(filePath, timeError);
+        const bool stamped = !sizeError && !timeError;
+        if (stamped)
+        {
+            std::lock_guard lock(mutex);
+            const auto it = hashes.find(filePath);
+            if (it != hashes.end() && it->second.size == size && it->second.writeTime == writeTime)
+            {
+                return it->second.hash;
+            }
+        }
+
+        MappedFile file;
+        if (!file.Open(filePath))
+        {
+            return std::nullopt;
+        }
+        const uint64_t hash = Hash(file.GetData(), file.GetSize());
+        if (stamped)
+        {
+            std::lock_guard lock(mutex);
+            hashes[filePath] = {size, writeTime, hash};
+        }
+        return hash;
+    }
+
+    static std::string GetCachePath(const std::string& sourcePath, const uint64_t sourceHash,
+                                    const ImportOptions& options)
+    {
+        const std::string stem = std::filesystem::path(sourcePath).stem().string();
+        return (std::filesystem::path(GetExecutableDir()) / "cache" / "meshes" /
+                fmt::format("{}-{:016x}-{}.gmesh", stem, sourceHash, options.ToFlags())).string();
+    }
+
+    template <typename T>
+    static Section MakeSection(const SectionType type, const std::vector<T>& elements, uint64_t& offset)
+    {
+        Section section;
+        section.type = type;
+        section.elementSize = sizeof(T);
+        section.offset = offset;
+        section.count = elements.size();
+        offset += (sizeof(T) * elements.size() + BlobAlignment - 1) / BlobAlignment * BlobAlignment;
+        return section;
+    }
+
+    static std::vector<char> PackStrings(const std::vector<std::string>& strings)
+    {
+        std::vector<char> packed;
+        for (const auto& string : strings)
+        {
+            packed.insert(packed.end(), string.begin(), string.end());
+            packed.push_back('\0');
+        }
+        return packed;
+    }
+
+    static std::vector<std::string> UnpackStrings(const std::vector<char>& packed)
+    {
+        std::vector<std::string> strings;
+        size_t begin = 0;
+        for (size_t i = 0; i < packed.size(); ++i)
+        {
+            if (packed[i] == '\0')
+            {
+                strings.emplace_back(packed.data() + begin, i - begin);
+                begin = i + 1;
+            }
+        }
+        return strings;
+    }
+
+    static bool Write(const std::string& cachePath, const Mesh::MeshFile& meshFile, const uint64_t sourceHash,
+                      const ImportOptions& options)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+
+        Header header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.sourceHash = sourceHash;
+        header.importFlags = options.ToFlags();
+        header.sectionCount = 6;
+        if (!meshFile.vertices.empty())
+        {
+            glm::vec3 min = meshFile.vertices.front().position;
+            glm::vec3 max = min;
+            for (const auto& vertex : meshFile.vertices)
+            {
+                min = glm::min(min, vertex.position);
+                max = glm::max(max, vertex.position);
+            }
+            std::memcpy(header.boundsMin, &min.x, sizeof(header.boundsMin));
+            std::memcpy(header.boundsMax, &max.x, sizeof(header.boundsMax));
+        }
+
+        const std::vector<char> materialSlots = PackStrings(meshFile.materialSlots);
+        uint64_t offset = sizeof(Header) + sizeof(Section) * header.sectionCount;
+        offset = (offset + BlobAlignment - 1) / BlobAlignment * BlobAlignment;
+        const Section sections[] = {
+            MakeSection(SectionType::Vertices, meshFile.vertices, offset),
+            MakeSection(SectionType::Indices, meshFile.indices, offset),
+            MakeSection(SectionType::Lods, meshFile.lods, offset),
+            MakeSection(SectionType::Meshlets, meshFile.meshlets, offset),
+            MakeSection(SectionType::Submeshes, meshFile.submeshes, offset),
+            MakeSection(SectionType::MaterialSlots, materialSlots, offset)
+        };
+        const std::pair<const void*, size_t> blobs[] = {
+            {meshFile.vertices.data(), sizeof(Types::Vertex) * meshFile.vertices.size()},
+            {meshFile.indices.data(), sizeof(uint32_t) * meshFile.indices.size()},
+            {meshFile.lods.data(), sizeof(Types::MeshLod) * meshFile.lods.size()},
+            {meshFile.meshlets.data(), sizeof(Types::Meshlet) * meshFile.meshlets.size()},
+            {meshFile.submeshes.data(), sizeof(Types::Submesh) * meshFile.submeshes.size()},
+            {materialSlots.data(), materialSlots.size()}
+        };
+
+        // Written under a temporary name, so a crash mid-write never leaves a truncated cache behind
+        const std::string temporaryPath = cachePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                Logger::LogWarning("Failed to create mesh cache {}", cachePath);
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            file.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+            for (size_t i = 0; i < header.sectionCount; ++i)
+            {
+                file.seekp(static_cast<std::streamoff>(sections[i].offset));
+                file.write(static_cast<const char*>(blobs[i].first), static_cast<std::streamsize>(blobs[i].second));
+            }
+
+            // Pad the last blob, so every section ends inside the file
+            file.seekp(static_cast<std::streamoff>(offset - 1));
+            file.put('\0');
+            if (!file.good())
+            {
+                Logger::LogWarning("Failed to write mesh cache {}", cachePath);
+                file.close();
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, cachePath, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief Whether a range of count elements starting at first lies inside size elements
+    static bool IsRangeInside(const uint64_t first, const uint64_t count, const uint64_t size)
+    {
+        return first <= size && count <= size - first;
+    }
+
+    /// @brief Checks every index and range of a loaded mesh, so a damaged cache never reaches the GPU
+    static bool Validate(const Mesh::MeshFile& meshFile)
+    {
+        const uint64_t vertexCount = meshFile.vertices.size();
+        const uint64_t indexCount = meshFile.indices.size();
+        for (const uint32_t index : meshFile.indices)
+        {
+            if (index >= vertexCount)
+            {
+                return false;
+            }
+        }
+        for (const auto& lod : meshFile.lods)
+        {
+            if (!IsRangeInside(lod.indexOffset, lod.indexCount, indexCount))
+            {
+                return false;
+            }
+        }
+        for (const auto& meshlet : meshFile.meshlets)
+        {
+            if (!IsRangeInside(meshlet.firstIndex, meshlet.indexCount, indexCount))
+            {
+                return false;
+            }
+        }
+        for (const auto& submesh : meshFile.submeshes)
+        {
+            if (!IsRangeInside(submesh.firstIndex, submesh.indexCount, indexCount) ||
+                !IsRangeInside(submesh.firstVertex, submesh.vertexCount, vertexCount))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    static bool ReadSection(const MappedFile& file, const Section& section, std::vector<T>& elements)
+    {
+        if (section.elementSize != sizeof(T) || section.offset % BlobAlignment != 0 ||
+            section.offset > file.GetSize() || section.count > (file.GetSize() - section.offset) / sizeof(T))
+        {
+            return false;
+        }
+
+        // The blobs are stored exactly as they sit in memory, loading is a copy out of the mapping
+        const auto* begin = reinterpret_cast<const T*>(file.GetData() + section.offset);
+        elements.assign(begin, begin + section.count);
+        return true;
+    }
+
+    /// @brief Loads a cache written by Write, nullopt when it's missing, stale or from another version
+    static std::optional<Mesh::MeshFile> Read(const std::string& cachePath, const uint64_t sourceHash,
+                                              const ImportOptions& options)
+    {
+        MappedFile file;
+        if (!file.Open(cachePath) || file.GetSize() < sizeof(Header))
+        {
+            return std::nullopt;
+        }
+
+        Header header;
+        std::memcpy(&header, file.GetData(), sizeof(Header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+            header.sourceHash != sourceHash || header.importFlags != options.ToFlags() ||
+            file.GetSize() < sizeof(Header) + sizeof(Section) * header.sectionCount)
+        {
+            return std::nullopt;
+        }
+
+        Mesh::MeshFile meshFile;
+        const auto* sections = reinterpret_cast<const Section*>(file.GetData() + sizeof(Header));
+        for (uint32_t i = 0; i < header.sectionCount; ++i)
+        {
+            bool valid = true;
+            switch (sections[i].type)
+            {
+            case SectionType::Vertices:
+                valid = ReadSection(file, sections[i], meshFile.vertices);
+                break;
+            case SectionType::Indices:
+                valid = ReadSection(file, sections[i], meshFile.indices);
+                break;
+            case SectionType::Lods:
+                valid = ReadSection(file, sections[i], meshFile.lods);
+                break;
+            case SectionType::Meshlets:
+                valid = ReadSection(file, sections[i], meshFile.meshlets);
+                break;
+            case SectionType::Submeshes:
+                valid = ReadSection(file, sections[i], meshFile.submeshes);
+                break;
+            case SectionType::MaterialSlots:
+            {
+                std::vector<char> materialSlots;
+                valid = ReadSection(file, sections[i], materialSlots);
+                meshFile.materialSlots = UnpackStrings(materialSlots);
+                break;
+            }
+            default:
+                // Sections from newer writers are skipped, the version guards anything that changes existing ones
+                break;
+            }
+
+            if (!valid)
+            {
+                Logger::LogWarning("Mesh cache {} is corrupt, re-importing", cachePath);
+                return std::nullopt;
+            }
+        }
+
+        if (!Validate(meshFile))
+        {
+            Logger::LogWarning("Mesh cache {} is corrupt, re-importing", cachePath);
+            return std::nullopt;
+        }
+        return meshFile;
+    }
+
+    /// @brief Loads the mesh from its cache, importing it through Assimp and writing the cache on a miss
+    /// @throws std::runtime_error when the source can't be imported
+    static Mesh::MeshFile LoadOrImport(const std::string& filePath, const ImportOptions& options = {})
+    {
+        const auto sourceHash = HashFile(filePath);
+        if (!sourceHash)
+        {
+            throw std::runtime_error("Failed to read mesh file: " + filePath);
+        }
+
+        const std::string cachePath = GetCachePath(filePath, *sourceHash, options);
+        if (auto cached = Read(cachePath, *sourceHash, options))
+        {
+            return std::move(*cached);
+        }
+
+        // Binary glTF is decoded straight from the mapping, Assimp covers every other format and the GLB features the
+        // native loader doesn't
+        std::optional<Mesh::MeshFile> glb;
+        if (Gltf::IsGlb(filePath))
+        {
+            try
+            {
+                glb = Gltf::LoadGlb(filePath);
+            }
+            catch (const nlohmann::json::exception& e)
+            {
+                Logger::LogWarning("Falling back to Assimp for {}: {}", filePath, e.what());
+            }
+        }
+        Mesh::MeshFile meshFile = glb ? std::move(*glb) : Mesh::LoadMeshDataFromFile(filePath);
+        if (options.optimize)
+        {
+            Mesh::OptimizeMesh(meshFile, filePath);
+        }
+        if (options.meshlets)
+        {
+            Mesh::BuildMeshlets(meshFile);
+        }
+        if (options.lods)
+        {
+            Mesh::GenerateLods(meshFile);
+        }
+
+        if (!Write(cachePath, meshFile, *sourceHash, options))
+        {
+            Logger::LogWarning("Failed to cache mesh {}, it will be imported again next time", filePath);
+        }
+        return meshFile;
+    }
+}
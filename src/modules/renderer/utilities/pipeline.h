@@ -13,6 +13,8 @@ namespace GyroEngine::Utils::Pipeline
     {
         std::string name;
         uint32_t offset = 0;
+        /// @brief Format of the data in the vertex buffer, VK_FORMAT_UNDEFINED uses the reflected shader input's format
+        VkFormat format = VK_FORMAT_UNDEFINED;
     };
 
     struct PipelineInputBinding
@@ -23,9 +25,10 @@ namespace GyroEngine::Utils::Pipeline
         std::vector<PipelineInputAttribute> inputAttributes;
 
 
-        PipelineInputBinding& addAttribute(const std::string& name, const uint32_t offset)
+        PipelineInputBinding& addAttribute(const std::string& name, const uint32_t offset,
+                                           const VkFormat format = VK_FORMAT_UNDEFINED)
         {
-            inputAttributes.push_back({name, offset});
+            inputAttributes.push_back({name, offset, format});
             return *this;
         }
     };
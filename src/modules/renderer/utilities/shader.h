@@ -26,7 +26,8 @@ namespace GyroEngine::Utils::Shader
     enum class ShaderStage
     {
         Vertex,
-        Fragment
+        Fragment,
+        Compute
     };
 
     struct ShaderBinding {
@@ -0,0 +1,220 @@
+//
+// Created by lepag on 7/18/2025.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <volk.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "types.h"
+#include "vertex_layout.h"
+
+namespace GyroEngine::Utils::Vertex
+{
+    /// @brief Binding and attribute descriptions of a vertex format, a view into its StaticVertexLayout
+    struct VertexLayout
+    {
+        Types::VertexFormat format = Types::VertexFormat::Full;
+        const VkVertexInputBindingDescription* bindings = nullptr;
+        uint32_t bindingCount = 0;
+        const VkVertexInputAttributeDescription* attributes = nullptr;
+        uint32_t attributeCount = 0;
+
+        /// @return The attribute read at the location, nullptr when the format has none there
+        [[nodiscard]] const VkVertexInputAttributeDescription* FindAttribute(const uint32_t location) const
+        {
+            const auto* end = attributes + attributeCount;
+            const auto* attribute = std::find_if(attributes, end, [location](const auto& a)
+            {
+                return a.location == location;
+            });
+            return attribute != end ? attribute : nullptr;
+        }
+
+        /// @brief How well reflected shader inputs, anything with a location and a format, fit the layout
+        /// @return Inputs reading exactly the components of their attribute, -1 when an input has no attribute at its
+        /// location, reads another numeric type or more components than the attribute holds
+        template <typename Inputs>
+        [[nodiscard]] int Match(const Inputs& inputs) const
+        {
+            int exact = 0;
+            for (const auto& input : inputs)
+            {
+                const auto* attribute = FindAttribute(input.location);
+                if (!attribute || GetNumericType(attribute->format) != GetNumericType(input.format) ||
+                    GetComponentCount(input.format) > GetComponentCount(attribute->format))
+                {
+                    return -1;
+                }
+                if (GetComponentCount(input.format) == GetComponentCount(attribute->format))
+                {
+                    ++exact;
+                }
+            }
+            return exact;
+        }
+    };
+
+    /// @brief Uniform scale quantized positions are relative to, keeps the dequantization free of skew for normals
+    struct QuantizationBounds
+    {
+        glm::vec3 center{0.0f};
+        float extent = 1.0f;
+    };
+
+    template <typename Layout>
+    static VertexLayout MakeLayout(const Types::VertexFormat format)
+    {
+        return {
+            format, Layout::bindings.data(), static_cast<uint32_t>(Layout::bindings.size()),
+            Layout::attributes.data(), static_cast<uint32_t>(Layout::attributes.size())
+        };
+    }
+
+    /// @note Locations follow the object shaders: position, normal, uv, tangent, color
+    static VertexLayout GetLayout(const Types::VertexFormat format)
+    {
+        switch (format)
+        {
+        case Types::VertexFormat::Packed:
+            return MakeLayout<PackedLayout>(format);
+        case Types::VertexFormat::Split:
+            return MakeLayout<SplitLayout>(format);
+        default:
+            return MakeLayout<FullLayout>(format);
+        }
+    }
+
+    /// @brief Stride of the first stream, the positions alone for split vertices
+    static uint32_t GetStride(const Types::VertexFormat format)
+    {
+        return GetLayout(format).bindings[0].stride;
+    }
+
+    /// @brief Separates the positions of full vertices from the rest, the two streams of VertexFormat::Split
+    static void SplitVertices(const std::vector<Types::Vertex>& vertices, std::vector<glm::vec3>& positions,
+                              std::vector<Types::VertexAttributes>& attributes)
+    {
+        positions.clear();
+        attributes.clear();
+        positions.reserve(vertices.size());
+        attributes.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+        {
+            positions.push_back(vertex.position);
+            attributes.push_back({vertex.normal, vertex.texCoords, vertex.tangent, vertex.color});
+        }
+    }
+
+    static int16_t PackSnorm16(const float value)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    static uint8_t PackUnorm8(const float value)
+    {
+        return static_cast<uint8_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    /// @brief Maps a unit vector onto the [-1, 1] square, decoded by decodeOctahedral in the packed shaders
+    static glm::vec2 EncodeOctahedral(const glm::vec3& direction)
+    {
+        const float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+        if (length <= 0.0f)
+        {
+            return glm::vec2(0.0f);
+        }
+
+        const glm::vec3 n = direction / length;
+        if (n.z >= 0.0f)
+        {
+            return {n.x, n.y};
+        }
+
+        // Fold the lower hemisphere over the diagonals
+        return {
+            (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+        };
+    }
+
+    static QuantizationBounds ComputeBounds(const std::vector<Types::Vertex>& vertices)
+    {
+        QuantizationBounds bounds;
+        if (vertices.empty())
+        {
+            return bounds;
+        }
+
+        glm::vec3 min = vertices.front().position;
+        glm::vec3 max = vertices.front().position;
+        for (const auto& vertex : vertices)
+        {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        const glm::vec3 halfSize = (max - min) * 0.5f;
+        bounds.center = (min + max) * 0.5f;
+        bounds.extent = std::max({halfSize.x, halfSize.y, halfSize.z});
+        if (bounds.extent <= 0.0f)
+        {
+            bounds.extent = 1.0f;
+        }
+        return bounds;
+    }
+
+    /// @brief Maps quantized positions back to object space, fold it into the model matrix
+    static glm::mat4 GetDequantizationMatrix(const QuantizationBounds& bounds)
+    {
+        return glm::scale(glm::translate(glm::mat4(1.0f), bounds.center), glm::vec3(bounds.extent));
+    }
+
+    static Types::PackedVertex PackVertex(const Types::Vertex& vertex, const QuantizationBounds& bounds)
+    {
+        Types::PackedVertex packed{};
+
+        const glm::vec3 position = (vertex.position - bounds.center) / bounds.extent;
+        packed.position[0] = PackSnorm16(position.x);
+        packed.position[1] = PackSnorm16(position.y);
+        packed.position[2] = PackSnorm16(position.z);
+        packed.position[3] = PackSnorm16(1.0f);
+
+        const glm::vec2 normal = EncodeOctahedral(vertex.normal);
+        packed.normal[0] = PackSnorm16(normal.x);
+        packed.normal[1] = PackSnorm16(normal.y);
+
+        const glm::vec2 tangent = EncodeOctahedral(vertex.tangent);
+        packed.tangent[0] = PackSnorm16(tangent.x);
+        packed.tangent[1] = PackSnorm16(tangent.y);
+
+        packed.texCoords[0] = glm::packHalf1x16(vertex.texCoords.x);
+        packed.texCoords[1] = glm::packHalf1x16(vertex.texCoords.y);
+
+        packed.color[0] = PackUnorm8(vertex.color.r);
+        packed.color[1] = PackUnorm8(vertex.color.g);
+        packed.color[2] = PackUnorm8(vertex.color.b);
+        packed.color[3] = PackUnorm8(vertex.color.a);
+        return packed;
+    }
+
+    static std::vector<Types::PackedVertex> PackVertices(const std::vector<Types::Vertex>& vertices,
+                                                         const QuantizationBounds& bounds)
+    {
+        std::vector<Types::PackedVertex> packed;
+        packed.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+        {
+            packed.push_back(PackVertex(vertex, bounds));
+        }
+        return packed;
+    }
+}
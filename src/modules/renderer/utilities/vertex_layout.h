@@ -0,0 +1,308 @@
+//
+// Created by lepag on 7/24/2025.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <volk.h>
+
+#include <glm/glm.hpp>
+
+#include "types.h"
+
+namespace GyroEngine::Utils::Vertex
+{
+    /// @brief Which GLSL type a vertex format reads as, shader inputs must be of the same kind
+    enum class NumericType : uint8_t
+    {
+        Unknown,
+        Float,
+        SInt,
+        UInt
+    };
+
+    /// @brief Default format of a vertex field's C++ type, fields of other types name their format explicitly
+    template <typename T>
+    struct FormatOf
+    {
+        static constexpr VkFormat value = VK_FORMAT_UNDEFINED;
+    };
+
+    template <>
+    struct FormatOf<float>
+    {
+        static constexpr VkFormat value = VK_FORMAT_R32_SFLOAT;
+    };
+
+    template <>
+    struct FormatOf<glm::vec2>
+    {
+        static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT;
+    };
+
+    template <>
+    struct FormatOf<glm::vec3>
+    {
+        static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT;
+    };
+
+    template <>
+    struct FormatOf<glm::vec4>
+    {
+        static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT;
+    };
+
+    template <>
+    struct FormatOf<uint32_t>
+    {
+        static constexpr VkFormat value = VK_FORMAT_R32_UINT;
+    };
+
+    /// @note Covers the formats vertex fields and reflected shader inputs use, others report 0
+    constexpr uint32_t GetFormatSize(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_UINT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_UINT:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32_UINT:
+            return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    constexpr NumericType GetNumericType(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return NumericType::Float;
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+            return NumericType::SInt;
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R32G32B32_UINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+            return NumericType::UInt;
+        default:
+            return NumericType::Unknown;
+        }
+    }
+
+    /// @brief Components a format holds, a shader input may read fewer of them but not more
+    constexpr uint32_t GetComponentCount(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_UINT:
+            return 1;
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_UINT:
+            return 2;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32_UINT:
+            return 3;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    /// @brief A field of a vertex struct, what the input assembler reads at a shader location
+    struct VertexField
+    {
+        uint32_t location = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t offset = 0;
+        /// @brief sizeof the C++ field, checked against the format's size
+        uint32_t size = 0;
+    };
+
+    /// @brief Describes a field of type T, pass the format when T has no FormatOf, e.g. arrays of normalized integers
+    template <typename T>
+    constexpr VertexField MakeField(const uint32_t location, const size_t offset,
+                                    const VkFormat format = FormatOf<T>::value)
+    {
+        return {location, format, static_cast<uint32_t>(offset), static_cast<uint32_t>(sizeof(T))};
+    }
+
+    /// @brief Field descriptors of a vertex struct, specialize it with a constexpr std::array named fields
+    template <typename T>
+    struct VertexFields;
+
+    template <>
+    struct VertexFields<Types::Vertex>
+    {
+        static constexpr std::array fields = {
+            MakeField<glm::vec3>(0, offsetof(Types::Vertex, position)),
+            MakeField<glm::vec3>(1, offsetof(Types::Vertex, normal)),
+            MakeField<glm::vec2>(2, offsetof(Types::Vertex, texCoords)),
+            MakeField<glm::vec3>(3, offsetof(Types::Vertex, tangent)),
+            MakeField<glm::vec4>(4, offsetof(Types::Vertex, color))
+        };
+    };
+
+    template <>
+    struct VertexFields<Types::PackedVertex>
+    {
+        static constexpr std::array fields = {
+            MakeField<int16_t[4]>(0, offsetof(Types::PackedVertex, position), VK_FORMAT_R16G16B16A16_SNORM),
+            MakeField<int16_t[2]>(1, offsetof(Types::PackedVertex, normal), VK_FORMAT_R16G16_SNORM),
+            MakeField<uint16_t[2]>(2, offsetof(Types::PackedVertex, texCoords), VK_FORMAT_R16G16_SFLOAT),
+            MakeField<int16_t[2]>(3, offsetof(Types::PackedVertex, tangent), VK_FORMAT_R16G16_SNORM),
+            MakeField<uint8_t[4]>(4, offsetof(Types::PackedVertex, color), VK_FORMAT_R8G8B8A8_UNORM)
+        };
+    };
+
+    /// @brief Bare positions, the first stream of VertexFormat::Split
+    template <>
+    struct VertexFields<glm::vec3>
+    {
+        static constexpr std::array fields = {
+            MakeField<glm::vec3>(0, 0)
+        };
+    };
+
+    template <>
+    struct VertexFields<Types::VertexAttributes>
+    {
+        static constexpr std::array fields = {
+            MakeField<glm::vec3>(1, offsetof(Types::VertexAttributes, normal)),
+            MakeField<glm::vec2>(2, offsetof(Types::VertexAttributes, texCoords)),
+            MakeField<glm::vec3>(3, offsetof(Types::VertexAttributes, tangent)),
+            MakeField<glm::vec4>(4, offsetof(Types::VertexAttributes, color))
+        };
+    };
+
+    /// @brief Whether every field has a known format matching its size and lies inside the struct
+    template <typename T>
+    constexpr bool AreFieldsValid()
+    {
+        const auto& fields = VertexFields<T>::fields;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            if (GetFormatSize(fields[i].format) == 0 || GetFormatSize(fields[i].format) != fields[i].size ||
+                fields[i].offset + fields[i].size > sizeof(T))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief A vertex struct read from a vertex buffer binding
+    template <typename T, uint32_t Binding = 0, VkVertexInputRate InputRate = VK_VERTEX_INPUT_RATE_VERTEX>
+    struct Stream
+    {
+        using Type = T;
+        static constexpr uint32_t binding = Binding;
+        static constexpr VkVertexInputRate inputRate = InputRate;
+
+        static_assert(AreFieldsValid<T>(), "Vertex field formats must match the size and place of the fields");
+    };
+
+    template <typename... Streams>
+    constexpr auto MakeAttributes()
+    {
+        constexpr size_t count = (VertexFields<typename Streams::Type>::fields.size() + ...);
+        std::array<VkVertexInputAttributeDescription, count> attributes{};
+        size_t next = 0;
+        const auto append = [&](const uint32_t binding, const auto& fields)
+        {
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                attributes[next++] = {fields[i].location, binding, fields[i].format, fields[i].offset};
+            }
+        };
+        (append(Streams::binding, VertexFields<typename Streams::Type>::fields), ...);
+        return attributes;
+    }
+
+    template <size_t Count>
+    constexpr bool HasUniqueLocations(const std::array<VkVertexInputAttributeDescription, Count>& attributes)
+    {
+        for (size_t i = 0; i < Count; ++i)
+        {
+            for (size_t j = i + 1; j < Count; ++j)
+            {
+                if (attributes[i].location == attributes[j].location)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// @brief Binding and attribute descriptions of a set of streams, built at compile time from their fields
+    template <typename... Streams>
+    struct StaticVertexLayout
+    {
+        static constexpr std::array<VkVertexInputBindingDescription, sizeof...(Streams)> bindings = {{
+            {Streams::binding, static_cast<uint32_t>(sizeof(typename Streams::Type)), Streams::inputRate}...
+        }};
+        static constexpr auto attributes = MakeAttributes<Streams...>();
+
+        static_assert(HasUniqueLocations(attributes), "Vertex streams can't share a location");
+    };
+
+    using FullLayout = StaticVertexLayout<Stream<Types::Vertex>>;
+    using PackedLayout = StaticVertexLayout<Stream<Types::PackedVertex>>;
+    using SplitLayout = StaticVertexLayout<Stream<glm::vec3, 0>, Stream<Types::VertexAttributes, 1>>;
+}
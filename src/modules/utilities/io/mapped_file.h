@@ -0,0 +1,51 @@
+//
+// Created by lepag on 7/20/2025.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace GyroEngine::Utils
+{
+    /// @brief Read-only memory mapping of a whole file, pages are loaded by the OS as they're touched
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        [[nodiscard]] const uint8_t* GetData() const
+        {
+            return m_data;
+        }
+
+        [[nodiscard]] size_t GetSize() const
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] bool IsOpen() const
+        {
+            return m_data != nullptr;
+        }
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_file = -1;
+#endif
+    };
+}
@@ -0,0 +1,142 @@
+//
+// Created by lepag on 7/21/2025.
+//
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        const size_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packagedTask(std::move(task));
+    std::future<void> future = packagedTask.get_future();
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push(std::move(packagedTask));
+    }
+    m_condition.notify_one();
+    return future;
+}
+
+void ThreadPool::ParallelFor(const size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Shared, helpers that only get to run after the loop finished must still find valid state
+    struct State
+    {
+        std::function<void(size_t)> body;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr exception;
+    };
+    auto state = std::make_shared<State>();
+    state->body = body;
+    state->count = count;
+
+    const auto work = [](const std::shared_ptr<State>& shared)
+    {
+        for (size_t index = shared->next++; index < shared->count; index = shared->next++)
+        {
+            try
+            {
+                shared->body(index);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(shared->mutex);
+                if (!shared->exception)
+                {
+                    shared->exception = std::current_exception();
+                }
+            }
+
+            if (++shared->done == shared->count)
+            {
+                std::lock_guard lock(shared->mutex);
+                shared->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Submit([state, work] { work(state); });
+    }
+
+    // Waiting on the helpers' futures could deadlock when every worker is itself inside a ParallelFor, so the caller
+    // works too and only waits for indices that are already running
+    work(state);
+    {
+        std::unique_lock lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done == state->count; });
+    }
+
+    if (state->exception)
+    {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+ThreadPool& ThreadPool::GetShared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping && m_tasks.empty())
+            {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,47 @@
+//
+// Created by lepag on 7/21/2025.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/// @brief Fixed set of worker threads running queued tasks
+class ThreadPool {
+public:
+    /// @param threadCount Workers to start, 0 for one less than the hardware threads so the caller keeps a core
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::future<void> Submit(std::function<void()> task);
+
+    /// @brief Runs body for every index in [0, count) and returns once all of them finished
+    /// @note The calling thread works through indices too, so it's safe to call from inside a task. The first
+    /// exception thrown by body is rethrown here
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    [[nodiscard]] size_t GetThreadCount() const
+    {
+        return m_workers.size();
+    }
+
+    /// @brief Pool shared by the engine's loaders, started on first use
+    static ThreadPool& GetShared();
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+
+    void WorkerLoop();
+};
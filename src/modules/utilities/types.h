@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -20,8 +21,82 @@ namespace GyroEngine::Types
 
         Vertex(const glm::vec3& pos, const glm::vec3& nor, const glm::vec2& uv, const glm::vec3& tan, const glm::vec4& col)
        : position(pos), normal(nor), texCoords(uv), tangent(tan), color(col) {}
+        /// @note Leaves the attributes uninitialized, for storage that gets filled right after
+        Vertex() = default;
     };
 
+    /// @brief How a mesh's vertices are stored in its vertex buffer
+    enum class VertexFormat : uint8_t
+    {
+        /// @brief Vertex as is, 60 bytes of 32-bit floats
+        Full,
+        /// @brief PackedVertex, 24 bytes
+        Packed,
+        /// @brief Vertex split in two streams, 12 bytes of positions in binding 0 and VertexAttributes in binding 1
+        /// @note Passes that only read positions, like depth and shadows, then skip the other 48 bytes
+        Split
+    };
+
+    /// @brief Everything of a Vertex but its position, the second stream of VertexFormat::Split
+    struct VertexAttributes
+    {
+        glm::vec3 normal;
+        glm::vec2 texCoords;
+        glm::vec3 tangent;
+        glm::vec4 color;
+    };
+    static_assert(sizeof(VertexAttributes) == 48, "VertexAttributes must stay tightly packed");
+
+    /// @brief Quantized vertex, 2.5x smaller than Vertex
+    /// @note Position is 16-bit normalized relative to the mesh's bounds, normal and tangent are octahedral encoded,
+    /// texture coordinates are half floats and the color is 8-bit normalized
+    struct PackedVertex
+    {
+        int16_t position[4];
+        int16_t normal[2];
+        int16_t tangent[2];
+        uint16_t texCoords[2];
+        uint8_t color[4];
+    };
+    static_assert(sizeof(PackedVertex) == 24, "PackedVertex must stay tightly packed");
+
+    /// @brief Range of a mesh's index buffer that draws one level of detail
+    struct MeshLod
+    {
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
+        /// @brief Deviation from the full detail mesh in object space units, 0 for the full detail level
+        float error = 0.0f;
+    };
+
+    /// @brief Part of a model drawn with one material, a range of the model's shared vertex and index buffers
+    /// @note Indices of the range already point into the shared vertex buffer, draw it with a vertex offset of 0
+    struct Submesh
+    {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+        /// @brief Index into the model's material slots
+        uint32_t materialSlot = 0;
+    };
+
+    /// @brief Cluster of up to 64 vertices and 124 triangles, culled on its own by the meshlet cull shader
+    /// @note GPU layout, mirrors Meshlet in meshlet_cull.comp. Bounds are in object space
+    struct Meshlet
+    {
+        glm::vec3 center{0.0f};
+        float radius = 0.0f;
+        glm::vec3 coneAxis{0.0f};
+        /// @brief Cosine of the normal cone's spread, the meshlet faces away when seen within it
+        float coneCutoff = 1.0f;
+        glm::vec3 coneApex{0.0f};
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t padding[3] = {};
+    };
+    static_assert(sizeof(Meshlet) == 64, "Meshlet must match the std430 layout of the cull shader");
+
     struct ObjectMap
     {
         std::vector<Vertex> vertices;